@@ -41,6 +41,10 @@ SettingsWindow::SettingsWindow(openauto::configuration::IConfiguration::Pointer
     connect(ui_->pushButtonSelectAll, &QPushButton::clicked, std::bind(&SettingsWindow::setButtonCheckBoxes, this, true));
     connect(ui_->pushButtonResetToDefaults, &QPushButton::clicked, this, &SettingsWindow::onResetToDefaults);
     connect(ui_->pushButtonShowBindings, &QPushButton::clicked, this, &SettingsWindow::onShowBindings);
+
+#ifndef USE_ALSA
+    ui_->radioButtonAlsaAudio->hide();
+#endif
 }
 
 SettingsWindow::~SettingsWindow()
@@ -93,7 +97,18 @@ void SettingsWindow::onSave()
 
     configuration_->setMusicAudioChannelEnabled(ui_->checkBoxMusicAudioChannel->isChecked());
     configuration_->setSpeechAudioChannelEnabled(ui_->checkBoxSpeechAudioChannel->isChecked());
-    configuration_->setAudioOutputBackendType(ui_->radioButtonRtAudio->isChecked() ? openauto::configuration::AudioOutputBackendType::RTAUDIO : openauto::configuration::AudioOutputBackendType::QT);
+    if(ui_->radioButtonRtAudio->isChecked())
+    {
+        configuration_->setAudioOutputBackendType(openauto::configuration::AudioOutputBackendType::RTAUDIO);
+    }
+    else if(ui_->radioButtonQtAudio->isChecked())
+    {
+        configuration_->setAudioOutputBackendType(openauto::configuration::AudioOutputBackendType::QT);
+    }
+    else if(ui_->radioButtonAlsaAudio->isChecked())
+    {
+        configuration_->setAudioOutputBackendType(openauto::configuration::AudioOutputBackendType::ALSA);
+    }
 
     configuration_->save();
     this->close();
@@ -150,6 +165,7 @@ void SettingsWindow::load()
     const auto& audioOutputBackendType = configuration_->getAudioOutputBackendType();
     ui_->radioButtonRtAudio->setChecked(audioOutputBackendType == openauto::configuration::AudioOutputBackendType::RTAUDIO);
     ui_->radioButtonQtAudio->setChecked(audioOutputBackendType == openauto::configuration::AudioOutputBackendType::QT);
+    ui_->radioButtonAlsaAudio->setChecked(audioOutputBackendType == openauto::configuration::AudioOutputBackendType::ALSA);
 }
 
 void SettingsWindow::loadButtonCheckBoxes()
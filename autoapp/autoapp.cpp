@@ -34,6 +34,7 @@
 #include "autoapp/UI/SettingsWindow.hpp"
 #include "autoapp/UI/ConnectDialog.hpp"
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 
 using namespace openauto;
 using ThreadPool = std::vector<std::thread>;
@@ -41,6 +42,7 @@ using ThreadPool = std::vector<std::thread>;
 void startUSBWorkers(boost::asio::io_service& ioService, libusb_context* usbContext, ThreadPool& threadPool)
 {
     auto usbWorker = [&ioService, usbContext]() {
+        trace::Tracer::setThreadName("usb");
         timeval libusbEventTimeout{180, 0};
 
         while(!ioService.stopped())
@@ -58,6 +60,7 @@ void startUSBWorkers(boost::asio::io_service& ioService, libusb_context* usbCont
 void startIOServiceWorkers(boost::asio::io_service& ioService, ThreadPool& threadPool)
 {
     auto ioServiceWorker = [&ioService]() {
+        trace::Tracer::setThreadName("io");
         ioService.run();
     };
 
@@ -89,6 +92,13 @@ int main(int argc, char* argv[])
     mainWindow.setWindowFlags(Qt::WindowStaysOnTopHint);
 
     auto configuration = std::make_shared<openauto::configuration::Configuration>();
+    OpenAutoLog::configure(configuration->getLogSeverity());
+
+    if(!configuration->getTracePath().empty())
+    {
+        trace::Tracer::getInstance().start(configuration->getTracePath());
+    }
+
     autoapp::ui::SettingsWindow settingsWindow(configuration);
     settingsWindow.setWindowFlags(Qt::WindowStaysOnTopHint);
 
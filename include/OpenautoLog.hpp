@@ -19,32 +19,46 @@
 #pragma once
 
 #include <iostream>
+#include <string>
 #include <boost/log/core.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/log/expressions.hpp>
 #include <boost/log/utility/setup/console.hpp>
 #include <boost/log/utility/setup/common_attributes.hpp>
+#include "openauto/Log/LogBackend.hpp"
 
 #define ADDITIONAL_TAG "OPENAUTO"
 
-#define LOG(severity) BOOST_LOG_TRIVIAL(severity) << "\t[" << gettid() << "][" ADDITIONAL_TAG "][" << \
-                        __FILE__ << ":" << __LINE__ << "][" << __FUNCTION__ << "] "
+// Formats into the calling thread's log ring, a flusher thread writes it out. Each statement has its
+// own static LogSite with the threshold of its module and a rate limit.
+#define LOG(severity) \
+    for(openauto::log::LogRecord logRecord(OPENAUTO_LOG_SITE(), boost::log::trivial::severity, __FUNCTION__); logRecord.isOpen(); logRecord.commit()) \
+        logRecord.stream()
+
+#define OPENAUTO_LOG_SITE() \
+    ([]() -> openauto::log::LogSite& { static openauto::log::LogSite site(__FILE__, __LINE__); return site; }())
 
 class OpenAutoLog
 {
 public:
     static void init()
     {
+        // aasdk still logs through Boost.Log on its own threads
         boost::log::register_simple_formatter_factory<boost::log::trivial::severity_level, char>("Severity");
 
         boost::log::add_console_log(
             std::cout,
             boost::log::keywords::format = "[%TimeStamp%] [%Severity%] %Message%");
 
-#if 0
-        boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::info);
-#endif
-
         boost::log::add_common_attributes();
+        configure("info");
+    }
+
+    // e.g. "info" or "info,VideoService=debug,GSTVideoOutput=warning", can be changed at any time
+    static void configure(const std::string& spec)
+    {
+        auto& backend = openauto::log::LogBackend::getInstance();
+        backend.configure(spec);
+        boost::log::core::get()->set_filter(boost::log::trivial::severity >= backend.getDefaultSeverity());
     }
 };
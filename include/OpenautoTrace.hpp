@@ -0,0 +1,42 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "openauto/Trace/Tracer.hpp"
+
+#define OPENAUTO_TRACE_CONCAT_IMPL(a, b) a##b
+#define OPENAUTO_TRACE_CONCAT(a, b) OPENAUTO_TRACE_CONCAT_IMPL(a, b)
+
+// Span from here to the end of the enclosing scope. Names and categories have to be string literals.
+#define TRACE_SCOPE(category, name) \
+    openauto::trace::TraceScope OPENAUTO_TRACE_CONCAT(traceScope, __LINE__)(category, nullptr, name)
+
+#define TRACE_SCOPE_VALUE(category, name, argumentName, value) \
+    openauto::trace::TraceScope OPENAUTO_TRACE_CONCAT(traceScope, __LINE__)(category, nullptr, name, argumentName, static_cast<int64_t>(value))
+
+// Span of the enclosing method, shown as owner::method
+#define TRACE_METHOD(category, owner) \
+    openauto::trace::TraceScope OPENAUTO_TRACE_CONCAT(traceScope, __LINE__)(category, owner, __FUNCTION__)
+
+#define TRACE_INSTANT(category, name) \
+    openauto::trace::Tracer::instant(category, nullptr, name)
+
+#define TRACE_INSTANT_VALUE(category, name, argumentName, value) \
+    openauto::trace::Tracer::instant(category, nullptr, name, argumentName, static_cast<int64_t>(value))
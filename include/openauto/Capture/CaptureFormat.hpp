@@ -0,0 +1,87 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace openauto
+{
+namespace capture
+{
+
+// A capture file is a header followed by records appended in arrival order. On close the writer adds an index
+// of record offsets and a trailer pointing at it, a file without trailer (crash, power loss) can still be
+// read by walking the records. All fields are little endian.
+
+static constexpr uint32_t cCaptureMagic = 0x5041434f;
+static constexpr uint32_t cCaptureIndexMagic = 0x58444e49;
+static constexpr uint32_t cCaptureVersion = 1;
+
+enum class CaptureRecordType : uint16_t
+{
+    MEDIA = 0,
+    FORMAT = 1
+};
+
+struct CaptureFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t startTime;
+};
+
+struct CaptureRecordHeader
+{
+    uint16_t type;
+    uint16_t channel;
+    uint32_t size;
+    uint64_t timestamp;
+    uint64_t captureTime;
+};
+
+struct CaptureStreamFormat
+{
+    uint32_t sampleRate;
+    uint32_t channelCount;
+    uint32_t sampleSize;
+    uint32_t reserved;
+};
+
+struct CaptureIndexEntry
+{
+    uint64_t offset;
+    uint64_t captureTime;
+};
+
+struct CaptureTrailer
+{
+    uint64_t indexOffset;
+    uint64_t entryCount;
+    uint32_t magic;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(CaptureFileHeader) == 16, "unexpected capture header layout");
+static_assert(sizeof(CaptureRecordHeader) == 24, "unexpected capture record layout");
+static_assert(sizeof(CaptureStreamFormat) == 16, "unexpected capture format layout");
+static_assert(sizeof(CaptureIndexEntry) == 16, "unexpected capture index layout");
+static_assert(sizeof(CaptureTrailer) == 24, "unexpected capture trailer layout");
+
+}
+}
@@ -0,0 +1,70 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "aasdk/Messenger/ChannelId.hpp"
+#include "CaptureFormat.hpp"
+
+namespace openauto
+{
+namespace capture
+{
+
+struct CaptureRecord
+{
+    CaptureRecordType type;
+    aasdk::messenger::ChannelId channel;
+    uint64_t timestamp;
+    uint64_t captureTime;
+    const uint8_t* data;
+    size_t size;
+};
+
+class CaptureReader: boost::noncopyable
+{
+public:
+    CaptureReader();
+    ~CaptureReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isIndexed() const;
+    uint64_t getStartTime() const;
+    size_t getRecordCount() const;
+    bool getRecord(size_t index, CaptureRecord& record) const;
+    bool getFormat(aasdk::messenger::ChannelId channel, CaptureStreamFormat& format) const;
+    size_t seek(uint64_t captureTime) const;
+
+private:
+    bool readIndex();
+    void rebuildIndex();
+
+    int fd_;
+    const uint8_t* data_;
+    size_t size_;
+    bool indexed_;
+    std::vector<CaptureIndexEntry> index_;
+};
+
+}
+}
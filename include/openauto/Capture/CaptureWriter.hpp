@@ -0,0 +1,94 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "aasdk/Messenger/ChannelId.hpp"
+#include "aasdk/Messenger/Timestamp.hpp"
+#include "aasdk/Common/Data.hpp"
+#include "CaptureFormat.hpp"
+
+namespace openauto
+{
+namespace capture
+{
+
+struct CaptureStatistics
+{
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    uint64_t droppedRecords = 0;
+};
+
+class CaptureWriter: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<CaptureWriter> Pointer;
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr size_t cMaxQueuedBytes = 16 * 1024 * 1024;
+
+    CaptureWriter(const std::string& path);
+    ~CaptureWriter();
+
+    bool isOpen() const;
+    const std::string& getPath() const;
+    void writeFormat(aasdk::messenger::ChannelId channel, uint32_t sampleRate, uint32_t channelCount, uint32_t sampleSize);
+    void write(aasdk::messenger::ChannelId channel, aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer);
+    CaptureStatistics getStatistics() const;
+
+private:
+    struct Record
+    {
+        CaptureRecordHeader header;
+        aasdk::common::Data payload;
+    };
+
+    void enqueue(CaptureRecordType type, aasdk::messenger::ChannelId channel, uint64_t timestamp, const uint8_t* data, size_t size);
+    void run();
+    void writeRecord(const Record& record);
+    void writeIndex();
+
+    std::string path_;
+    std::ofstream file_;
+    Clock::time_point startTime_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Record> queue_;
+    size_t queuedBytes_;
+    bool stopped_;
+    uint64_t offset_;
+    std::vector<CaptureIndexEntry> index_;
+    std::atomic<uint64_t> records_;
+    std::atomic<uint64_t> bytes_;
+    std::atomic<uint64_t> droppedRecords_;
+    std::thread thread_;
+};
+
+}
+}
@@ -26,7 +26,11 @@ namespace configuration
 enum class AudioOutputBackendType
 {
     RTAUDIO,
-    QT
+    QT,
+    NONE,
+    WAV_FILE,
+    MIXER,
+    ALSA
 };
 
 }
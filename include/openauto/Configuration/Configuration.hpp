@@ -39,6 +39,12 @@ public:
     HandednessOfTrafficType getHandednessOfTrafficType() const override;
     void showClock(bool value) override;
     bool showClock() const override;
+    std::string getCapturePath() const override;
+    void setCapturePath(const std::string& value) override;
+    std::string getLogSeverity() const override;
+    void setLogSeverity(const std::string& value) override;
+    std::string getTracePath() const override;
+    void setTracePath(const std::string& value) override;
 
     aasdk::proto::enums::VideoFPS::Enum getVideoFPS() const override;
     void setVideoFPS(aasdk::proto::enums::VideoFPS::Enum value) override;
@@ -52,6 +58,14 @@ public:
     QRect getVideoMargins() const override;
     void setWhitescreenWorkaround(bool value) override;
     bool getWhitescreenWorkaround() const override;
+    uint32_t getVideoMaxUnacked() const override;
+    void setVideoMaxUnacked(uint32_t value) override;
+    uint32_t getVideoLatencyBudget() const override;
+    void setVideoLatencyBudget(uint32_t value) override;
+    VideoOutputBackendType getVideoOutputBackendType() const override;
+    void setVideoOutputBackendType(VideoOutputBackendType value) override;
+    bool getVideoFrameThreading() const override;
+    void setVideoFrameThreading(bool value) override;
 
     bool getTouchscreenEnabled() const override;
     void setTouchscreenEnabled(bool value) override;
@@ -69,6 +83,18 @@ public:
     void setSpeechAudioChannelEnabled(bool value) override;
     AudioOutputBackendType getAudioOutputBackendType() const override;
     void setAudioOutputBackendType(AudioOutputBackendType value) override;
+    uint32_t getAudioMaxUnacked() const override;
+    void setAudioMaxUnacked(uint32_t value) override;
+    std::string getAudioFileOutputPath() const override;
+    void setAudioFileOutputPath(const std::string& value) override;
+    uint32_t getAudioDuckingLevel() const override;
+    void setAudioDuckingLevel(uint32_t value) override;
+    std::string getAudioAlsaDevice() const override;
+    void setAudioAlsaDevice(const std::string& value) override;
+    uint32_t getAudioAlsaPeriodSize() const override;
+    void setAudioAlsaPeriodSize(uint32_t value) override;
+    uint32_t getAudioAlsaPeriodCount() const override;
+    void setAudioAlsaPeriodCount(uint32_t value) override;
 
     std::string getWifiSSID() override;
     void setWifiSSID(std::string value) override;
@@ -88,12 +114,19 @@ private:
 
     HandednessOfTrafficType handednessOfTrafficType_;
     bool showClock_;
+    std::string capturePath_;
+    std::string logSeverity_;
+    std::string tracePath_;
     aasdk::proto::enums::VideoFPS::Enum videoFPS_;
     aasdk::proto::enums::VideoResolution::Enum videoResolution_;
     size_t screenDPI_;
     int32_t omxLayerIndex_;
     QRect videoMargins_;
     bool whitescreenWorkaround_;
+    uint32_t videoMaxUnacked_;
+    uint32_t videoLatencyBudget_;
+    VideoOutputBackendType videoOutputBackendType_;
+    bool videoFrameThreading_;
     bool enableTouchscreen_;
     ButtonCodes buttonCodes_;
     BluetoothAdapterType bluetoothAdapterType_;
@@ -101,6 +134,12 @@ private:
     bool musicAudioChannelEnabled_;
     bool speechAudiochannelEnabled_;
     AudioOutputBackendType audioOutputBackendType_;
+    uint32_t audioMaxUnacked_;
+    std::string audioFileOutputPath_;
+    uint32_t audioDuckingLevel_;
+    std::string audioAlsaDevice_;
+    uint32_t audioAlsaPeriodSize_;
+    uint32_t audioAlsaPeriodCount_;
     std::string wifiSSID_;
     std::string wifiPassword_;
     std::string wifiMAC_;
@@ -110,6 +149,9 @@ private:
     static const std::string cConfigFileName;
 
     static const std::string cGeneralShowClockKey;
+    static const std::string cGeneralCapturePathKey;
+    static const std::string cGeneralLogSeverityKey;
+    static const std::string cGeneralTracePathKey;
     static const std::string cGeneralHandednessOfTrafficTypeKey;
 
     static const std::string cVideoFPSKey;
@@ -119,10 +161,20 @@ private:
     static const std::string cVideoMarginWidth;
     static const std::string cVideoMarginHeight;
     static const std::string cVideoWhitescreenWorkaround;
+    static const std::string cVideoMaxUnacked;
+    static const std::string cVideoLatencyBudget;
+    static const std::string cVideoOutputBackendType;
+    static const std::string cVideoFrameThreading;
 
     static const std::string cAudioMusicAudioChannelEnabled;
     static const std::string cAudioSpeechAudioChannelEnabled;
     static const std::string cAudioOutputBackendType;
+    static const std::string cAudioMaxUnacked;
+    static const std::string cAudioFileOutputPath;
+    static const std::string cAudioDuckingLevel;
+    static const std::string cAudioAlsaDevice;
+    static const std::string cAudioAlsaPeriodSize;
+    static const std::string cAudioAlsaPeriodCount;
 
     static const std::string cBluetoothAdapterTypeKey;
     static const std::string cBluetoothRemoteAdapterAddressKey;
@@ -26,6 +26,7 @@
 #include "BluetootAdapterType.hpp"
 #include "HandednessOfTrafficType.hpp"
 #include "AudioOutputBackendType.hpp"
+#include "VideoOutputBackendType.hpp"
 
 namespace openauto
 {
@@ -48,6 +49,14 @@ public:
     virtual HandednessOfTrafficType getHandednessOfTrafficType() const = 0;
     virtual void showClock(bool value) = 0;
     virtual bool showClock() const = 0;
+    virtual std::string getCapturePath() const = 0;
+    virtual void setCapturePath(const std::string& value) = 0;
+    // default severity and per module overrides, e.g. "info,VideoService=debug"
+    virtual std::string getLogSeverity() const = 0;
+    virtual void setLogSeverity(const std::string& value) = 0;
+    // Chrome trace JSON written when the app exits, tracing is off while empty
+    virtual std::string getTracePath() const = 0;
+    virtual void setTracePath(const std::string& value) = 0;
 
     virtual aasdk::proto::enums::VideoFPS::Enum getVideoFPS() const = 0;
     virtual void setVideoFPS(aasdk::proto::enums::VideoFPS::Enum value) = 0;
@@ -61,6 +70,14 @@ public:
     virtual QRect getVideoMargins() const = 0;
     virtual void setWhitescreenWorkaround(bool value) = 0;
     virtual bool getWhitescreenWorkaround() const = 0;
+    virtual uint32_t getVideoMaxUnacked() const = 0;
+    virtual void setVideoMaxUnacked(uint32_t value) = 0;
+    virtual uint32_t getVideoLatencyBudget() const = 0;
+    virtual void setVideoLatencyBudget(uint32_t value) = 0;
+    virtual VideoOutputBackendType getVideoOutputBackendType() const = 0;
+    virtual void setVideoOutputBackendType(VideoOutputBackendType value) = 0;
+    virtual bool getVideoFrameThreading() const = 0;
+    virtual void setVideoFrameThreading(bool value) = 0;
 
     virtual bool getTouchscreenEnabled() const = 0;
     virtual void setTouchscreenEnabled(bool value) = 0;
@@ -78,6 +95,18 @@ public:
     virtual void setSpeechAudioChannelEnabled(bool value) = 0;
     virtual AudioOutputBackendType getAudioOutputBackendType() const = 0;
     virtual void setAudioOutputBackendType(AudioOutputBackendType value) = 0;
+    virtual uint32_t getAudioMaxUnacked() const = 0;
+    virtual void setAudioMaxUnacked(uint32_t value) = 0;
+    virtual std::string getAudioFileOutputPath() const = 0;
+    virtual void setAudioFileOutputPath(const std::string& value) = 0;
+    virtual uint32_t getAudioDuckingLevel() const = 0;
+    virtual void setAudioDuckingLevel(uint32_t value) = 0;
+    virtual std::string getAudioAlsaDevice() const = 0;
+    virtual void setAudioAlsaDevice(const std::string& value) = 0;
+    virtual uint32_t getAudioAlsaPeriodSize() const = 0;
+    virtual void setAudioAlsaPeriodSize(uint32_t value) = 0;
+    virtual uint32_t getAudioAlsaPeriodCount() const = 0;
+    virtual void setAudioAlsaPeriodCount(uint32_t value) = 0;
 
     virtual std::string getWifiSSID() = 0;
     virtual void setWifiSSID(std::string value) = 0;
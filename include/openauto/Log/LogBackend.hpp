@@ -0,0 +1,137 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "openauto/Log/LogRing.hpp"
+#include "openauto/Log/LogSite.hpp"
+
+namespace openauto
+{
+namespace log
+{
+
+struct ThreadLog;
+
+// Every thread that logs gets its own LogRing, a flusher thread merges them by time every
+// cFlushInterval and writes the lines to std::cout. The writers never lock or wait, the mutexes
+// here are only taken when a site or thread logs for the first time and by the flusher.
+// The instance is never destroyed, the rings are drained once more at exit.
+class LogBackend: boost::noncopyable
+{
+public:
+    static constexpr size_t cRingCapacity = 128;
+    // milliseconds
+    static constexpr int64_t cFlushInterval = 10;
+    // flush passes between reports of suppressed messages
+    static constexpr uint32_t cSuppressedReportInterval = 100;
+
+    static LogBackend& getInstance();
+
+    // "info" or "info,VideoService=debug,GSTVideoOutput=warning", modules are source file names
+    void configure(const std::string& spec);
+    Severity getDefaultSeverity() const;
+    void registerSite(LogSite& site);
+    std::shared_ptr<LogRing> createRing();
+    void flush();
+    void stop();
+
+private:
+    LogBackend();
+
+    void run();
+    void format(const LogEntry& entry);
+    void appendLine(std::chrono::system_clock::time_point time, Severity severity, const char* text);
+    void reportSuppressed();
+    Severity getThreshold(const std::string& module) const;
+    static bool parseSeverity(const std::string& name, Severity& severity);
+    static const char* getSeverityName(Severity severity);
+
+    mutable std::mutex sitesMutex_;
+    std::vector<LogSite*> sites_;
+    Severity defaultSeverity_;
+    std::map<std::string, Severity> moduleSeverities_;
+    std::mutex ringsMutex_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    std::mutex flushMutex_;
+    std::string output_;
+    std::atomic<bool> running_;
+    std::thread flusher_;
+};
+
+// One execution of a LOG statement. The checks are inline, a disabled statement costs a relaxed load
+// and a compare; an enabled one formats straight into a slot of the thread's ring.
+class LogRecord: boost::noncopyable
+{
+public:
+    LogRecord(LogSite& site, Severity severity, const char* function)
+        : threadLog_(nullptr)
+        , entry_(nullptr)
+        , stream_(nullptr)
+    {
+        if(site.isEnabled(severity))
+        {
+            this->open(site, severity, function);
+        }
+    }
+
+    ~LogRecord()
+    {
+        if(entry_ != nullptr)
+        {
+            this->close(false);
+        }
+    }
+
+    bool isOpen() const
+    {
+        return entry_ != nullptr;
+    }
+
+    std::ostream& stream()
+    {
+        return *stream_;
+    }
+
+    void commit()
+    {
+        this->close(true);
+    }
+
+private:
+    void open(LogSite& site, Severity severity, const char* function);
+    void close(bool push);
+
+    ThreadLog* threadLog_;
+    LogEntry* entry_;
+    std::ostream* stream_;
+};
+
+}
+}
@@ -0,0 +1,74 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "openauto/Log/LogSite.hpp"
+
+namespace openauto
+{
+namespace log
+{
+
+struct LogEntry
+{
+    static constexpr size_t cMaxLength = 464;
+
+    std::chrono::system_clock::time_point time;
+    Severity severity = Severity::info;
+    const LogSite* site = nullptr;
+    const char* function = nullptr;
+    int32_t threadId = 0;
+    uint32_t suppressed = 0;
+    size_t length = 0;
+    char text[cMaxLength];
+};
+
+// Entries of one writing thread for the flusher, neither side takes a lock. The message is formatted
+// straight into the acquired slot. A full ring drops the new entry, the writer never waits.
+class LogRing: boost::noncopyable
+{
+public:
+    LogRing(size_t capacity);
+
+    // writer: the slot to fill next, nullptr and counted as dropped while the ring is full
+    LogEntry* acquire();
+    void push();
+
+    // flusher: the oldest entry, nullptr while the ring is empty
+    LogEntry* front();
+    void pop();
+    uint64_t takeDropped();
+
+private:
+    std::vector<LogEntry> slots_;
+    // positions only grow, the difference is the number of queued entries
+    std::atomic<size_t> head_;
+    std::atomic<size_t> tail_;
+    std::atomic<uint64_t> dropped_;
+};
+
+}
+}
@@ -0,0 +1,75 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <boost/log/trivial.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace openauto
+{
+namespace log
+{
+
+typedef boost::log::trivial::severity_level Severity;
+
+// One LOG statement, created on its first execution and never destroyed. LogBackend pushes the
+// threshold of the site's module in whenever the configuration changes, so a disabled statement
+// costs a relaxed load. Enabled statements are limited to cRateLimitBurst messages per
+// cRateLimitInterval, the rest is counted and reported with the next message that passes.
+class LogSite: boost::noncopyable
+{
+public:
+    static constexpr uint32_t cRateLimitBurst = 20;
+    // milliseconds
+    static constexpr int64_t cRateLimitInterval = 1000;
+
+    LogSite(const char* file, int line);
+
+    bool isEnabled(Severity severity) const
+    {
+        return static_cast<int>(severity) >= threshold_.load(std::memory_order_relaxed);
+    }
+
+    bool admit(uint32_t& suppressed);
+    // messages suppressed since the last one passed, once the site has been quiet for an interval
+    uint32_t takeSuppressed();
+    void setThreshold(Severity severity);
+
+    const char* getFile() const;
+    int getLine() const;
+    const std::string& getModule() const;
+
+private:
+    static int64_t now();
+
+    const char* file_;
+    int line_;
+    std::string module_;
+    std::atomic<int> threshold_;
+    std::atomic<int64_t> windowStart_;
+    std::atomic<uint32_t> windowCount_;
+    std::atomic<uint32_t> suppressed_;
+};
+
+}
+}
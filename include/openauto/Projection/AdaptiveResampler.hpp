@@ -0,0 +1,73 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace openauto
+{
+namespace projection
+{
+
+// Resamples by a ratio a few hundred ppm around one that may change between any two blocks, to
+// follow a drifting clock. A 32 tap windowed sinc tabled in 256 phases, interpolated linearly
+// between neighbouring phases. At a ratio of exactly one the samples pass through unchanged.
+// Used like AudioResampler, push or pull, from a single thread. All buffers are allocated up front.
+class AdaptiveResampler
+{
+public:
+    AdaptiveResampler(uint32_t channelCount, size_t maxInputFrames = 8192);
+
+    // input frames consumed per output frame
+    void setRatio(double ratio);
+    double getRatio() const;
+    size_t write(const int16_t* samples, size_t frameCount);
+    size_t read(int16_t* samples, size_t frameCount);
+    size_t getAvailableFrames() const;
+    size_t getRequiredInputFrames(size_t outputFrames) const;
+    void reset();
+
+private:
+    void createFilter();
+    void compact();
+
+    static constexpr size_t cTaps = 32;
+    static constexpr size_t cPhaseBits = 8;
+    static constexpr size_t cFractionBits = 32;
+    static constexpr size_t cMaxChannels = 8;
+
+    uint32_t channelCount_;
+    size_t capacity_;
+    // one row per phase plus the next full frame, and the difference of every row to the next
+    std::vector<float> coefficients_;
+    std::vector<float> differences_;
+    std::vector<float> interpolated_;
+    std::vector<float> history_;
+    size_t count_;
+    // first tap of the next output frame and the fraction of a frame past it, in cFractionBits
+    size_t position_;
+    uint64_t fraction_;
+    uint64_t step_;
+};
+
+}
+}
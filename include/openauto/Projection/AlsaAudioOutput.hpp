@@ -0,0 +1,106 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_ALSA
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <alsa/asoundlib.h>
+#include <boost/noncopyable.hpp>
+#include "IAudioOutput.hpp"
+#include "RingBuffer.hpp"
+#include "GainRamp.hpp"
+#include "AudioResampler.hpp"
+#include "ClockDriftCompensator.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+// Writes straight into the mmap'ed ring of an ALSA device from a real-time thread, without
+// a sound server in between. Rates and channel counts the device does not take are converted
+// with AudioResampler instead of the ALSA plug layer.
+class AlsaAudioOutput: public IAudioOutput, boost::noncopyable
+{
+public:
+    AlsaAudioOutput(const std::string& deviceName, uint32_t periodSize, uint32_t periodCount, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    ~AlsaAudioOutput();
+
+    bool open() override;
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void start() override;
+    void stop() override;
+    void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
+    void setPlaybackObserver(PlaybackObserver observer) override;
+    uint32_t getSampleSize() const override;
+    uint32_t getChannelCount() const override;
+    uint32_t getSampleRate() const override;
+    bool isBackpressured() const override;
+    size_t getBufferedBytes() const override;
+    uint64_t getUnderrunCount() const override;
+    uint64_t getLateCallbackCount() const override;
+    double getClockDrift() const override;
+    uint64_t getShortCommitCount() const;
+    // the writer thread recovers as after a real xrun, which the null plugin used in CI never has
+    void injectXrun();
+
+private:
+    bool configure();
+    void run();
+    bool recover(int error);
+    void fill(int16_t* samples, size_t frameCount);
+    void read(int16_t* samples, size_t frameCount);
+    void notifyPlayback(const int16_t* samples, size_t frameCount);
+    void doSuspend();
+
+    std::string deviceName_;
+    snd_pcm_uframes_t periodSize_;
+    uint32_t periodCount_;
+    uint32_t channelCount_;
+    uint32_t sampleSize_;
+    uint32_t sampleRate_;
+    RingBuffer audioBuffer_;
+    size_t lastWriteSize_;
+    std::atomic<uint64_t> underruns_;
+    std::atomic<uint64_t> xruns_;
+    std::atomic<uint64_t> shortCommits_;
+    std::atomic<bool> xrunRequested_;
+    GainRamp gainRamp_;
+    PlaybackObserver playbackObserver_;
+    ClockDriftCompensator driftCompensator_;
+    // owned by the writer thread once the device is configured
+    std::unique_ptr<AudioResampler> resampler_;
+    std::vector<int16_t> staging_;
+    snd_pcm_t* pcm_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+    // serializes open, start and stop, the writer thread never takes it
+    std::mutex mutex_;
+};
+
+}
+}
+
+#endif
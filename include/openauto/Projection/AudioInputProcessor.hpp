@@ -0,0 +1,119 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "EchoReference.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+struct AudioInputProcessorStatistics
+{
+    uint64_t frames = 0;
+    uint64_t overBudgetFrames = 0;
+    uint64_t totalTime = 0;
+    uint64_t maxTime = 0;
+};
+
+// Echo cancellation and noise suppression for mono capture, in 10 ms frames.
+// The echo canceller is a time domain NLMS filter over cEchoTail of the far end signal, frozen
+// while the near end talks louder than the echo could be. The noise suppressor applies a Wiener
+// gain per bin of a 50% overlapped FFT, against a noise floor following the minimum of the
+// smoothed power. Filter length and FFT size are fixed, so is the cost of a frame.
+// Not thread safe, configured and run by the capture thread.
+class AudioInputProcessor: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<AudioInputProcessor> Pointer;
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr std::chrono::milliseconds cFrameDuration{10};
+    static constexpr std::chrono::milliseconds cEchoTail{32};
+    // a tenth of the frame, the capture thread also runs the Qt event loop
+    static constexpr std::chrono::microseconds cFrameBudget{1000};
+
+    AudioInputProcessor(uint32_t sampleRate, EchoReference::Pointer echoReference);
+
+    void setEchoCancellation(bool enabled);
+    void setNoiseSuppression(bool enabled);
+    bool isEnabled() const;
+    // in place, the output lags the input by getLatencyFrames()
+    void process(int16_t* samples, size_t frameCount);
+    size_t getLatencyFrames() const;
+    void reset();
+    // nanoseconds per frame
+    AudioInputProcessorStatistics getStatistics() const;
+
+private:
+    void processFrame();
+    void cancelEcho(float* frame);
+    void suppressNoise(float* frame);
+    void transform(bool inverse);
+
+    static constexpr float cStepSize = 0.5f;
+    static constexpr float cDoubleTalkThreshold = 0.5f;
+    static constexpr size_t cDoubleTalkHoldFrames = 3;
+    static constexpr size_t cNoiseLearningFrames = 20;
+    static constexpr float cNoiseRise = 1.005f;
+    static constexpr float cMinGain = 0.1f;
+
+    uint32_t sampleRate_;
+    EchoReference::Pointer echoReference_;
+    bool echoCancellation_;
+    bool noiseSuppression_;
+    size_t frameSize_;
+    size_t position_;
+    std::vector<float> input_;
+    std::vector<float> output_;
+
+    size_t taps_;
+    // reversed, the last weight applies to the newest far end sample
+    std::vector<float> weights_;
+    // taps - 1 samples of history followed by the far end of the current frame
+    std::vector<float> farEnd_;
+    size_t doubleTalkHold_;
+
+    size_t fftSize_;
+    std::vector<float> window_;
+    // the previous frame followed by the current one
+    std::vector<float> analysis_;
+    std::vector<float> overlap_;
+    std::vector<float> real_;
+    std::vector<float> imaginary_;
+    std::vector<float> cosines_;
+    std::vector<float> sines_;
+    std::vector<size_t> bitReversal_;
+    std::vector<float> smoothedPower_;
+    std::vector<float> noisePower_;
+    std::vector<float> previousSnr_;
+    size_t noiseFrames_;
+
+    AudioInputProcessorStatistics statistics_;
+};
+
+}
+}
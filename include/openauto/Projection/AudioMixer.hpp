@@ -0,0 +1,75 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <RtAudio.h>
+#include <boost/noncopyable.hpp>
+
+namespace openauto
+{
+namespace projection
+{
+
+class AudioMixerInput;
+
+// Owns the only audio device stream and mixes all inputs into it in one callback, instead of
+// a stream, buffer and callback thread per channel.
+class AudioMixer: public std::enable_shared_from_this<AudioMixer>, boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<AudioMixer> Pointer;
+
+    static constexpr uint32_t cSampleRate = 48000;
+    static constexpr uint32_t cChannelCount = 2;
+    static constexpr uint32_t cPeriodFrames = 1024;
+    static constexpr size_t cMaxInputs = 8;
+
+    AudioMixer();
+    ~AudioMixer();
+
+    std::shared_ptr<AudioMixerInput> createInput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    uint64_t getLateCallbackCount() const;
+
+private:
+    friend class AudioMixerInput;
+
+    bool acquire();
+    void release();
+    void removeInput(AudioMixerInput* input);
+    void mix(int16_t* output, size_t frameCount);
+    static int audioBufferReadHandler(void* outputBuffer, void* inputBuffer, unsigned int nBufferFrames,
+                                      double streamTime, RtAudioStreamStatus status, void* userData);
+
+    std::unique_ptr<RtAudio> dac_;
+    // serializes acquire and release, the callback never takes it
+    std::mutex mutex_;
+    size_t users_;
+    std::array<std::atomic<AudioMixerInput*>, cMaxInputs> inputs_;
+    std::atomic<bool> mixing_;
+    std::vector<float> mixBuffer_;
+    std::atomic<uint64_t> lateCallbacks_;
+};
+
+}
+}
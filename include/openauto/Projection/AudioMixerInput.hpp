@@ -0,0 +1,92 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "IAudioOutput.hpp"
+#include "RingBuffer.hpp"
+#include "AudioMixer.hpp"
+#include "GainRamp.hpp"
+#include "AudioResampler.hpp"
+#include "ClockDriftCompensator.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+// One channel of the AudioMixer. Written like any other output, read and converted to the
+// mixer format on the mixer callback.
+class AudioMixerInput: public IAudioOutput, boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<AudioMixerInput> Pointer;
+
+    AudioMixerInput(AudioMixer::Pointer mixer, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    ~AudioMixerInput();
+
+    bool open() override;
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void start() override;
+    void stop() override;
+    void suspend() override;
+    void flush() override;
+    uint32_t getSampleSize() const override;
+    uint32_t getChannelCount() const override;
+    uint32_t getSampleRate() const override;
+    bool isBackpressured() const override;
+    size_t getBufferedBytes() const override;
+    uint64_t getUnderrunCount() const override;
+    uint64_t getLateCallbackCount() const override;
+    double getClockDrift() const override;
+
+    void setGain(float gain) override;
+    void setPlaybackObserver(PlaybackObserver observer) override;
+    float getGain() const;
+
+private:
+    friend class AudioMixer;
+
+    void mixInto(float* mix, size_t frameCount);
+    size_t convert(size_t frameCount);
+    void notifyPlayback(size_t frameCount);
+
+    AudioMixer::Pointer mixer_;
+    uint32_t channelCount_;
+    uint32_t sampleSize_;
+    uint32_t sampleRate_;
+    RingBuffer audioBuffer_;
+    size_t lastWriteSize_;
+    bool opened_;
+    std::atomic<bool> active_;
+    std::atomic<uint64_t> underruns_;
+
+    // owned by the mixer callback
+    std::vector<int16_t> staging_;
+    std::vector<float> converted_;
+    GainRamp gainRamp_;
+    PlaybackObserver playbackObserver_;
+    AudioResampler resampler_;
+    ClockDriftCompensator driftCompensator_;
+};
+
+}
+}
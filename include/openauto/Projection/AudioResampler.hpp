@@ -0,0 +1,83 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace openauto
+{
+namespace projection
+{
+
+// Polyphase windowed-sinc resampler with a channel up/down-mixer, so streams of the phone can
+// be played and recorded at the rate and channel count of the device instead of leaving that to
+// the sound server. Not thread safe, both sides are driven by the same thread.
+//
+// Push: write what arrived, read getAvailableFrames(). Pull: write getRequiredInputFrames(n)
+// frames, then read n. All buffers are allocated up front, neither call allocates.
+class AudioResampler
+{
+public:
+    AudioResampler(uint32_t inputRate, uint32_t inputChannels, uint32_t outputRate, uint32_t outputChannels, size_t maxInputFrames = 8192);
+
+    size_t write(const int16_t* samples, size_t frameCount);
+    size_t read(int16_t* samples, size_t frameCount);
+    // float output keeps the int16 scale, for consumers that mix before converting back
+    size_t read(float* samples, size_t frameCount);
+    size_t getAvailableFrames() const;
+    size_t getRequiredInputFrames(size_t outputFrames) const;
+    void reset();
+
+    uint32_t getInputRate() const;
+    uint32_t getInputChannels() const;
+    uint32_t getOutputRate() const;
+    uint32_t getOutputChannels() const;
+    size_t getTapCount() const;
+
+private:
+    void createFilter();
+    void compact();
+    template<typename SampleType>
+    size_t process(SampleType* samples, size_t frameCount);
+
+    static constexpr size_t cBaseTaps = 64;
+    static constexpr double cCutoff = 0.9;
+    static constexpr double cKaiserBeta = 8.6;
+
+    uint32_t inputRate_;
+    uint32_t inputChannels_;
+    uint32_t outputRate_;
+    uint32_t outputChannels_;
+    uint32_t filterChannels_;
+    uint64_t interpolation_;
+    uint64_t decimation_;
+    size_t taps_;
+    size_t capacity_;
+    std::vector<float> coefficients_;
+    // one planar history per filtered channel, the first taps - 1 samples are the filter state
+    std::vector<float> history_;
+    size_t count_;
+    size_t position_;
+    uint64_t phase_;
+};
+
+}
+}
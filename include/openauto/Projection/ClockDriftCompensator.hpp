@@ -0,0 +1,129 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "aasdk/Messenger/Timestamp.hpp"
+#include "AdaptiveResampler.hpp"
+#include "RingBuffer.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+// Keeps the queue of an output from creeping up or draining when the sample clock of the phone
+// and the one of the DAC drift apart over a long drive. Both clocks are compared to the local
+// steady clock, the phone's through the media timestamps and the DAC's through the frames it
+// consumed, each at the lower envelope of its offsets so queueing delays drop out. A slow loop
+// on the queue fill corrects what that estimate misses. The queue is then read through an
+// AdaptiveResampler at the corrected ratio.
+// onWrite belongs to the writer thread, read and reset to the audio thread or to whoever
+// controls it while it is stopped.
+class ClockDriftCompensator
+{
+public:
+    typedef std::shared_ptr<ClockDriftCompensator> Pointer;
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr double cMaxCorrection = 500.0;
+
+    ClockDriftCompensator(uint32_t sampleRate, uint32_t channelCount);
+
+    void onWrite(aasdk::messenger::Timestamp::ValueType timestamp);
+    // reads what frameCount frames of playback need from the queue, returns the frames produced
+    size_t read(RingBuffer& buffer, int16_t* samples, size_t frameCount);
+    void reset();
+    // ppm, positive when the phone produces faster than the device plays
+    double getDrift() const;
+    uint32_t getChannelCount() const;
+
+private:
+    // lower envelope of a clock offset in microseconds, one minimum per window
+    class OffsetTrend
+    {
+    public:
+        OffsetTrend();
+        // true when a window was completed
+        bool add(Clock::time_point now, int64_t offset);
+        void reset();
+        bool isValid() const;
+        // how much faster the remote clock runs than the local one, ppm
+        double getDrift() const;
+
+    private:
+        struct Window
+        {
+            Clock::time_point start;
+            int64_t minimum;
+        };
+
+        std::array<Window, 30> windows_;
+        size_t windowCount_;
+        Window current_;
+        bool started_;
+    };
+
+    size_t readQueue(RingBuffer& buffer, int16_t* samples, size_t frameCount);
+    void onPlayed(Clock::time_point now, size_t frameCount, size_t bufferedFrames);
+    void updateCorrection();
+
+    static constexpr std::chrono::seconds cWindow{10};
+    static constexpr std::chrono::seconds cMinSpan{60};
+    static constexpr std::chrono::seconds cMaxGap{1};
+    static constexpr std::chrono::microseconds cMaxJump{1000000};
+    static constexpr std::chrono::milliseconds cMaxFillStep{20};
+    static constexpr size_t cMaxBlockFrames = 2048;
+    static constexpr std::chrono::seconds cFillTimeConstant{300};
+
+    uint32_t sampleRate_;
+    uint32_t channelCount_;
+    AdaptiveResampler resampler_;
+    std::vector<int16_t> input_;
+
+    OffsetTrend phoneTrend_;
+    std::atomic<bool> phoneResetRequested_;
+    std::atomic<bool> phoneValid_;
+    std::atomic<double> phoneDrift_;
+
+    OffsetTrend deviceTrend_;
+    Clock::time_point playStart_;
+    Clock::time_point lastRead_;
+    uint64_t playedFrames_;
+    bool playing_;
+
+    double fillSum_;
+    uint64_t fillCount_;
+    bool fillEmptied_;
+    double lastFillMean_;
+    double targetFill_;
+    bool hasFillMean_;
+    double fillIntegral_;
+    double timestampDrift_;
+    bool timestampsUsed_;
+    std::atomic<double> drift_;
+};
+
+}
+}
@@ -0,0 +1,75 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "IAudioOutput.hpp"
+#include "AudioResampler.hpp"
+#include "RingBuffer.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+// What the audio outputs play, as mono at the capture rate, the far end signal the echo canceller
+// subtracts from the microphone. Every output feeds its own source through its playback
+// observer, the capture thread reads the sum of all of them.
+class EchoReference: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<EchoReference> Pointer;
+
+    EchoReference(uint32_t sampleRate);
+
+    IAudioOutput::PlaybackObserver createSource();
+    // frames a source did not play are silence
+    void read(float* samples, size_t frameCount);
+    void clear();
+    uint32_t getSampleRate() const;
+
+private:
+    struct Source
+    {
+        Source(uint32_t sampleRate);
+
+        void write(const char* data, size_t size, uint32_t sampleRate, uint32_t channelCount);
+
+        uint32_t outputRate;
+        // created on the first block, the format of an output is only known once it runs
+        std::unique_ptr<AudioResampler> resampler;
+        std::vector<int16_t> converted;
+        RingBuffer ring;
+    };
+
+    static constexpr size_t cRingSize = 8192;
+    static constexpr size_t cMaxBlockFrames = 4096;
+
+    uint32_t sampleRate_;
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<Source>> sources_;
+    std::vector<int16_t> block_;
+};
+
+}
+}
@@ -0,0 +1,71 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace openauto
+{
+namespace projection
+{
+
+enum class VideoFrameType
+{
+    CONFIG,
+    IDR,
+    REFERENCE,
+    NON_REFERENCE
+};
+
+struct FrameDropStatistics
+{
+    uint64_t droppedNonReference = 0;
+    uint64_t droppedUntilIdr = 0;
+    uint64_t skipsToIdr = 0;
+};
+
+class FrameDropPolicy
+{
+public:
+    // budget in microseconds of video waiting in front of the decoder, 0 disables dropping
+    FrameDropPolicy(uint64_t latencyBudget);
+
+    static VideoFrameType classify(const uint8_t* data, size_t size);
+
+    bool shouldDrop(VideoFrameType type, uint64_t queuedLatency);
+    // a frame was lost anyway, everything up to the next IDR would decode to garbage
+    void skipToIdr();
+    void reset();
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    FrameDropStatistics getStatistics() const;
+
+private:
+    uint64_t latencyBudget_;
+    std::atomic<bool> enabled_;
+    bool skipToIdr_;
+    std::atomic<uint64_t> droppedNonReference_;
+    std::atomic<uint64_t> droppedUntilIdr_;
+    std::atomic<uint64_t> skipsToIdr_;
+};
+
+}
+}
@@ -19,6 +19,7 @@
 #ifdef USE_GST
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
@@ -26,6 +27,8 @@
 #include <boost/circular_buffer.hpp>
 #include <boost/noncopyable.hpp>
 #include "openauto/Projection/VideoOutput.hpp"
+#include "openauto/Projection/H264NalScanner.hpp"
+#include "openauto/Projection/FrameDropPolicy.hpp"
 #include <gst/gst.h>
 #include <gst/app/gstappsrc.h>
 #include <gst/app/gstappsink.h>
@@ -91,6 +94,16 @@ inline const char* ToPipeline(H264_Decoder v)
     }
 }
 
+struct VideoBufferStatistics
+{
+    uint64_t frames = 0;
+    uint64_t copies = 0;
+    uint64_t copiedBytes = 0;
+    uint64_t pooledBuffers = 0;
+    uint64_t allocations = 0;
+    uint64_t rewrittenHeaders = 0;
+};
+
 class GSTVideoOutput: public QObject, public VideoOutput, boost::noncopyable
 {
     Q_OBJECT
@@ -102,7 +115,12 @@ public:
     bool init() override;
     void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
     void stop() override;
+    bool isBackpressured() const override;
+    uint64_t getQueuedLatency() const override;
+    void setFrameDropping(bool enabled) override;
     void resize();
+    VideoBufferStatistics getBufferStatistics() const;
+    FrameDropStatistics getDropStatistics() const;
 
 signals:
     void startPlayback();
@@ -116,19 +134,45 @@ public slots:
     void dumpDot();
 private:
     static GstPadProbeReturn convertProbe(GstPad* pad, GstPadProbeInfo* info, void*);
+    static GstPadProbeReturn decodedProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+    static GstPadProbeReturn renderedProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+    static void onEnoughData(GstAppSrc* src, gpointer data);
+    static void onNeedData(GstAppSrc* src, guint length, gpointer data);
     static gboolean busCallback(GstBus* bus, GstMessage* message, gpointer data);
+    void addLatencyProbe(GstElement* element, GstPadProbeCallback callback);
+    void updatePipelineLatency();
+    GstClockTime stampBuffer(GstBuffer* buffer);
     H264_Decoder findPreferredVideoDecoder();
+    QSize getVideoSize() const;
+    void createBufferPool();
+    void destroyBufferPool();
+    GstBuffer* acquireBuffer(size_t size);
+    bool pushBuffer(const uint8_t* data, size_t size);
+    bool pushRewrittenBuffer(const uint8_t* data, size_t size);
+    bool pushToSource(GstBuffer* buffer, size_t size);
 
-    bool firstHeaderParsed = false;
+    static constexpr size_t cSpsRewriteSlack = 16;
 
     QGst::ElementPtr videoSink_;
     QQuickWidget* videoWidget_;
     GstElement* vidPipeline_;
     GstVideoFilter* vidCrop_;
     GstAppSrc* vidSrc_;
+    GstElement* vidQueue_;
     QWidget* videoContainer_;
     QGst::Quick::VideoSurface* surface_;
     std::function<void(bool)> activeCallback_;
+    GstBufferPool* bufferPool_;
+    size_t bufferPoolSize_;
+    std::atomic<uint64_t> writtenFrames_;
+    std::atomic<uint64_t> bufferCopies_;
+    std::atomic<uint64_t> copiedBytes_;
+    std::atomic<uint64_t> pooledBuffers_;
+    std::atomic<uint64_t> bufferAllocations_;
+    std::atomic<uint64_t> rewrittenHeaders_;
+    std::atomic<bool> sourceFull_;
+    H264SpsRewriter spsRewriter_;
+    FrameDropPolicy dropPolicy_;
 };
 
 }
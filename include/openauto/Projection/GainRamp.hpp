@@ -0,0 +1,80 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace openauto
+{
+namespace projection
+{
+
+struct GainRampStatistics
+{
+    uint64_t calls = 0;
+    uint64_t rampingCalls = 0;
+    uint64_t totalTime = 0;
+    uint64_t maxTime = 0;
+};
+
+// Moves the gain of an output linearly to its target instead of switching it, which would click.
+// setTarget may be called from any thread, apply only from the audio thread.
+class GainRamp
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr std::chrono::milliseconds cRampTime{150};
+
+    GainRamp(uint32_t sampleRate, uint32_t channelCount);
+
+    void setTarget(float gain);
+    float getTarget() const;
+    void apply(int16_t* samples, size_t frameCount);
+    void apply(float* samples, size_t frameCount);
+    // mix[i] += samples[i] * gain, the ramped part of samples is left with the gain applied
+    void mixInto(float* mix, float* samples, size_t frameCount);
+    // nanoseconds spent in apply, to check the ramp against the period budget
+    GainRampStatistics getStatistics() const;
+
+private:
+    template<typename SampleType>
+    void process(SampleType* samples, size_t frameCount);
+    // applies the part of a ramp that falls into this call, returns its frame count
+    template<typename SampleType>
+    size_t ramp(SampleType* samples, size_t frameCount);
+    void record(Clock::time_point started, bool ramping);
+
+    uint32_t channelCount_;
+    size_t rampFrames_;
+    std::atomic<float> target_;
+    float current_;
+    float step_;
+    float stepTarget_;
+    std::atomic<uint64_t> calls_;
+    std::atomic<uint64_t> rampingCalls_;
+    std::atomic<uint64_t> totalTime_;
+    std::atomic<uint64_t> maxTime_;
+};
+
+}
+}
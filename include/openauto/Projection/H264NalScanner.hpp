@@ -0,0 +1,91 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace openauto
+{
+namespace projection
+{
+
+enum class NalUnitType : uint8_t
+{
+    UNSPECIFIED = 0,
+    SLICE = 1,
+    IDR = 5,
+    SEI = 6,
+    SPS = 7,
+    PPS = 8,
+    AUD = 9
+};
+
+struct NalUnit
+{
+    // start points at the start code, data at the NAL header byte
+    const uint8_t* start;
+    const uint8_t* data;
+    size_t size;
+
+    NalUnitType type() const { return static_cast<NalUnitType>(data[0] & 0x1F); }
+    uint8_t refIdc() const { return (data[0] >> 5) & 0x03; }
+    size_t totalSize() const { return static_cast<size_t>(data - start) + size; }
+};
+
+class H264NalScanner
+{
+public:
+    H264NalScanner(const uint8_t* data, size_t size);
+
+    bool next(NalUnit& unit);
+
+    static const uint8_t* findStartCode(const uint8_t* begin, const uint8_t* end);
+    static bool contains(const uint8_t* data, size_t size, NalUnitType type);
+
+private:
+    const uint8_t* end_;
+    const uint8_t* current_;
+};
+
+class H264SpsRewriter
+{
+public:
+    static constexpr size_t cMaxSpsSize = 256;
+
+    // Clears the VUI video_signal_type information of a SPS NAL unit. Returns false when the unit
+    // does not carry it (nothing to rewrite), is longer than cMaxSpsSize or cannot be parsed, in which
+    // case it must be passed on as is.
+    bool rewrite(const NalUnit& unit);
+
+    const uint8_t* data() const;
+    size_t size() const;
+
+private:
+    size_t unescape(const uint8_t* data, size_t size);
+    size_t escape(size_t size);
+
+    uint8_t rbsp_[cMaxSpsSize];
+    uint8_t rewritten_[cMaxSpsSize];
+    uint8_t output_[cMaxSpsSize * 3 / 2 + 1];
+    size_t outputSize_ = 0;
+};
+
+}
+}
@@ -21,17 +21,25 @@
 #include <memory>
 #include "aasdk/IO/Promise.hpp"
 #include "aasdk/Common/Data.hpp"
+#include "aasdk/Messenger/Timestamp.hpp"
 
 namespace openauto
 {
 namespace projection
 {
 
+struct AudioInputChunk
+{
+    // capture time of the first frame, in microseconds of the high resolution clock
+    aasdk::messenger::Timestamp::ValueType timestamp;
+    aasdk::common::Data data;
+};
+
 class IAudioInput
 {
 public:
     typedef aasdk::io::Promise<void, void> StartPromise;
-    typedef aasdk::io::Promise<aasdk::common::Data, void> ReadPromise;
+    typedef aasdk::io::Promise<AudioInputChunk, void> ReadPromise;
     typedef std::shared_ptr<IAudioInput> Pointer;
 
     virtual ~IAudioInput() = default;
@@ -39,11 +47,17 @@ public:
     virtual bool open() = 0;
     virtual bool isActive() const = 0;
     virtual void read(ReadPromise::Pointer promise) = 0;
+    // hands the data of a chunk back once it was sent, so the next chunk can reuse it
+    virtual void release(aasdk::common::Data data) = 0;
     virtual void start(StartPromise::Pointer promise) = 0;
     virtual void stop() = 0;
+    // as the phone asks for it when it opens the microphone, before start
+    virtual void setSignalProcessing(bool echoCancellation, bool noiseSuppression) = 0;
     virtual uint32_t getSampleSize() const = 0;
     virtual uint32_t getChannelCount() const = 0;
     virtual uint32_t getSampleRate() const = 0;
+    virtual uint64_t getOverrunCount() const = 0;
+    virtual uint64_t getDroppedFrameCount() const = 0;
 };
 
 }
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include "aasdk/Messenger/Timestamp.hpp"
 #include "aasdk/Common/Data.hpp"
@@ -31,6 +32,8 @@ class IAudioOutput
 {
 public:
     typedef std::shared_ptr<IAudioOutput> Pointer;
+    // sees every block handed to the device, on the playback thread, in the format it was handed over in
+    typedef std::function<void(const char* data, size_t size, uint32_t sampleRate, uint32_t channelCount)> PlaybackObserver;
 
     IAudioOutput() = default;
     virtual ~IAudioOutput() = default;
@@ -40,9 +43,19 @@ public:
     virtual void start() = 0;
     virtual void stop() = 0;
     virtual void suspend() = 0;
+    virtual void flush() = 0;
+    virtual void setGain(float gain) = 0;
+    // must be set before start, it is read without synchronization on the playback thread
+    virtual void setPlaybackObserver(PlaybackObserver observer) = 0;
     virtual uint32_t getSampleSize() const = 0;
     virtual uint32_t getChannelCount() const = 0;
     virtual uint32_t getSampleRate() const = 0;
+    virtual bool isBackpressured() const = 0;
+    virtual size_t getBufferedBytes() const = 0;
+    virtual uint64_t getUnderrunCount() const = 0;
+    virtual uint64_t getLateCallbackCount() const = 0;
+    // correction applied for the phone's sample clock drifting from the device's, ppm
+    virtual double getClockDrift() const = 0;
 };
 
 }
@@ -23,6 +23,7 @@
 #include "aasdk_proto/VideoFPSEnum.pb.h"
 #include "aasdk_proto/VideoResolutionEnum.pb.h"
 #include "aasdk/Common/Data.hpp"
+#include "openauto/Projection/VideoLatencyTracker.hpp"
 
 namespace openauto
 {
@@ -45,6 +46,12 @@ public:
     virtual aasdk::proto::enums::VideoResolution::Enum getVideoResolution() const = 0;
     virtual size_t getScreenDPI() const = 0;
     virtual QRect getVideoMargins() const = 0;
+    virtual VideoLatencyTracker::Pointer getLatencyTracker() const = 0;
+    virtual bool isBackpressured() const = 0;
+    // microseconds of video accepted by write() that is still waiting in front of the decoder
+    virtual uint64_t getQueuedLatency() const = 0;
+    // an output wrapped by a queue leaves dropping to it, both stages would otherwise spend the whole budget
+    virtual void setFrameDropping(bool enabled) = 0;
 };
 
 }
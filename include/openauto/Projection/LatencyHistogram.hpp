@@ -0,0 +1,58 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+namespace openauto
+{
+namespace projection
+{
+
+struct LatencyPercentiles
+{
+    uint64_t count = 0;
+    uint64_t p50 = 0;
+    uint64_t p95 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+};
+
+class LatencyHistogram
+{
+public:
+    static constexpr size_t cWindowSize = 512;
+
+    LatencyHistogram();
+
+    void add(uint64_t value);
+    void reset();
+    LatencyPercentiles getPercentiles() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::array<uint64_t, cWindowSize> samples_;
+    size_t next_;
+    uint64_t count_;
+};
+
+}
+}
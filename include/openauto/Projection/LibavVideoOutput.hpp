@@ -0,0 +1,126 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_LIBAV
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QImage>
+#include <QWidget>
+#include <boost/noncopyable.hpp>
+#include "VideoOutput.hpp"
+#include "LatencyHistogram.hpp"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+namespace openauto
+{
+namespace projection
+{
+
+// Paints the most recent decoded frame, frames that arrive before the next paint replace it.
+class LibavVideoSurface: public QWidget
+{
+public:
+    LibavVideoSurface(VideoLatencyTracker::Pointer latencyTracker, QWidget* parent = nullptr);
+
+    void present(QImage& image, uint64_t pts);
+    QSize getFrameSize() const;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    VideoLatencyTracker::Pointer latencyTracker_;
+    mutable std::mutex mutex_;
+    QImage image_;
+    uint64_t pts_;
+    bool pending_;
+    QSize frameSize_;
+};
+
+class LibavVideoOutput: public QObject, public VideoOutput, boost::noncopyable
+{
+    Q_OBJECT
+
+public:
+    LibavVideoOutput(configuration::IConfiguration::Pointer configuration, QWidget* videoContainer = nullptr);
+    ~LibavVideoOutput();
+
+    bool open() override;
+    bool init() override;
+    void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void stop() override;
+    bool isBackpressured() const override;
+    LatencyPercentiles getDecodeTime() const;
+    void resize();
+
+signals:
+    void startPlayback();
+    void stopPlayback();
+
+protected slots:
+    void createVideoOutput();
+    void onStartPlayback();
+    void onStopPlayback();
+
+private:
+    struct Packet
+    {
+        uint64_t pts;
+        std::vector<uint8_t> data;
+    };
+
+    bool openDecoder();
+    void closeDecoder();
+    void run();
+    void decode(Packet& packet);
+    void present(const AVFrame* frame);
+
+    static constexpr size_t cMaxQueuedPackets = 4;
+
+    QWidget* videoContainer_;
+    std::unique_ptr<LibavVideoSurface> videoSurface_;
+    AVCodecContext* codecContext_;
+    AVPacket* packet_;
+    AVFrame* frame_;
+    SwsContext* swsContext_;
+    QImage image_;
+    LatencyHistogram decodeTime_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Packet> packets_;
+    bool running_;
+    uint64_t nextPts_;
+    std::thread thread_;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <boost/noncopyable.hpp>
+#include "IAudioOutput.hpp"
+#include "SequentialBuffer.hpp"
+#include "GainRamp.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+// Plays into nowhere, one period at a time at the sample rate of the stream. Periods match the
+// ones requested from RtAudio so buffering and underruns look like on a real DAC.
+class NullAudioOutput: public IAudioOutput, boost::noncopyable
+{
+public:
+    NullAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    ~NullAudioOutput();
+
+    bool open() override;
+    void write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void start() override;
+    void stop() override;
+    void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
+    void setPlaybackObserver(PlaybackObserver observer) override;
+    uint32_t getSampleSize() const override;
+    uint32_t getChannelCount() const override;
+    uint32_t getSampleRate() const override;
+    bool isBackpressured() const override;
+    size_t getBufferedBytes() const override;
+    uint64_t getUnderrunCount() const override;
+    uint64_t getLateCallbackCount() const override;
+    double getClockDrift() const override;
+
+protected:
+    virtual void onPeriod(const char* data, size_t size);
+    void doStop();
+
+private:
+    void run();
+
+    uint32_t channelCount_;
+    uint32_t sampleSize_;
+    uint32_t sampleRate_;
+    SequentialBuffer audioBuffer_;
+    size_t lastWriteSize_;
+    std::atomic<uint64_t> underruns_;
+    std::atomic<uint64_t> lateCallbacks_;
+    GainRamp gainRamp_;
+    PlaybackObserver playbackObserver_;
+    ClockDriftCompensator::Pointer driftCompensator_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool running_;
+    std::thread thread_;
+};
+
+}
+}
@@ -0,0 +1,64 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <boost/noncopyable.hpp>
+#include "VideoOutput.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+// Consumes the stream without decoding it. Frames leave the queue at the configured frame rate,
+// so acknowledgements, backpressure and latency statistics behave like with a real decoder.
+class NullVideoOutput: public VideoOutput, boost::noncopyable
+{
+public:
+    NullVideoOutput(configuration::IConfiguration::Pointer configuration);
+    ~NullVideoOutput();
+
+    bool open() override;
+    bool init() override;
+    void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void stop() override;
+    bool isBackpressured() const override;
+    uint64_t getDecodedFrames() const;
+
+private:
+    void run();
+
+    static constexpr size_t cMaxQueuedFrames = 4;
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<uint64_t> queue_;
+    bool running_;
+    uint64_t nextPts_;
+    std::atomic<uint64_t> decodedFrames_;
+    std::thread thread_;
+};
+
+}
+}
@@ -18,30 +18,43 @@
 
 #pragma once
 
+#include <chrono>
 #include <mutex>
+#include <vector>
 #include <QAudioInput>
 #include <QAudioFormat>
 #include "IAudioInput.hpp"
+#include "AudioResampler.hpp"
+#include "AudioInputProcessor.hpp"
+#include "RingBuffer.hpp"
 
 namespace openauto
 {
 namespace projection
 {
 
+// Drains the device on every readyRead into a ring, whether a read is pending or not, and hands
+// out fixed frame aligned chunks from a small pool, each stamped with the time it was captured.
+// When nobody reads the ring drops the oldest frames, those are counted as overruns.
 class QtAudioInput: public QObject, public IAudioInput
 {
     Q_OBJECT
 public:
-    QtAudioInput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate);
+    // the processor is optional and only handles mono
+    QtAudioInput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, AudioInputProcessor::Pointer processor = nullptr);
 
     bool open() override;
     bool isActive() const override;
     void read(ReadPromise::Pointer promise) override;
+    void release(aasdk::common::Data data) override;
     void start(StartPromise::Pointer promise) override;
     void stop() override;
+    void setSignalProcessing(bool echoCancellation, bool noiseSuppression) override;
     uint32_t getSampleSize() const override;
     uint32_t getChannelCount() const override;
     uint32_t getSampleRate() const override;
+    uint64_t getOverrunCount() const override;
+    uint64_t getDroppedFrameCount() const override;
 
 signals:
     void startRecording(StartPromise::Pointer promise);
@@ -54,13 +67,35 @@ private slots:
     void onReadyRead();
 
 private:
+    void drainDevice();
+    void deliverChunk();
+    aasdk::common::Data acquireChunk();
+    size_t getFrameSize() const;
+
     QAudioFormat audioFormat_;
+    // the format the device records in, converted to audioFormat_ when it differs
+    QAudioFormat deviceFormat_;
     QIODevice* ioDevice_;
     std::unique_ptr<QAudioInput> audioInput_;
     ReadPromise::Pointer readPromise_;
     mutable std::mutex mutex_;
+    std::unique_ptr<AudioResampler> resampler_;
+    std::vector<int16_t> deviceSamples_;
+    std::vector<int16_t> convertedSamples_;
+    AudioInputProcessor::Pointer processor_;
+    RingBuffer ring_;
+    std::vector<aasdk::common::Data> chunkPool_;
+    size_t chunkSize_;
+    // frames ever written to the ring and the time the newest of them was captured
+    uint64_t capturedFrames_;
+    std::chrono::high_resolution_clock::time_point captureTime_;
+    uint64_t chunks_;
+    uint64_t poolMisses_;
 
-    static constexpr size_t cSampleSize = 2056;
+    static constexpr size_t cChunkSize = 2048;
+    static constexpr size_t cChunkPoolSize = 4;
+    static constexpr size_t cRingSize = 32768;
+    static constexpr size_t cDeviceReadFrames = 1024;
 };
 
 }
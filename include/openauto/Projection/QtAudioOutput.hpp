@@ -18,10 +18,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <vector>
 #include <QAudioOutput>
 #include <QAudioFormat>
 #include "IAudioOutput.hpp"
 #include "SequentialBuffer.hpp"
+#include "AudioResampler.hpp"
 
 namespace openauto
 {
@@ -39,26 +42,46 @@ public:
     void start() override;
     void stop() override;
     void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
+    void setPlaybackObserver(PlaybackObserver observer) override;
     uint32_t getSampleSize() const override;
     uint32_t getChannelCount() const override;
     uint32_t getSampleRate() const override;
+    bool isBackpressured() const override;
+    size_t getBufferedBytes() const override;
+    uint64_t getUnderrunCount() const override;
+    uint64_t getLateCallbackCount() const override;
+    double getClockDrift() const override;
 
 signals:
     void startPlayback();
     void suspendPlayback();
     void stopPlayback();
+    void changeVolume(qreal volume);
 
 protected slots:
     void createAudioOutput();
     void onStartPlayback();
     void onSuspendPlayback();
     void onStopPlayback();
+    void onChangeVolume(qreal volume);
+    void onStateChanged(QAudio::State state);
 
 private:
     QAudioFormat audioFormat_;
+    // same channel count and sample size as the stream, at the rate the device prefers
+    QAudioFormat deviceFormat_;
     SequentialBuffer audioBuffer_;
+    size_t lastWriteSize_;
     std::unique_ptr<QAudioOutput> audioOutput_;
     bool playbackStarted_;
+    std::atomic<uint64_t> underruns_;
+    std::unique_ptr<AudioResampler> resampler_;
+    std::vector<int16_t> resampled_;
+    ClockDriftCompensator::Pointer driftCompensator_;
+
+    static constexpr size_t cResamplerChunkFrames = 2048;
 };
 
 }
@@ -0,0 +1,86 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <boost/noncopyable.hpp>
+#include "IVideoOutput.hpp"
+#include "VideoFrameQueue.hpp"
+#include "FrameDropPolicy.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+// Puts a bounded frame queue and a submission thread in front of another output, so a decoder
+// that stalls no longer stalls reception and acknowledgement of the video channel. Frames are
+// dropped by the FrameDropPolicy once the queue and the wrapped output together hold more than
+// the budget or the queue is full. The wrapped output's own dropping is switched off.
+// All methods but the submission thread belong to the video service's strand.
+class QueuedVideoOutput: public IVideoOutput, boost::noncopyable
+{
+public:
+    QueuedVideoOutput(IVideoOutput::Pointer output, uint64_t latencyBudget);
+    ~QueuedVideoOutput();
+
+    bool open() override;
+    bool init() override;
+    void write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer) override;
+    void stop() override;
+    aasdk::proto::enums::VideoFPS::Enum getVideoFPS() const override;
+    aasdk::proto::enums::VideoResolution::Enum getVideoResolution() const override;
+    size_t getScreenDPI() const override;
+    QRect getVideoMargins() const override;
+    VideoLatencyTracker::Pointer getLatencyTracker() const override;
+    bool isBackpressured() const override;
+    uint64_t getQueuedLatency() const override;
+    void setFrameDropping(bool enabled) override;
+
+private:
+    void run();
+    VideoFrame* waitForSlot();
+    void stopSubmission();
+
+    static constexpr size_t cQueueCapacity = 32;
+    static constexpr std::chrono::milliseconds cMaxSlotWait{100};
+    static constexpr std::chrono::milliseconds cSlotPollInterval{1};
+    static constexpr std::chrono::milliseconds cIdleTimeout{10};
+
+    IVideoOutput::Pointer output_;
+    uint64_t latencyBudget_;
+    VideoFrameQueue queue_;
+    FrameDropPolicy dropPolicy_;
+    uint64_t queuedFrames_;
+    uint64_t overflows_;
+    size_t maxDepth_;
+    std::atomic<bool> running_;
+    std::atomic<bool> waiting_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::thread thread_;
+};
+
+}
+}
@@ -0,0 +1,88 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace openauto
+{
+namespace projection
+{
+
+enum class RingBufferOverflowPolicy
+{
+    // unread bytes are discarded to make room, the reader always gets the newest data
+    DROP_OLDEST,
+    // the part of a write that does not fit is discarded
+    DROP_NEWEST,
+    // the writer waits for the reader, for at most cBlockTimeout, then drops the newest bytes
+    BLOCK
+};
+
+struct RingBufferStatistics
+{
+    size_t capacity = 0;
+    size_t fillLevel = 0;
+    uint64_t overflows = 0;
+    uint64_t overflowBytes = 0;
+    uint64_t underflows = 0;
+};
+
+// Byte ring for exactly one writer and one reader thread, neither side takes a lock.
+// With an alignment, e.g. the PCM frame size, DROP_OLDEST only discards whole units; it has to be
+// a power of two and the writes a multiple of it.
+class RingBuffer: boost::noncopyable
+{
+public:
+    RingBuffer(size_t capacity, RingBufferOverflowPolicy policy, size_t alignment = 1);
+
+    size_t write(const char* data, size_t size);
+    size_t read(char* data, size_t size);
+    void clear();
+
+    size_t getCapacity() const;
+    size_t getFillLevel() const;
+    size_t getFreeSpace() const;
+    RingBufferOverflowPolicy getPolicy() const;
+    RingBufferStatistics getStatistics() const;
+
+private:
+    size_t waitForSpace(size_t head, size_t size) const;
+    size_t discardOldest(size_t head, size_t size);
+    void copyIn(size_t position, const char* data, size_t size);
+    void copyOut(size_t position, char* data, size_t size) const;
+
+    std::vector<char> data_;
+    size_t mask_;
+    size_t alignment_;
+    RingBufferOverflowPolicy policy_;
+    // positions only grow, the difference is the fill level
+    std::atomic<size_t> head_;
+    std::atomic<size_t> tail_;
+    std::atomic<uint64_t> overflows_;
+    std::atomic<uint64_t> overflowBytes_;
+    std::atomic<uint64_t> underflows_;
+};
+
+}
+}
@@ -18,9 +18,16 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
 #include <RtAudio.h>
 #include "IAudioOutput.hpp"
-#include "SequentialBuffer.hpp"
+#include "RingBuffer.hpp"
+#include "GainRamp.hpp"
+#include "AudioResampler.hpp"
+#include "ClockDriftCompensator.hpp"
 
 namespace openauto
 {
@@ -36,20 +43,46 @@ public:
     void start() override;
     void stop() override;
     void suspend() override;
+    void flush() override;
+    void setGain(float gain) override;
+    void setPlaybackObserver(PlaybackObserver observer) override;
     uint32_t getSampleSize() const override;
     uint32_t getChannelCount() const override;
     uint32_t getSampleRate() const override;
+    bool isBackpressured() const override;
+    size_t getBufferedBytes() const override;
+    uint64_t getUnderrunCount() const override;
+    uint64_t getLateCallbackCount() const override;
+    double getClockDrift() const override;
 
 private:
     void doSuspend();
+    void fill(int16_t* samples, size_t frameCount);
+    void notifyPlayback(const int16_t* samples, size_t frameCount);
     static int audioBufferReadHandler(void* outputBuffer, void* inputBuffer, unsigned int nBufferFrames,
                                       double streamTime, RtAudioStreamStatus status, void* userData);
 
+    static constexpr size_t cFadeFrames = 64;
+    static constexpr size_t cMaxChannelCount = 8;
+
     uint32_t channelCount_;
     uint32_t sampleSize_;
     uint32_t sampleRate_;
-    SequentialBuffer audioBuffer_;
+    RingBuffer audioBuffer_;
+    size_t lastWriteSize_;
+    std::atomic<uint64_t> underruns_;
+    std::atomic<uint64_t> lateCallbacks_;
+    // owned by the callback thread
+    bool concealing_;
+    std::array<int16_t, cMaxChannelCount> lastFrame_;
+    GainRamp gainRamp_;
+    PlaybackObserver playbackObserver_;
+    ClockDriftCompensator driftCompensator_;
+    // set when the device runs at another rate or channel count than the stream
+    std::unique_ptr<AudioResampler> resampler_;
+    std::vector<int16_t> staging_;
     std::unique_ptr<RtAudio> dac_;
+    // serializes open, start and stop, the callback never takes it
     std::mutex mutex_;
 };
 
@@ -18,10 +18,11 @@
 
 #pragma once
 
+#include <functional>
 #include <QIODevice>
-#include <mutex>
-#include <boost/circular_buffer.hpp>
 #include "aasdk/Common/Data.hpp"
+#include "RingBuffer.hpp"
+#include "ClockDriftCompensator.hpp"
 
 namespace openauto
 {
@@ -31,7 +32,7 @@ namespace projection
 class SequentialBuffer: public QIODevice
 {
 public:
-    SequentialBuffer();
+    SequentialBuffer(size_t capacity = aasdk::common::cStaticDataSize, RingBufferOverflowPolicy policy = RingBufferOverflowPolicy::DROP_OLDEST, size_t alignment = 1);
     bool isSequential() const override;
     qint64 size() const override;
     qint64 pos() const override;
@@ -40,6 +41,11 @@ public:
     bool reset() override;
     bool canReadLine() const override;
     qint64 bytesAvailable() const override;
+    qint64 bytesFree() const;
+    RingBufferStatistics getStatistics() const;
+    void setReadObserver(std::function<void(const char* data, size_t size)> observer);
+    // reads go through the compensator, the data has to be 16 bit frames then
+    void setDriftCompensator(ClockDriftCompensator::Pointer compensator);
     bool open(OpenMode mode) override;
 
 protected:
@@ -47,8 +53,9 @@ protected:
     qint64 writeData(const char *data, qint64 len) override;
 
 private:
-    boost::circular_buffer<aasdk::common::Data::value_type> data_;
-    mutable std::mutex mutex_;
+    RingBuffer data_;
+    std::function<void(const char* data, size_t size)> readObserver_;
+    ClockDriftCompensator::Pointer driftCompensator_;
 };
 
 }
@@ -0,0 +1,50 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace openauto
+{
+namespace projection
+{
+
+// SSE or NEON kernels for the audio filters and the mix, with a scalar fallback. The compiler does not
+// vectorize float reductions by itself without -ffast-math, and on armhf no float loop at all without
+// -funsafe-math-optimizations. Conversions to int16_t clamp and truncate like a static_cast of a clamped value.
+class VectorMath
+{
+public:
+    static float dot(const float* first, const float* second, size_t count);
+    // accumulator[i] += factor * values[i]
+    static void multiplyAdd(float* accumulator, const float* values, float factor, size_t count);
+    // values[i] *= factor
+    static void scale(float* values, float factor, size_t count);
+    static void scale(int16_t* values, float factor, size_t count);
+    // output[i] = input[i] * factor
+    static void convert(int16_t* output, const float* input, float factor, size_t count);
+    static void convert(float* output, const int16_t* input, float factor, size_t count);
+    // interleaved frame n is multiplied by start + step * (n + 1)
+    static void ramp(float* values, float start, float step, size_t frameCount, uint32_t channelCount);
+    static void ramp(int16_t* values, float start, float step, size_t frameCount, uint32_t channelCount);
+};
+
+}
+}
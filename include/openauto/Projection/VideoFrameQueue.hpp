@@ -0,0 +1,72 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace openauto
+{
+namespace projection
+{
+
+struct VideoFrame
+{
+    uint64_t timestamp = 0;
+    std::chrono::steady_clock::time_point received;
+    std::vector<uint8_t> data;
+};
+
+// Bounded queue of video frames for exactly one producer and one consumer thread, neither side
+// takes a lock. Slots are reused, a slot's buffer only grows to the largest frame it carried.
+class VideoFrameQueue: boost::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    VideoFrameQueue(size_t capacity);
+
+    // producer: the slot to fill next, nullptr while the queue is full
+    VideoFrame* acquire();
+    void push();
+    // producer: how long the oldest queued frame has been waiting
+    std::chrono::microseconds getOldestAge(Clock::time_point now) const;
+
+    // consumer: the oldest frame, nullptr while the queue is empty
+    VideoFrame* front();
+    void pop();
+    void clear();
+
+    size_t size() const;
+    size_t getCapacity() const;
+
+private:
+    std::vector<VideoFrame> slots_;
+    // positions only grow, the difference is the number of queued frames
+    std::atomic<size_t> head_;
+    std::atomic<size_t> tail_;
+};
+
+}
+}
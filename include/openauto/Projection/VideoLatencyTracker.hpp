@@ -0,0 +1,96 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include "LatencyHistogram.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+enum class VideoLatencyStage
+{
+    RECEIVE_TO_PUSH,
+    PUSH_TO_DECODE,
+    DECODE_TO_RENDER,
+    RECEIVE_TO_RENDER,
+    COUNT
+};
+
+struct VideoLatencyReport
+{
+    std::array<LatencyPercentiles, static_cast<size_t>(VideoLatencyStage::COUNT)> stages;
+    uint64_t pipelineMinLatency = 0;
+    uint64_t pipelineMaxLatency = 0;
+};
+
+class VideoLatencyTracker
+{
+public:
+    typedef std::shared_ptr<VideoLatencyTracker> Pointer;
+    typedef std::chrono::steady_clock Clock;
+
+    VideoLatencyTracker();
+
+    void onReceived();
+    void onPushed(uint64_t pts);
+    void onDropped();
+    void onDecoded(uint64_t pts);
+    void onRendered(uint64_t pts);
+    void setPipelineLatency(uint64_t minLatency, uint64_t maxLatency);
+
+    VideoLatencyReport getReport() const;
+    void dump() const;
+    void reset();
+
+    static const char* stageName(VideoLatencyStage stage);
+
+private:
+    struct Frame
+    {
+        uint64_t pts = 0;
+        Clock::time_point received;
+        Clock::time_point pushed;
+        Clock::time_point decoded;
+        bool valid = false;
+    };
+
+    Frame* findFrame(uint64_t pts);
+    void addSample(VideoLatencyStage stage, Clock::time_point from, Clock::time_point to);
+
+    static constexpr size_t cMaxFramesInFlight = 64;
+
+    mutable std::mutex mutex_;
+    std::array<Clock::time_point, cMaxFramesInFlight> received_;
+    size_t receivedHead_;
+    size_t receivedCount_;
+    std::array<Frame, cMaxFramesInFlight> frames_;
+    size_t nextFrame_;
+    std::array<LatencyHistogram, static_cast<size_t>(VideoLatencyStage::COUNT)> histograms_;
+    uint64_t pipelineMinLatency_;
+    uint64_t pipelineMaxLatency_;
+};
+
+}
+}
@@ -35,9 +35,14 @@ public:
     aasdk::proto::enums::VideoResolution::Enum getVideoResolution() const override;
     size_t getScreenDPI() const override;
     QRect getVideoMargins() const override;
+    VideoLatencyTracker::Pointer getLatencyTracker() const override;
+    bool isBackpressured() const override;
+    uint64_t getQueuedLatency() const override;
+    void setFrameDropping(bool enabled) override;
 
 protected:
     configuration::IConfiguration::Pointer configuration_;
+    VideoLatencyTracker::Pointer latencyTracker_;
 };
 
 }
@@ -26,6 +26,7 @@
 #include "openauto/Configuration/IConfiguration.hpp"
 #include "IAndroidAutoEntity.hpp"
 #include "IService.hpp"
+#include "AudioFocusController.hpp"
 #include "IPinger.hpp"
 
 namespace openauto
@@ -42,6 +43,7 @@ public:
                       aasdk::messenger::IMessenger::Pointer messenger,
                       configuration::IConfiguration::Pointer configuration,
                       ServiceList serviceList,
+                      AudioFocusController::Pointer audioFocusController,
                       IPinger::Pointer pinger);
     ~AndroidAutoEntity() override;
 
@@ -72,6 +74,7 @@ private:
     aasdk::channel::control::IControlServiceChannel::Pointer controlServiceChannel_;
     configuration::IConfiguration::Pointer configuration_;
     ServiceList serviceList_;
+    AudioFocusController::Pointer audioFocusController_;
     IPinger::Pointer pinger_;
     IAndroidAutoEntityEventHandler* eventHandler_;
 };
@@ -0,0 +1,61 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <set>
+#include "aasdk/Messenger/ChannelId.hpp"
+#include "aasdk_proto/AudioFocusTypeEnum.pb.h"
+#include "aasdk_proto/AudioFocusStateEnum.pb.h"
+#include "openauto/Projection/IAudioOutput.hpp"
+
+namespace openauto
+{
+namespace service
+{
+
+// Tracks the focus the phone holds and which audio channels are playing, and ducks
+// the media output while speech or system audio is in the foreground.
+class AudioFocusController
+{
+public:
+    typedef std::shared_ptr<AudioFocusController> Pointer;
+
+    AudioFocusController(float duckingGain);
+
+    void registerOutput(aasdk::messenger::ChannelId channelId, projection::IAudioOutput::Pointer audioOutput);
+    aasdk::proto::enums::AudioFocusState::Enum onFocusRequest(aasdk::proto::enums::AudioFocusType::Enum focusType);
+    void onChannelStarted(aasdk::messenger::ChannelId channelId);
+    void onChannelStopped(aasdk::messenger::ChannelId channelId);
+    bool isDucked() const;
+
+private:
+    void update();
+
+    float duckingGain_;
+    mutable std::mutex mutex_;
+    aasdk::proto::enums::AudioFocusType::Enum focusType_;
+    std::set<aasdk::messenger::ChannelId> activeChannels_;
+    std::map<aasdk::messenger::ChannelId, std::weak_ptr<projection::IAudioOutput>> outputs_;
+    bool ducked_;
+};
+
+}
+}
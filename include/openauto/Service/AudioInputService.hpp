@@ -46,7 +46,7 @@ public:
 private:
     using std::enable_shared_from_this<AudioInputService>::shared_from_this;
     void onAudioInputOpenSucceed();
-    void onAudioInputDataReady(aasdk::common::Data data);
+    void onAudioInputDataReady(projection::AudioInputChunk chunk);
     void readAudioInput();
 
     boost::asio::io_service::strand strand_;
@@ -0,0 +1,87 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace openauto
+{
+namespace service
+{
+
+struct AudioJitterDecision
+{
+    bool drop = false;
+    size_t silenceBytes = 0;
+    size_t skipBytes = 0;
+};
+
+struct AudioJitterStatistics
+{
+    uint64_t packets = 0;
+    uint64_t latePackets = 0;
+    uint64_t missingPackets = 0;
+    uint64_t discontinuities = 0;
+    uint64_t insertedBytes = 0;
+    uint64_t skippedBytes = 0;
+    uint64_t depth = 0;
+    uint64_t target = 0;
+    uint64_t jitter = 0;
+};
+
+// Keeps the audio queued in the output around a target latency. The target follows the arrival
+// jitter of the media timestamps (microseconds) and is raised whenever the output underruns.
+// The buffer only decides, the caller writes the silence and skips the bytes.
+class AudioJitterBuffer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr std::chrono::microseconds cMinTarget{20000};
+    static constexpr std::chrono::microseconds cMaxTarget{200000};
+
+    AudioJitterBuffer();
+
+    void setFormat(uint32_t sampleRate, uint32_t frameSize);
+    AudioJitterDecision onPacket(uint64_t timestamp, size_t size, size_t bufferedBytes, uint64_t underruns);
+    void reset();
+    AudioJitterStatistics getStatistics() const;
+
+private:
+    uint64_t toDuration(size_t bytes) const;
+    size_t toBytes(uint64_t duration) const;
+    void updateJitter(uint64_t timestamp, Clock::time_point arrival);
+    void updateTarget(uint64_t packetDuration, uint64_t underruns);
+
+    uint32_t sampleRate_;
+    uint32_t frameSize_;
+    bool synchronized_;
+    uint64_t nextTimestamp_;
+    int64_t lastTransit_;
+    double jitter_;
+    uint64_t underrunFloor_;
+    uint64_t lastUnderruns_;
+    Clock::time_point lastUnderrunTime_;
+    AudioJitterStatistics statistics_;
+};
+
+}
+}
@@ -21,6 +21,10 @@
 #include "aasdk/Channel/AV/IAudioServiceChannel.hpp"
 #include "aasdk/Channel/AV/IAudioServiceChannelEventHandler.hpp"
 #include "openauto/Projection/IAudioOutput.hpp"
+#include "openauto/Capture/CaptureWriter.hpp"
+#include "MediaAckWindow.hpp"
+#include "AudioJitterBuffer.hpp"
+#include "AudioFocusController.hpp"
 #include "IService.hpp"
 
 namespace openauto
@@ -33,7 +37,7 @@ class AudioService: public aasdk::channel::av::IAudioServiceChannelEventHandler,
 public:
     typedef std::shared_ptr<AudioService> Pointer;
 
-    AudioService(boost::asio::io_service& ioService, aasdk::channel::av::IAudioServiceChannel::Pointer channel, projection::IAudioOutput::Pointer audioOutput);
+    AudioService(boost::asio::io_service& ioService, aasdk::channel::av::IAudioServiceChannel::Pointer channel, projection::IAudioOutput::Pointer audioOutput, uint32_t maxUnacked, capture::CaptureWriter::Pointer captureWriter, AudioFocusController::Pointer audioFocusController);
 
     void start() override;
     void stop() override;
@@ -49,10 +53,23 @@ public:
 protected:
     using std::enable_shared_from_this<AudioService>::shared_from_this;
 
+    void sendAVMediaAckIndication();
+    void onAckTimerExceeded(const boost::system::error_code& error);
+    void dumpAckStatistics() const;
+    void dumpJitterStatistics() const;
+    void writeAudio(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer);
+
     boost::asio::io_service::strand strand_;
     aasdk::channel::av::IAudioServiceChannel::Pointer channel_;
     projection::IAudioOutput::Pointer audioOutput_;
     int32_t session_;
+    MediaAckWindow ackWindow_;
+    boost::asio::deadline_timer ackTimer_;
+    bool ackTimerPending_;
+    capture::CaptureWriter::Pointer captureWriter_;
+    AudioFocusController::Pointer audioFocusController_;
+    AudioJitterBuffer jitterBuffer_;
+    aasdk::common::Data silence_;
 };
 
 }
@@ -20,6 +20,7 @@
 
 #include "aasdk/Messenger/IMessenger.hpp"
 #include "IService.hpp"
+#include "AudioFocusController.hpp"
 
 namespace openauto
 {
@@ -32,6 +33,7 @@ public:
     virtual ~IServiceFactory() = default;
 
     virtual ServiceList create(aasdk::messenger::IMessenger::Pointer messenger) = 0;
+    virtual AudioFocusController::Pointer getAudioFocusController() = 0;
 };
 
 }
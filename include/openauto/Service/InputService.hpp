@@ -51,10 +51,13 @@ public:
 
 private:
     using std::enable_shared_from_this<InputService>::shared_from_this;
+    void sendInputEventIndication(const aasdk::proto::messages::InputEventIndication& indication);
 
     boost::asio::io_service::strand strand_;
     aasdk::channel::input::InputServiceChannel::Pointer channel_;
     projection::IInputDevice::Pointer inputDevice_;
+    // reused for button and mouse events, Clear() keeps the nested messages allocated
+    aasdk::proto::messages::InputEventIndication inputEventIndication_;
     bool serviceActive = false;
 };
 
@@ -0,0 +1,65 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace openauto
+{
+namespace service
+{
+
+struct MediaAckStatistics
+{
+    uint64_t receivedMessages = 0;
+    uint64_t sentAcks = 0;
+    uint64_t heldAcks = 0;
+    uint64_t forcedAcks = 0;
+    uint64_t windowFull = 0;
+};
+
+class MediaAckWindow
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr uint32_t cMaxWindowSize = 32;
+    static constexpr std::chrono::milliseconds cMaxHoldTime{200};
+    static constexpr uint32_t cRetryInterval = 5;
+
+    MediaAckWindow(uint32_t maxUnacked);
+
+    uint32_t getMaxUnacked() const;
+    void onReceived();
+    uint32_t acknowledge(bool backpressured);
+    bool hasPending() const;
+    void reset();
+    MediaAckStatistics getStatistics() const;
+
+private:
+    uint32_t maxUnacked_;
+    uint32_t pending_;
+    bool holding_;
+    Clock::time_point holdStart_;
+    MediaAckStatistics statistics_;
+};
+
+}
+}
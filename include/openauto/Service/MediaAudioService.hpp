@@ -29,7 +29,7 @@ namespace service
 class MediaAudioService: public AudioService
 {
 public:
-    MediaAudioService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioOutput::Pointer audioOutput);
+    MediaAudioService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioOutput::Pointer audioOutput, uint32_t maxUnacked, capture::CaptureWriter::Pointer captureWriter, AudioFocusController::Pointer audioFocusController);
 };
 
 }
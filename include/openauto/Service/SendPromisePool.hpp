@@ -0,0 +1,130 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+#include "aasdk/Channel/Promise.hpp"
+
+namespace openauto
+{
+namespace service
+{
+
+struct BlockPoolStatistics
+{
+    uint64_t allocations = 0;
+    uint64_t heapAllocations = 0;
+    size_t cachedBlocks = 0;
+};
+
+// Keeps released blocks of one size on a free list instead of returning them to the heap. Requests
+// larger than the block size are passed to the heap. The list only grows to the peak number of
+// blocks in use at once.
+class BlockPool: boost::noncopyable
+{
+public:
+    BlockPool(size_t blockSize);
+    ~BlockPool();
+
+    void* allocate(size_t size);
+    void deallocate(void* block, size_t size);
+    size_t getBlockSize() const;
+    BlockPoolStatistics getStatistics() const;
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    size_t blockSize_;
+    mutable std::mutex mutex_;
+    FreeBlock* freeList_;
+    BlockPoolStatistics statistics_;
+};
+
+template<typename T>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit PoolAllocator(BlockPool& pool)
+        : pool_(&pool)
+    {
+    }
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other)
+        : pool_(other.getPool())
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(pool_->allocate(sizeof(T) * count));
+    }
+
+    void deallocate(T* pointer, size_t count)
+    {
+        pool_->deallocate(pointer, sizeof(T) * count);
+    }
+
+    BlockPool* getPool() const
+    {
+        return pool_;
+    }
+
+private:
+    BlockPool* pool_;
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs)
+{
+    return lhs.getPool() == rhs.getPool();
+}
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+// Send promises for the per message paths (media acks, input events). The promise and its shared_ptr
+// control block come from one pooled block, so with handlers small enough for std::function's local
+// storage creating and releasing a promise does not touch the heap.
+class SendPromisePool
+{
+public:
+    static constexpr size_t cBlockSize = 256;
+
+    static aasdk::channel::SendPromise::Pointer defer(boost::asio::io_service::strand& strand);
+    static BlockPoolStatistics getStatistics();
+
+private:
+    static BlockPool& getPool();
+};
+
+}
+}
@@ -0,0 +1,90 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace openauto
+{
+namespace service
+{
+
+struct ServiceExecutorStatistics
+{
+    uint64_t handlers = 0;
+    uint64_t probes = 0;
+    uint64_t totalDepth = 0;
+    uint64_t maxDepth = 0;
+    std::chrono::microseconds totalDelay{0};
+    std::chrono::microseconds maxDelay{0};
+};
+
+// Runs one class of services on its own io_service and threads, so a handler that blocks in one
+// class, e.g. a video write, only delays that class. A service keeps at most one received message
+// per channel queued here, the rest waits in the messenger, bounded by the phone's ack window.
+// A probe posted every cProbeInterval records how many handlers and how much time were ahead of it.
+class ServiceExecutor: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<ServiceExecutor> Pointer;
+    typedef std::chrono::steady_clock Clock;
+
+    ServiceExecutor(std::string name, size_t threadCount);
+    ~ServiceExecutor();
+
+    boost::asio::io_service& getIOService();
+    const std::string& getName() const;
+    ServiceExecutorStatistics getStatistics() const;
+
+private:
+    void run();
+    void scheduleProbe();
+    void onProbeTimer(const boost::system::error_code& error);
+    void onProbe(Clock::time_point postTime, uint64_t postHandlers);
+    void dumpStatistics(Clock::time_point now);
+
+    static constexpr std::chrono::milliseconds cProbeInterval{100};
+    static constexpr std::chrono::seconds cStatisticsInterval{60};
+
+    std::string name_;
+    boost::asio::io_service ioService_;
+    std::unique_ptr<boost::asio::io_service::work> work_;
+    // owned by the probe, which never runs twice at the same time
+    boost::asio::deadline_timer probeTimer_;
+    std::atomic<uint64_t> handlers_;
+    mutable std::mutex mutex_;
+    ServiceExecutorStatistics statistics_;
+    // since the last dump, only touched by the probe
+    ServiceExecutorStatistics interval_;
+    uint64_t lastDumpHandlers_;
+    Clock::time_point lastDumpTime_;
+    std::vector<std::thread> threads_;
+};
+
+}
+}
@@ -21,13 +21,20 @@
 #include "openauto/Service/IServiceFactory.hpp"
 #include "openauto/Configuration/IConfiguration.hpp"
 #include "openauto/Projection/InputDevice.hpp"
+#include "openauto/Projection/IAudioOutput.hpp"
+#include "openauto/Projection/AudioMixer.hpp"
+#include "openauto/Projection/EchoReference.hpp"
+#include "openauto/Projection/AlsaAudioOutput.hpp"
+#include "openauto/Capture/CaptureWriter.hpp"
 #include "openauto/Projection/OMXVideoOutput.hpp"
 #include "openauto/Projection/GSTVideoOutput.hpp"
 #include "openauto/Projection/QtVideoOutput.hpp"
+#include "openauto/Projection/LibavVideoOutput.hpp"
 #include "openauto/Service/MediaStatusService.hpp"
 #include "openauto/Service/NavigationStatusService.hpp"
 #include "openauto/Service/SensorService.hpp"
 #include "openauto/Service/InputService.hpp"
+#include "openauto/Service/ServiceExecutor.hpp"
 #include "btservice/btservice.hpp"
 
 namespace openauto
@@ -40,6 +47,7 @@ class ServiceFactory : public IServiceFactory
 public:
     ServiceFactory(boost::asio::io_service& ioService, configuration::IConfiguration::Pointer configuration, QWidget* activeArea=nullptr, std::function<void(bool)> activeCallback=nullptr, bool nightMode=false);
     ServiceList create(aasdk::messenger::IMessenger::Pointer messenger) override;
+    AudioFocusController::Pointer getAudioFocusController() override;
     void setOpacity(unsigned int alpha);
     void resize();
     void setNightMode(bool nightMode);
@@ -52,12 +60,16 @@ public:
 #endif
 
 private:
-    IService::Pointer createVideoService(aasdk::messenger::IMessenger::Pointer messenger);
+    IService::Pointer createVideoService(aasdk::messenger::IMessenger::Pointer messenger, capture::CaptureWriter::Pointer captureWriter);
+    projection::IVideoOutput::Pointer queueVideoOutput(projection::IVideoOutput::Pointer videoOutput);
     IService::Pointer createBluetoothService(aasdk::messenger::IMessenger::Pointer messenger);
     std::shared_ptr<NavigationStatusService> createNavigationStatusService(aasdk::messenger::IMessenger::Pointer messenger);
     std::shared_ptr<MediaStatusService> createMediaStatusService(aasdk::messenger::IMessenger::Pointer messenger);
     std::shared_ptr<InputService> createInputService(aasdk::messenger::IMessenger::Pointer messenger);
-    void createAudioServices(ServiceList& serviceList, aasdk::messenger::IMessenger::Pointer messenger);
+    void createAudioServices(ServiceList& serviceList, aasdk::messenger::IMessenger::Pointer messenger, capture::CaptureWriter::Pointer captureWriter);
+    projection::IAudioOutput::Pointer createAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, const std::string& name);
+    projection::AudioMixer::Pointer getAudioMixer();
+    capture::CaptureWriter::Pointer createCaptureWriter();
 
     boost::asio::io_service& ioService_;
     configuration::IConfiguration::Pointer configuration_;
@@ -72,6 +84,12 @@ private:
 #else
     projection::QtVideoOutput *qtVideoOutput_;
 #endif
+#ifdef USE_LIBAV
+    std::weak_ptr<projection::LibavVideoOutput> libavVideoOutput_;
+#endif
+    std::weak_ptr<projection::AudioMixer> audioMixer_;
+    AudioFocusController::Pointer audioFocusController_;
+    projection::EchoReference::Pointer echoReference_;
     btservice::btservice btservice_;
     bool nightMode_;
     std::weak_ptr<SensorService> sensorService_;
@@ -79,6 +97,11 @@ private:
     std::weak_ptr<MediaStatusService> mediaStatusService_;
     std::weak_ptr<NavigationStatusService> navStatusService_;
     IAndroidAutoInterface* aa_interface_ = nullptr;
+    // each class of services on its own threads, transport and messenger stay on ioService_
+    ServiceExecutor::Pointer videoExecutor_;
+    ServiceExecutor::Pointer audioExecutor_;
+    ServiceExecutor::Pointer inputExecutor_;
+    ServiceExecutor::Pointer controlExecutor_;
 };
 
 }
@@ -29,7 +29,7 @@ namespace service
 class SystemAudioService: public AudioService
 {
 public:
-    SystemAudioService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioOutput::Pointer audioOutput);
+    SystemAudioService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IAudioOutput::Pointer audioOutput, uint32_t maxUnacked, capture::CaptureWriter::Pointer captureWriter, AudioFocusController::Pointer audioFocusController);
 };
 
 }
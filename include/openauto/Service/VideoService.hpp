@@ -22,6 +22,8 @@
 #include "aasdk/Channel/AV/VideoServiceChannel.hpp"
 #include "aasdk/Channel/AV/IVideoServiceChannelEventHandler.hpp"
 #include "openauto/Projection/IVideoOutput.hpp"
+#include "openauto/Capture/CaptureWriter.hpp"
+#include "MediaAckWindow.hpp"
 #include "IService.hpp"
 
 namespace openauto
@@ -34,7 +36,7 @@ class VideoService: public aasdk::channel::av::IVideoServiceChannelEventHandler,
 public:
     typedef std::shared_ptr<VideoService> Pointer;
 
-    VideoService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IVideoOutput::Pointer videoOutput);
+    VideoService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IVideoOutput::Pointer videoOutput, uint32_t maxUnacked, capture::CaptureWriter::Pointer captureWriter);
 
     void start() override;
     void stop() override;
@@ -51,11 +53,18 @@ public:
 private:
     using std::enable_shared_from_this<VideoService>::shared_from_this;
     void sendVideoFocusIndication();
+    void sendAVMediaAckIndication();
+    void onAckTimerExceeded(const boost::system::error_code& error);
+    void dumpAckStatistics() const;
 
     boost::asio::io_service::strand strand_;
     aasdk::channel::av::VideoServiceChannel::Pointer channel_;
     projection::IVideoOutput::Pointer videoOutput_;
     int32_t session_;
+    MediaAckWindow ackWindow_;
+    boost::asio::deadline_timer ackTimer_;
+    bool ackTimerPending_;
+    capture::CaptureWriter::Pointer captureWriter_;
 };
 
 }
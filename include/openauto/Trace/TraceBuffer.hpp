@@ -0,0 +1,75 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <boost/noncopyable.hpp>
+
+namespace openauto
+{
+namespace trace
+{
+
+// Names have to be string literals, only the pointers are stored.
+struct TraceEvent
+{
+    // nanoseconds since the tracer started, duration < 0 for instant events
+    int64_t timestamp = 0;
+    int64_t duration = -1;
+    const char* category = nullptr;
+    const char* owner = nullptr;
+    const char* name = nullptr;
+    const char* argumentName = nullptr;
+    int64_t argument = 0;
+};
+
+// Events of one thread. Only that thread adds, the exporter reads up to the published size from any
+// thread without a lock. Chunks are allocated when the previous one is full and kept until the
+// buffer is destroyed, a full buffer counts the events it drops.
+class TraceBuffer: boost::noncopyable
+{
+public:
+    static constexpr size_t cChunkSize = 4096;
+    static constexpr size_t cMaxChunks = 256;
+
+    TraceBuffer(int32_t threadId, std::string threadName);
+    ~TraceBuffer();
+
+    void add(const TraceEvent& event);
+    size_t size() const;
+    const TraceEvent& at(size_t index) const;
+    uint64_t getDropped() const;
+    int32_t getThreadId() const;
+    const std::string& getThreadName() const;
+
+private:
+    int32_t threadId_;
+    std::string threadName_;
+    std::array<std::atomic<TraceEvent*>, cMaxChunks> chunks_;
+    std::atomic<size_t> size_;
+    std::atomic<uint64_t> dropped_;
+};
+
+}
+}
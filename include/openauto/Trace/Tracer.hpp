@@ -0,0 +1,117 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "openauto/Trace/TraceBuffer.hpp"
+
+namespace openauto
+{
+namespace trace
+{
+
+// Opt-in recorder of spans and instant events for Chrome's trace viewer and Perfetto. While it is
+// stopped a trace point costs a relaxed load. Started, every thread adds to its own TraceBuffer
+// and stop() writes all of them as Chrome trace JSON. A trace still running at exit is written then.
+class Tracer: boost::noncopyable
+{
+public:
+    static Tracer& getInstance();
+
+    static bool isEnabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    static void instant(const char* category, const char* owner, const char* name, const char* argumentName = nullptr, int64_t argument = 0)
+    {
+        if(isEnabled())
+        {
+            getInstance().addInstant(category, owner, name, argumentName, argument);
+        }
+    }
+
+    // names the calling thread for the trace viewer and for top/gdb
+    static void setThreadName(const std::string& name);
+
+    void start(const std::string& path);
+    void stop();
+    void add(const TraceEvent& event);
+    void addInstant(const char* category, const char* owner, const char* name, const char* argumentName, int64_t argument);
+    void exportJson(std::ostream& stream) const;
+    int64_t now() const;
+
+private:
+    Tracer();
+
+    TraceBuffer& getThreadBuffer();
+    static void writeString(std::ostream& stream, const std::string& value);
+
+    static std::atomic<bool> enabled_;
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers_;
+    // bumped by start(), threads holding a buffer of an older trace create a new one
+    std::atomic<uint32_t> generation_;
+    std::atomic<int64_t> origin_;
+    std::string path_;
+    bool exitHandlerRegistered_;
+};
+
+// Records the time from its construction to the end of the enclosing scope as one span.
+class TraceScope: boost::noncopyable
+{
+public:
+    TraceScope(const char* category, const char* owner, const char* name, const char* argumentName = nullptr, int64_t argument = 0)
+        : start_(Tracer::isEnabled() ? Tracer::getInstance().now() : -1)
+        , category_(category)
+        , owner_(owner)
+        , name_(name)
+        , argumentName_(argumentName)
+        , argument_(argument)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if(start_ >= 0)
+        {
+            this->close();
+        }
+    }
+
+private:
+    void close();
+
+    int64_t start_;
+    const char* category_;
+    const char* owner_;
+    const char* name_;
+    const char* argumentName_;
+    int64_t argument_;
+};
+
+}
+}
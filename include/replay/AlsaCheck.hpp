@@ -0,0 +1,63 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_ALSA
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace openauto
+{
+namespace replay
+{
+
+struct AlsaCheckResult
+{
+    std::string device;
+    bool opened = false;
+    uint64_t playedFrames = 0;
+    uint64_t framesAfterXrun = 0;
+    uint64_t framesWhileSuspended = 0;
+    uint64_t framesAfterRestart = 0;
+    uint64_t xruns = 0;
+    uint64_t shortCommits = 0;
+    uint64_t underruns = 0;
+};
+
+// Takes AlsaAudioOutput through its writer loop, an xrun recovery and a suspend/start cycle on
+// any ALSA device. With the null plugin it runs on machines without a sound card, as in CI.
+class AlsaCheck
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr uint32_t cSampleRate = 48000;
+    static constexpr uint32_t cChannelCount = 2;
+    static constexpr std::chrono::milliseconds cPhaseTime{300};
+    static constexpr std::chrono::milliseconds cWriteInterval{10};
+
+    static AlsaCheckResult run(const std::string& device, uint32_t periodSize, uint32_t periodCount);
+    static bool print(const AlsaCheckResult& result, std::ostream& stream);
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "aasdk/Messenger/ChannelId.hpp"
+#include "openauto/Projection/IAudioOutput.hpp"
+
+namespace openauto
+{
+namespace replay
+{
+
+struct AudioBenchmarkResult
+{
+    std::string backend;
+    std::string channel;
+    bool opened = false;
+    uint32_t sampleRate = 0;
+    uint32_t channelCount = 0;
+    uint64_t eventsWritten = 0;
+    uint64_t eventsDetected = 0;
+    uint64_t discontinuities = 0;
+    uint64_t underruns = 0;
+    uint64_t lateCallbacks = 0;
+    double latencyMin = 0;
+    double latencyMean = 0;
+    double latencyP50 = 0;
+    double latencyP95 = 0;
+    double latencyMax = 0;
+    double jitter = 0;
+};
+
+// Plays a synthetic stream of tone bursts and chirps into an audio output at the pace the phone
+// sends it and watches what the output hands to its device through the playback observer.
+// Latency runs from the write of an event to the block it is played in, discontinuities are
+// jumps in the played signal sharper than anything the synthetic stream contains.
+class AudioBenchmark
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    AudioBenchmark(std::chrono::seconds duration);
+
+    AudioBenchmarkResult run(const std::string& backend, aasdk::messenger::ChannelId channel, projection::IAudioOutput::Pointer output) const;
+
+    static bool passed(const AudioBenchmarkResult& result);
+    static void printJson(const std::vector<AudioBenchmarkResult>& results, std::ostream& stream);
+
+    static constexpr std::chrono::milliseconds cPacketDuration{20};
+    static constexpr std::chrono::milliseconds cEventInterval{500};
+
+private:
+    std::vector<int16_t> createSignal(uint32_t sampleRate, uint32_t channelCount, std::vector<size_t>& eventOnsets) const;
+
+    std::chrono::seconds duration_;
+};
+
+}
+}
@@ -0,0 +1,64 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace openauto
+{
+namespace replay
+{
+
+struct InputProcessingResult
+{
+    double echoReturnLossEnhancement = 0;
+    double noiseReduction = 0;
+    double speechLoss = 0;
+    // microseconds
+    double meanFrameTime = 0;
+    double maxFrameTime = 0;
+    uint64_t overBudgetFrames = 0;
+};
+
+// Runs AudioInputProcessor over a synthetic cabin: the echo of a far end signal through a decaying
+// room response, and tone bursts in white noise. Measures how much echo and noise it removes, how
+// much of the bursts it keeps and how long a 10 ms frame takes with both stages on.
+class InputProcessingBenchmark
+{
+public:
+    static constexpr double cMinEchoReturnLossEnhancement = 20.0;
+    static constexpr double cMinNoiseReduction = 10.0;
+    static constexpr double cMaxSpeechLoss = 3.0;
+
+    static InputProcessingResult run();
+    static bool print(const InputProcessingResult& result, std::ostream& stream);
+
+private:
+    static std::vector<float> createFarEnd(size_t frameCount);
+    static std::vector<float> createEcho(const std::vector<float>& farEnd);
+    static double measureEchoCancellation();
+    static void measureNoiseSuppression(InputProcessingResult& result);
+    static void measureFrameTime(InputProcessingResult& result);
+};
+
+}
+}
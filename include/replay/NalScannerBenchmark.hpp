@@ -0,0 +1,62 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace openauto
+{
+namespace replay
+{
+
+struct NalScannerResult
+{
+    std::string name;
+    size_t units = 0;
+    double nanosecondsPerMessage = 0;
+    double megabytesPerSecond = 0;
+};
+
+// Splits a synthetic 60 fps session into NAL units with the std::vector copy and std::search the
+// whitescreen workaround used ("before") and with H264NalScanner in place ("after").
+class NalScannerBenchmark
+{
+public:
+    static constexpr size_t cGopLength = 60;
+    static constexpr size_t cIdrSize = 120000;
+    static constexpr size_t cSliceSize = 20000;
+    static constexpr size_t cMessageCount = 3000;
+    static constexpr size_t cRepetitions = 5;
+
+    static std::vector<NalScannerResult> run();
+    static bool print(const std::vector<NalScannerResult>& results, std::ostream& stream);
+
+private:
+    using Message = std::vector<uint8_t>;
+
+    static std::vector<Message> createSession();
+    template<typename SplitFunction>
+    static NalScannerResult measure(std::string name, const std::vector<Message>& session, SplitFunction split);
+};
+
+}
+}
@@ -0,0 +1,82 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+#include "aasdk/Messenger/ChannelId.hpp"
+#include "openauto/Capture/CaptureReader.hpp"
+#include "openauto/Projection/IVideoOutput.hpp"
+#include "openauto/Projection/IAudioOutput.hpp"
+
+namespace openauto
+{
+namespace replay
+{
+
+enum class ReplayPacing
+{
+    ORIGINAL,
+    FAST
+};
+
+struct ReplayStatistics
+{
+    std::string backend;
+    std::string channel;
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    uint64_t lateRecords = 0;
+    uint64_t underruns = 0;
+    uint64_t lateCallbacks = 0;
+    double wallTime = 0;
+    double processCpuTime = 0;
+    double driverCpuTime = 0;
+    double totalWriteTime = 0;
+    double maxWriteTime = 0;
+    projection::LatencyPercentiles latency;
+};
+
+class ReplayDriver
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    ReplayDriver(const capture::CaptureReader& reader, ReplayPacing pacing);
+
+    ReplayStatistics replayVideo(const std::string& backend, projection::IVideoOutput::Pointer output);
+    ReplayStatistics replayAudio(const std::string& backend, aasdk::messenger::ChannelId channel, projection::IAudioOutput::Pointer output);
+
+    static void print(const ReplayStatistics& statistics, std::ostream& stream);
+
+private:
+    typedef std::function<void(const capture::CaptureRecord&)> RecordHandler;
+
+    ReplayStatistics replay(aasdk::messenger::ChannelId channel, RecordHandler handler);
+
+    static constexpr std::chrono::milliseconds cLateThreshold{10};
+
+    const capture::CaptureReader& reader_;
+    ReplayPacing pacing_;
+};
+
+}
+}
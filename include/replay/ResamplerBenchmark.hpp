@@ -0,0 +1,57 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace openauto
+{
+namespace replay
+{
+
+struct ResamplerResult
+{
+    uint32_t inputRate = 0;
+    uint32_t inputChannels = 0;
+    uint32_t outputRate = 0;
+    uint32_t outputChannels = 0;
+    size_t taps = 0;
+    double thdN = 0;
+    double realtimeFactor = 0;
+};
+
+// Runs the stream and device formats openauto converts between through AudioResampler, measuring
+// THD+N of a 1 kHz tone and how many times faster than real time each conversion runs.
+class ResamplerBenchmark
+{
+public:
+    static constexpr double cMaxThdN = -80.0;
+
+    static std::vector<ResamplerResult> run();
+    static ResamplerResult measure(uint32_t inputRate, uint32_t inputChannels, uint32_t outputRate, uint32_t outputChannels);
+    static bool print(const std::vector<ResamplerResult>& results, std::ostream& stream);
+
+private:
+    static double thdN(const std::vector<float>& samples, double frequency, double sampleRate);
+};
+
+}
+}
@@ -0,0 +1,61 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace openauto
+{
+namespace replay
+{
+
+struct SendPathResult
+{
+    std::string name;
+    double allocationsPerMessage = 0;
+    double allocationsPerSecond = 0;
+    double messagesPerSecond = 0;
+};
+
+// Counts heap allocations of the openauto side of sending a media ack and a touch event, as sent
+// before (std::bind handlers, fresh messages) and after (pooled promises, reused messages). The
+// messages run as chained strand handlers like in a service. Allocations inside aasdk's channel and
+// messenger are not part of it.
+class SendPathBenchmark
+{
+public:
+    // acks of a 60 fps video and three audio channels plus touch events reported at 120 Hz
+    static constexpr double cMessageRate = 300.0;
+    static constexpr size_t cWarmupCount = 1000;
+    static constexpr size_t cMessageCount = 100000;
+
+    static std::vector<SendPathResult> run();
+    static bool print(const std::vector<SendPathResult>& results, std::ostream& stream);
+
+private:
+    template<typename SendFunction>
+    static SendPathResult measure(std::string name, SendFunction send);
+};
+
+}
+}
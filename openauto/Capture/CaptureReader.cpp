@@ -0,0 +1,228 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "openauto/Capture/CaptureReader.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace capture
+{
+
+CaptureReader::CaptureReader()
+    : fd_(-1)
+    , data_(nullptr)
+    , size_(0)
+    , indexed_(false)
+{
+
+}
+
+CaptureReader::~CaptureReader()
+{
+    this->close();
+}
+
+bool CaptureReader::open(const std::string& path)
+{
+    this->close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if(fd_ < 0)
+    {
+        LOG(error) << "Failed to open capture " << path;
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(fd_, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(CaptureFileHeader))
+    {
+        LOG(error) << "Capture " << path << " is truncated";
+        this->close();
+        return false;
+    }
+
+    size_ = static_cast<size_t>(status.st_size);
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if(mapping == MAP_FAILED)
+    {
+        LOG(error) << "Failed to map capture " << path;
+        size_ = 0;
+        this->close();
+        return false;
+    }
+
+    data_ = static_cast<const uint8_t*>(mapping);
+
+    CaptureFileHeader header;
+    memcpy(&header, data_, sizeof(header));
+    if(header.magic != cCaptureMagic || header.version != cCaptureVersion)
+    {
+        LOG(error) << "Unsupported capture " << path << ", version: " << header.version;
+        this->close();
+        return false;
+    }
+
+    indexed_ = this->readIndex();
+    if(!indexed_)
+    {
+        LOG(warning) << "Capture " << path << " has no index, scanning records";
+        this->rebuildIndex();
+    }
+
+    return true;
+}
+
+void CaptureReader::close()
+{
+    if(data_ != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+    }
+
+    if(fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    size_ = 0;
+    indexed_ = false;
+    index_.clear();
+}
+
+bool CaptureReader::isIndexed() const
+{
+    return indexed_;
+}
+
+uint64_t CaptureReader::getStartTime() const
+{
+    CaptureFileHeader header;
+    memcpy(&header, data_, sizeof(header));
+    return header.startTime;
+}
+
+size_t CaptureReader::getRecordCount() const
+{
+    return index_.size();
+}
+
+bool CaptureReader::getRecord(size_t index, CaptureRecord& record) const
+{
+    if(index >= index_.size())
+    {
+        return false;
+    }
+
+    CaptureRecordHeader header;
+    memcpy(&header, data_ + index_[index].offset, sizeof(header));
+
+    record.type = static_cast<CaptureRecordType>(header.type);
+    record.channel = static_cast<aasdk::messenger::ChannelId>(header.channel);
+    record.timestamp = header.timestamp;
+    record.captureTime = header.captureTime;
+    record.data = data_ + index_[index].offset + sizeof(header);
+    record.size = header.size;
+    return true;
+}
+
+bool CaptureReader::getFormat(aasdk::messenger::ChannelId channel, CaptureStreamFormat& format) const
+{
+    CaptureRecord record;
+    for(size_t i = 0; this->getRecord(i, record); ++i)
+    {
+        if(record.type == CaptureRecordType::FORMAT && record.channel == channel && record.size >= sizeof(format))
+        {
+            memcpy(&format, record.data, sizeof(format));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t CaptureReader::seek(uint64_t captureTime) const
+{
+    auto it = std::lower_bound(index_.begin(), index_.end(), captureTime, [](const CaptureIndexEntry& entry, uint64_t value) {
+        return entry.captureTime < value;
+    });
+
+    return static_cast<size_t>(it - index_.begin());
+}
+
+bool CaptureReader::readIndex()
+{
+    if(size_ < sizeof(CaptureFileHeader) + sizeof(CaptureTrailer))
+    {
+        return false;
+    }
+
+    CaptureTrailer trailer;
+    memcpy(&trailer, data_ + size_ - sizeof(trailer), sizeof(trailer));
+
+    const size_t indexEnd = size_ - sizeof(trailer);
+    if(trailer.magic != cCaptureIndexMagic || trailer.indexOffset > indexEnd
+       || (indexEnd - trailer.indexOffset) / sizeof(CaptureIndexEntry) != trailer.entryCount)
+    {
+        return false;
+    }
+
+    index_.resize(trailer.entryCount);
+    memcpy(index_.data(), data_ + trailer.indexOffset, trailer.entryCount * sizeof(CaptureIndexEntry));
+    return true;
+}
+
+void CaptureReader::rebuildIndex()
+{
+    size_t offset = sizeof(CaptureFileHeader);
+    uint64_t captureTime = 0;
+
+    // records are contiguous, stop at the first one cut short by the crash that left the file unindexed
+    // or at what is left of a partially written index
+    while(offset + sizeof(CaptureRecordHeader) <= size_)
+    {
+        CaptureRecordHeader header;
+        memcpy(&header, data_ + offset, sizeof(header));
+
+        if(header.size > size_ - offset - sizeof(header) || header.type > static_cast<uint16_t>(CaptureRecordType::FORMAT)
+           || header.captureTime < captureTime)
+        {
+            break;
+        }
+        captureTime = header.captureTime;
+
+        CaptureIndexEntry entry;
+        entry.offset = offset;
+        entry.captureTime = header.captureTime;
+        index_.push_back(entry);
+
+        offset += sizeof(header) + header.size;
+    }
+}
+
+}
+}
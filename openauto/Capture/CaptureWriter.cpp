@@ -0,0 +1,197 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "openauto/Capture/CaptureWriter.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace capture
+{
+
+CaptureWriter::CaptureWriter(const std::string& path)
+    : path_(path)
+    , file_(path, std::ios::binary | std::ios::trunc)
+    , startTime_(Clock::now())
+    , queuedBytes_(0)
+    , stopped_(false)
+    , offset_(0)
+    , records_(0)
+    , bytes_(0)
+    , droppedRecords_(0)
+{
+    if(!file_.is_open())
+    {
+        LOG(error) << "Failed to open capture file " << path_;
+        return;
+    }
+
+    CaptureFileHeader header;
+    header.magic = cCaptureMagic;
+    header.version = cCaptureVersion;
+    header.startTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    offset_ = sizeof(header);
+
+    thread_ = std::thread(&CaptureWriter::run, this);
+    LOG(info) << "Capturing media to " << path_;
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        stopped_ = true;
+    }
+    condition_.notify_one();
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    if(file_.is_open())
+    {
+        this->writeIndex();
+        LOG(info) << "Capture " << path_ << " closed, records: " << records_
+                  << ", bytes: " << bytes_
+                  << ", dropped: " << droppedRecords_;
+    }
+}
+
+bool CaptureWriter::isOpen() const
+{
+    return file_.is_open();
+}
+
+const std::string& CaptureWriter::getPath() const
+{
+    return path_;
+}
+
+void CaptureWriter::writeFormat(aasdk::messenger::ChannelId channel, uint32_t sampleRate, uint32_t channelCount, uint32_t sampleSize)
+{
+    CaptureStreamFormat format;
+    format.sampleRate = sampleRate;
+    format.channelCount = channelCount;
+    format.sampleSize = sampleSize;
+    format.reserved = 0;
+
+    this->enqueue(CaptureRecordType::FORMAT, channel, 0, reinterpret_cast<const uint8_t*>(&format), sizeof(format));
+}
+
+void CaptureWriter::write(aasdk::messenger::ChannelId channel, aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    this->enqueue(CaptureRecordType::MEDIA, channel, timestamp, buffer.cdata, buffer.size);
+}
+
+CaptureStatistics CaptureWriter::getStatistics() const
+{
+    CaptureStatistics statistics;
+    statistics.records = records_;
+    statistics.bytes = bytes_;
+    statistics.droppedRecords = droppedRecords_;
+    return statistics;
+}
+
+void CaptureWriter::enqueue(CaptureRecordType type, aasdk::messenger::ChannelId channel, uint64_t timestamp, const uint8_t* data, size_t size)
+{
+    if(!file_.is_open())
+    {
+        return;
+    }
+
+    Record record;
+    record.header.type = static_cast<uint16_t>(type);
+    record.header.channel = static_cast<uint16_t>(channel);
+    record.header.size = static_cast<uint32_t>(size);
+    record.header.timestamp = timestamp;
+    record.header.captureTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime_).count();
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+        // the caller runs on a service strand, a slow disk costs records rather than stalling the projection
+        if(queuedBytes_ + size > cMaxQueuedBytes)
+        {
+            ++droppedRecords_;
+            return;
+        }
+
+        record.payload.assign(data, data + size);
+        queuedBytes_ += size;
+        queue_.emplace_back(std::move(record));
+    }
+
+    condition_.notify_one();
+}
+
+void CaptureWriter::run()
+{
+    std::unique_lock<decltype(mutex_)> lock(mutex_);
+
+    while(true)
+    {
+        condition_.wait(lock, [this]() { return stopped_ || !queue_.empty(); });
+
+        if(queue_.empty())
+        {
+            break;
+        }
+
+        Record record = std::move(queue_.front());
+        queue_.pop_front();
+        queuedBytes_ -= record.payload.size();
+
+        lock.unlock();
+        this->writeRecord(record);
+        lock.lock();
+    }
+}
+
+void CaptureWriter::writeRecord(const Record& record)
+{
+    CaptureIndexEntry entry;
+    entry.offset = offset_;
+    entry.captureTime = record.header.captureTime;
+    index_.push_back(entry);
+
+    file_.write(reinterpret_cast<const char*>(&record.header), sizeof(record.header));
+    file_.write(reinterpret_cast<const char*>(record.payload.data()), record.payload.size());
+    offset_ += sizeof(record.header) + record.payload.size();
+
+    ++records_;
+    bytes_ += record.payload.size();
+}
+
+void CaptureWriter::writeIndex()
+{
+    CaptureTrailer trailer;
+    trailer.indexOffset = offset_;
+    trailer.entryCount = index_.size();
+    trailer.magic = cCaptureIndexMagic;
+    trailer.reserved = 0;
+
+    file_.write(reinterpret_cast<const char*>(index_.data()), index_.size() * sizeof(CaptureIndexEntry));
+    file_.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+    file_.close();
+}
+
+}
+}
@@ -27,6 +27,9 @@ namespace configuration
 const std::string Configuration::cConfigFileName = "openauto.ini";
 
 const std::string Configuration::cGeneralShowClockKey = "General.ShowClock";
+const std::string Configuration::cGeneralCapturePathKey = "General.CapturePath";
+const std::string Configuration::cGeneralLogSeverityKey = "General.LogSeverity";
+const std::string Configuration::cGeneralTracePathKey = "General.TracePath";
 const std::string Configuration::cGeneralHandednessOfTrafficTypeKey = "General.HandednessOfTrafficType";
 
 const std::string Configuration::cVideoFPSKey = "Video.FPS";
@@ -36,11 +39,21 @@ const std::string Configuration::cVideoOMXLayerIndexKey = "Video.OMXLayerIndex";
 const std::string Configuration::cVideoMarginWidth = "Video.MarginWidth";
 const std::string Configuration::cVideoMarginHeight = "Video.MarginHeight";
 const std::string Configuration::cVideoWhitescreenWorkaround = "Video.WhitesreenWorkaround";
+const std::string Configuration::cVideoMaxUnacked = "Video.MaxUnacked";
+const std::string Configuration::cVideoLatencyBudget = "Video.LatencyBudget";
+const std::string Configuration::cVideoOutputBackendType = "Video.OutputBackendType";
+const std::string Configuration::cVideoFrameThreading = "Video.FrameThreading";
 
 
 const std::string Configuration::cAudioMusicAudioChannelEnabled = "Audio.MusicAudioChannelEnabled";
 const std::string Configuration::cAudioSpeechAudioChannelEnabled = "Audio.SpeechAudioChannelEnabled";
 const std::string Configuration::cAudioOutputBackendType = "Audio.OutputBackendType";
+const std::string Configuration::cAudioMaxUnacked = "Audio.MaxUnacked";
+const std::string Configuration::cAudioFileOutputPath = "Audio.FileOutputPath";
+const std::string Configuration::cAudioDuckingLevel = "Audio.DuckingLevel";
+const std::string Configuration::cAudioAlsaDevice = "Audio.AlsaDevice";
+const std::string Configuration::cAudioAlsaPeriodSize = "Audio.AlsaPeriodSize";
+const std::string Configuration::cAudioAlsaPeriodCount = "Audio.AlsaPeriodCount";
 
 const std::string Configuration::cBluetoothAdapterTypeKey = "Bluetooth.AdapterType";
 const std::string Configuration::cBluetoothRemoteAdapterAddressKey = "Bluetooth.RemoteAdapterAddress";
@@ -85,6 +98,9 @@ void Configuration::load()
         handednessOfTrafficType_ = static_cast<HandednessOfTrafficType>(iniConfig.get<uint32_t>(cGeneralHandednessOfTrafficTypeKey,
                                                                                                 static_cast<uint32_t>(HandednessOfTrafficType::LEFT_HAND_DRIVE)));
         showClock_ = iniConfig.get<bool>(cGeneralShowClockKey, true);
+        capturePath_ = iniConfig.get<std::string>(cGeneralCapturePathKey, "");
+        logSeverity_ = iniConfig.get<std::string>(cGeneralLogSeverityKey, "info");
+        tracePath_ = iniConfig.get<std::string>(cGeneralTracePathKey, "");
 
         videoFPS_ = static_cast<aasdk::proto::enums::VideoFPS::Enum>(iniConfig.get<uint32_t>(cVideoFPSKey,
                                                                                              aasdk::proto::enums::VideoFPS::_60));
@@ -96,6 +112,10 @@ void Configuration::load()
         omxLayerIndex_ = iniConfig.get<int32_t>(cVideoOMXLayerIndexKey, 1);
         videoMargins_ = QRect(0, 0, iniConfig.get<int32_t>(cVideoMarginWidth, 0), iniConfig.get<int32_t>(cVideoMarginHeight, 0));
         whitescreenWorkaround_ = iniConfig.get<bool>(cVideoWhitescreenWorkaround, true);
+        videoMaxUnacked_ = iniConfig.get<uint32_t>(cVideoMaxUnacked, 4);
+        videoLatencyBudget_ = iniConfig.get<uint32_t>(cVideoLatencyBudget, 100);
+        videoOutputBackendType_ = static_cast<VideoOutputBackendType>(iniConfig.get<uint32_t>(cVideoOutputBackendType, static_cast<uint32_t>(VideoOutputBackendType::DEFAULT)));
+        videoFrameThreading_ = iniConfig.get<bool>(cVideoFrameThreading, false);
 
         enableTouchscreen_ = iniConfig.get<bool>(cInputEnableTouchscreenKey, true);
         this->readButtonCodes(iniConfig);
@@ -108,6 +128,12 @@ void Configuration::load()
         musicAudioChannelEnabled_ = iniConfig.get<bool>(cAudioMusicAudioChannelEnabled, true);
         speechAudiochannelEnabled_ = iniConfig.get<bool>(cAudioSpeechAudioChannelEnabled, true);
         audioOutputBackendType_ = static_cast<AudioOutputBackendType>(iniConfig.get<uint32_t>(cAudioOutputBackendType, static_cast<uint32_t>(AudioOutputBackendType::QT)));
+        audioMaxUnacked_ = iniConfig.get<uint32_t>(cAudioMaxUnacked, 4);
+        audioFileOutputPath_ = iniConfig.get<std::string>(cAudioFileOutputPath, ".");
+        audioDuckingLevel_ = iniConfig.get<uint32_t>(cAudioDuckingLevel, 25);
+        audioAlsaDevice_ = iniConfig.get<std::string>(cAudioAlsaDevice, "plughw:0,0");
+        audioAlsaPeriodSize_ = iniConfig.get<uint32_t>(cAudioAlsaPeriodSize, 256);
+        audioAlsaPeriodCount_ = iniConfig.get<uint32_t>(cAudioAlsaPeriodCount, 3);
 
         wifiSSID_ = iniConfig.get<std::string>(cWifiSSID, "");
         wifiPassword_ = iniConfig.get<std::string>(cWifiPskey, "");
@@ -128,12 +154,19 @@ void Configuration::reset()
 {
     handednessOfTrafficType_ = HandednessOfTrafficType::LEFT_HAND_DRIVE;
     showClock_ = true;
+    capturePath_ = "";
+    logSeverity_ = "info";
+    tracePath_ = "";
     videoFPS_ = aasdk::proto::enums::VideoFPS::_60;
     videoResolution_ = aasdk::proto::enums::VideoResolution::_480p;
     screenDPI_ = 140;
     omxLayerIndex_ = 1;
     videoMargins_ = QRect(0, 0, 0, 0);
     whitescreenWorkaround_ = true;
+    videoMaxUnacked_ = 4;
+    videoLatencyBudget_ = 100;
+    videoOutputBackendType_ = VideoOutputBackendType::DEFAULT;
+    videoFrameThreading_ = false;
     enableTouchscreen_ = true;
     buttonCodes_.clear();
     bluetoothAdapterType_ = BluetoothAdapterType::NONE;
@@ -141,6 +174,12 @@ void Configuration::reset()
     musicAudioChannelEnabled_ = true;
     speechAudiochannelEnabled_ = true;
     audioOutputBackendType_ = AudioOutputBackendType::QT;
+    audioMaxUnacked_ = 4;
+    audioFileOutputPath_ = ".";
+    audioDuckingLevel_ = 25;
+    audioAlsaDevice_ = "plughw:0,0";
+    audioAlsaPeriodSize_ = 256;
+    audioAlsaPeriodCount_ = 3;
 }
 
 void Configuration::save()
@@ -148,6 +187,9 @@ void Configuration::save()
     boost::property_tree::ptree iniConfig;
     iniConfig.put<uint32_t>(cGeneralHandednessOfTrafficTypeKey, static_cast<uint32_t>(handednessOfTrafficType_));
     iniConfig.put<bool>(cGeneralShowClockKey, showClock_);
+    iniConfig.put<std::string>(cGeneralCapturePathKey, capturePath_);
+    iniConfig.put<std::string>(cGeneralLogSeverityKey, logSeverity_);
+    iniConfig.put<std::string>(cGeneralTracePathKey, tracePath_);
 
     iniConfig.put<uint32_t>(cVideoFPSKey, static_cast<uint32_t>(videoFPS_));
     iniConfig.put<uint32_t>(cVideoResolutionKey, static_cast<uint32_t>(videoResolution_));
@@ -156,6 +198,10 @@ void Configuration::save()
     iniConfig.put<uint32_t>(cVideoMarginWidth, videoMargins_.width());
     iniConfig.put<uint32_t>(cVideoMarginHeight, videoMargins_.height());
     iniConfig.put<bool>(cVideoWhitescreenWorkaround, whitescreenWorkaround_);
+    iniConfig.put<uint32_t>(cVideoMaxUnacked, videoMaxUnacked_);
+    iniConfig.put<uint32_t>(cVideoLatencyBudget, videoLatencyBudget_);
+    iniConfig.put<uint32_t>(cVideoOutputBackendType, static_cast<uint32_t>(videoOutputBackendType_));
+    iniConfig.put<bool>(cVideoFrameThreading, videoFrameThreading_);
 
     iniConfig.put<bool>(cInputEnableTouchscreenKey, enableTouchscreen_);
     this->writeButtonCodes(iniConfig);
@@ -166,6 +212,12 @@ void Configuration::save()
     iniConfig.put<bool>(cAudioMusicAudioChannelEnabled, musicAudioChannelEnabled_);
     iniConfig.put<bool>(cAudioSpeechAudioChannelEnabled, speechAudiochannelEnabled_);
     iniConfig.put<uint32_t>(cAudioOutputBackendType, static_cast<uint32_t>(audioOutputBackendType_));
+    iniConfig.put<uint32_t>(cAudioMaxUnacked, audioMaxUnacked_);
+    iniConfig.put<std::string>(cAudioFileOutputPath, audioFileOutputPath_);
+    iniConfig.put<uint32_t>(cAudioDuckingLevel, audioDuckingLevel_);
+    iniConfig.put<std::string>(cAudioAlsaDevice, audioAlsaDevice_);
+    iniConfig.put<uint32_t>(cAudioAlsaPeriodSize, audioAlsaPeriodSize_);
+    iniConfig.put<uint32_t>(cAudioAlsaPeriodCount, audioAlsaPeriodCount_);
 
     iniConfig.put<std::string>(cWifiSSID, wifiSSID_);
     iniConfig.put<std::string>(cWifiPskey, wifiPassword_);
@@ -195,6 +247,36 @@ bool Configuration::showClock() const
     return showClock_;
 }
 
+std::string Configuration::getCapturePath() const
+{
+    return capturePath_;
+}
+
+void Configuration::setCapturePath(const std::string& value)
+{
+    capturePath_ = value;
+}
+
+std::string Configuration::getLogSeverity() const
+{
+    return logSeverity_;
+}
+
+void Configuration::setLogSeverity(const std::string& value)
+{
+    logSeverity_ = value;
+}
+
+std::string Configuration::getTracePath() const
+{
+    return tracePath_;
+}
+
+void Configuration::setTracePath(const std::string& value)
+{
+    tracePath_ = value;
+}
+
 aasdk::proto::enums::VideoFPS::Enum Configuration::getVideoFPS() const
 {
     return videoFPS_;
@@ -255,6 +337,46 @@ bool Configuration::getWhitescreenWorkaround() const
     return whitescreenWorkaround_;
 }
 
+uint32_t Configuration::getVideoMaxUnacked() const
+{
+    return videoMaxUnacked_;
+}
+
+void Configuration::setVideoMaxUnacked(uint32_t value)
+{
+    videoMaxUnacked_ = value;
+}
+
+uint32_t Configuration::getVideoLatencyBudget() const
+{
+    return videoLatencyBudget_;
+}
+
+void Configuration::setVideoLatencyBudget(uint32_t value)
+{
+    videoLatencyBudget_ = value;
+}
+
+VideoOutputBackendType Configuration::getVideoOutputBackendType() const
+{
+    return videoOutputBackendType_;
+}
+
+void Configuration::setVideoOutputBackendType(VideoOutputBackendType value)
+{
+    videoOutputBackendType_ = value;
+}
+
+bool Configuration::getVideoFrameThreading() const
+{
+    return videoFrameThreading_;
+}
+
+void Configuration::setVideoFrameThreading(bool value)
+{
+    videoFrameThreading_ = value;
+}
+
 bool Configuration::getTouchscreenEnabled() const
 {
     return enableTouchscreen_;
@@ -325,6 +447,66 @@ void Configuration::setAudioOutputBackendType(AudioOutputBackendType value)
     audioOutputBackendType_ = value;
 }
 
+uint32_t Configuration::getAudioMaxUnacked() const
+{
+    return audioMaxUnacked_;
+}
+
+void Configuration::setAudioMaxUnacked(uint32_t value)
+{
+    audioMaxUnacked_ = value;
+}
+
+std::string Configuration::getAudioFileOutputPath() const
+{
+    return audioFileOutputPath_;
+}
+
+void Configuration::setAudioFileOutputPath(const std::string& value)
+{
+    audioFileOutputPath_ = value;
+}
+
+uint32_t Configuration::getAudioDuckingLevel() const
+{
+    return audioDuckingLevel_;
+}
+
+void Configuration::setAudioDuckingLevel(uint32_t value)
+{
+    audioDuckingLevel_ = value;
+}
+
+std::string Configuration::getAudioAlsaDevice() const
+{
+    return audioAlsaDevice_;
+}
+
+void Configuration::setAudioAlsaDevice(const std::string& value)
+{
+    audioAlsaDevice_ = value;
+}
+
+uint32_t Configuration::getAudioAlsaPeriodSize() const
+{
+    return audioAlsaPeriodSize_;
+}
+
+void Configuration::setAudioAlsaPeriodSize(uint32_t value)
+{
+    audioAlsaPeriodSize_ = value;
+}
+
+uint32_t Configuration::getAudioAlsaPeriodCount() const
+{
+    return audioAlsaPeriodCount_;
+}
+
+void Configuration::setAudioAlsaPeriodCount(uint32_t value)
+{
+    audioAlsaPeriodCount_ = value;
+}
+
 std::string Configuration::getWifiSSID()
 {
     return wifiSSID_;
@@ -0,0 +1,393 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <streambuf>
+#include "OpenautoLog.hpp"
+#include "openauto/Log/LogBackend.hpp"
+
+namespace openauto
+{
+namespace log
+{
+
+namespace
+{
+
+// writes into the acquired ring slot, anything past its end is cut off
+class LogStreamBuffer: public std::streambuf
+{
+public:
+    void reset(char* data, size_t size)
+    {
+        this->setp(data, data + size);
+    }
+
+    size_t size() const
+    {
+        return this->pptr() - this->pbase();
+    }
+};
+
+const char* const cSeverityNames[] = {"trace", "debug", "info", "warning", "error", "fatal"};
+
+}
+
+struct ThreadLog
+{
+    ThreadLog()
+        : ring(LogBackend::getInstance().createRing())
+        , stream(&buffer)
+        , threadId(gettid())
+        , active(false)
+    {
+    }
+
+    std::shared_ptr<LogRing> ring;
+    LogStreamBuffer buffer;
+    std::ostream stream;
+    int32_t threadId;
+    // set while a message is formatted, a LOG inside one of its operator<< is dropped
+    bool active;
+};
+
+constexpr size_t LogBackend::cRingCapacity;
+constexpr int64_t LogBackend::cFlushInterval;
+constexpr uint32_t LogBackend::cSuppressedReportInterval;
+
+LogBackend& LogBackend::getInstance()
+{
+    // never destroyed, threads may still log while static destructors run
+    static LogBackend* instance = new LogBackend();
+    return *instance;
+}
+
+LogBackend::LogBackend()
+    : defaultSeverity_(Severity::info)
+    , running_(true)
+{
+    flusher_ = std::thread(&LogBackend::run, this);
+    std::atexit([]() { LogBackend::getInstance().stop(); });
+}
+
+void LogBackend::configure(const std::string& spec)
+{
+    std::vector<std::string> invalid;
+
+    {
+        std::lock_guard<decltype(sitesMutex_)> lock(sitesMutex_);
+        moduleSeverities_.clear();
+        defaultSeverity_ = Severity::info;
+
+        size_t begin = 0;
+        while(begin <= spec.size())
+        {
+            const size_t end = std::min(spec.find(',', begin), spec.size());
+            std::string token = spec.substr(begin, end - begin);
+            token.erase(std::remove_if(token.begin(), token.end(), [](char c) { return c == ' ' || c == '\t'; }), token.end());
+            begin = end + 1;
+
+            if(token.empty())
+            {
+                continue;
+            }
+
+            Severity severity;
+            const size_t separator = token.find('=');
+            if(separator == std::string::npos && parseSeverity(token, severity))
+            {
+                defaultSeverity_ = severity;
+            }
+            else if(separator != std::string::npos && separator > 0 && parseSeverity(token.substr(separator + 1), severity))
+            {
+                moduleSeverities_[token.substr(0, separator)] = severity;
+            }
+            else
+            {
+                invalid.push_back(token);
+            }
+        }
+
+        for(auto site : sites_)
+        {
+            site->setThreshold(this->getThreshold(site->getModule()));
+        }
+    }
+
+    // sites register under sitesMutex_, so nothing is logged while it is held
+    for(const auto& token : invalid)
+    {
+        LOG(warning) << "[LogBackend] ignoring log severity " << token;
+    }
+}
+
+Severity LogBackend::getDefaultSeverity() const
+{
+    std::lock_guard<decltype(sitesMutex_)> lock(sitesMutex_);
+    return defaultSeverity_;
+}
+
+void LogBackend::registerSite(LogSite& site)
+{
+    std::lock_guard<decltype(sitesMutex_)> lock(sitesMutex_);
+    site.setThreshold(this->getThreshold(site.getModule()));
+    sites_.push_back(&site);
+}
+
+std::shared_ptr<LogRing> LogBackend::createRing()
+{
+    auto ring = std::make_shared<LogRing>(cRingCapacity);
+    std::lock_guard<decltype(ringsMutex_)> lock(ringsMutex_);
+    rings_.push_back(ring);
+    return ring;
+}
+
+void LogBackend::flush()
+{
+    std::lock_guard<decltype(flushMutex_)> flushLock(flushMutex_);
+
+    std::vector<std::shared_ptr<LogRing>> rings;
+    {
+        std::lock_guard<decltype(ringsMutex_)> lock(ringsMutex_);
+        rings = rings_;
+    }
+
+    output_.clear();
+
+    // merge the rings by time, there are only a few dozen threads
+    while(true)
+    {
+        LogRing* oldestRing = nullptr;
+        LogEntry* oldest = nullptr;
+        for(const auto& ring : rings)
+        {
+            auto entry = ring->front();
+            if(entry != nullptr && (oldest == nullptr || entry->time < oldest->time))
+            {
+                oldestRing = ring.get();
+                oldest = entry;
+            }
+        }
+
+        if(oldest == nullptr)
+        {
+            break;
+        }
+
+        this->format(*oldest);
+        oldestRing->pop();
+    }
+
+    for(const auto& ring : rings)
+    {
+        const auto dropped = ring->takeDropped();
+        if(dropped > 0)
+        {
+            const auto text = "\t[LogBackend] " + std::to_string(dropped) + " messages dropped, log ring full";
+            this->appendLine(std::chrono::system_clock::now(), Severity::warning, text.c_str());
+        }
+    }
+
+    if(!output_.empty())
+    {
+        std::cout.write(output_.data(), output_.size());
+        std::cout.flush();
+    }
+
+    // rings of finished threads are only referenced here and were drained above
+    rings.clear();
+    std::lock_guard<decltype(ringsMutex_)> lock(ringsMutex_);
+    rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<LogRing>& ring) {
+        return ring.use_count() == 1 && ring->front() == nullptr;
+    }), rings_.end());
+}
+
+void LogBackend::stop()
+{
+    if(running_.exchange(false))
+    {
+        flusher_.join();
+        this->flush();
+    }
+}
+
+void LogBackend::run()
+{
+    uint32_t passes = 0;
+    while(running_)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(cFlushInterval));
+        this->flush();
+
+        if(++passes % cSuppressedReportInterval == 0)
+        {
+            this->reportSuppressed();
+        }
+    }
+}
+
+void LogBackend::format(const LogEntry& entry)
+{
+    char text[LogEntry::cMaxLength + 512];
+    const int length = std::snprintf(text, sizeof(text), "\t[%d][" ADDITIONAL_TAG "][%s:%d][%s] %.*s",
+                               entry.threadId, entry.site->getFile(), entry.site->getLine(), entry.function,
+                               static_cast<int>(entry.length), entry.text);
+
+    if(entry.suppressed > 0 && length >= 0 && static_cast<size_t>(length) < sizeof(text))
+    {
+        std::snprintf(text + length, sizeof(text) - length, " (%u similar messages suppressed)", entry.suppressed);
+    }
+
+    this->appendLine(entry.time, entry.severity, text);
+}
+
+void LogBackend::appendLine(std::chrono::system_clock::time_point time, Severity severity, const char* text)
+{
+    // the layout Boost.Log used, [%TimeStamp%] [%Severity%] %Message%
+    const auto seconds = std::chrono::system_clock::to_time_t(time);
+    const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count() % 1000000;
+    std::tm localTime;
+    localtime_r(&seconds, &localTime);
+
+    char timestamp[64];
+    const auto timestampLength = std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &localTime);
+    std::snprintf(timestamp + timestampLength, sizeof(timestamp) - timestampLength, ".%06ld", static_cast<long>(microseconds));
+
+    output_ += "[";
+    output_ += timestamp;
+    output_ += "] [";
+    output_ += getSeverityName(severity);
+    output_ += "] ";
+    output_ += text;
+    output_ += "\n";
+}
+
+void LogBackend::reportSuppressed()
+{
+    std::vector<std::pair<const LogSite*, uint32_t>> suppressed;
+    {
+        std::lock_guard<decltype(sitesMutex_)> lock(sitesMutex_);
+        for(auto site : sites_)
+        {
+            const auto count = site->takeSuppressed();
+            if(count > 0)
+            {
+                suppressed.emplace_back(site, count);
+            }
+        }
+    }
+
+    for(const auto& entry : suppressed)
+    {
+        LOG(info) << "[LogBackend] " << entry.second << " messages suppressed at " << entry.first->getFile() << ":" << entry.first->getLine();
+    }
+}
+
+Severity LogBackend::getThreshold(const std::string& module) const
+{
+    const auto severity = moduleSeverities_.find(module);
+    return severity != moduleSeverities_.end() ? severity->second : defaultSeverity_;
+}
+
+bool LogBackend::parseSeverity(const std::string& name, Severity& severity)
+{
+    for(size_t i = 0; i < sizeof(cSeverityNames) / sizeof(cSeverityNames[0]); ++i)
+    {
+        if(name == cSeverityNames[i])
+        {
+            severity = static_cast<Severity>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* LogBackend::getSeverityName(Severity severity)
+{
+    const auto index = static_cast<size_t>(severity);
+    return index < sizeof(cSeverityNames) / sizeof(cSeverityNames[0]) ? cSeverityNames[index] : "unknown";
+}
+
+void LogRecord::open(LogSite& site, Severity severity, const char* function)
+{
+    uint32_t suppressed = 0;
+    if(!site.admit(suppressed))
+    {
+        return;
+    }
+
+    static thread_local ThreadLog threadLog;
+    if(threadLog.active)
+    {
+        return;
+    }
+
+    entry_ = threadLog.ring->acquire();
+    if(entry_ == nullptr)
+    {
+        return;
+    }
+
+    threadLog.active = true;
+    threadLog_ = &threadLog;
+
+    entry_->time = std::chrono::system_clock::now();
+    entry_->severity = severity;
+    entry_->site = &site;
+    entry_->function = function;
+    entry_->threadId = threadLog.threadId;
+    entry_->suppressed = suppressed;
+
+    // the stream is reused, undo what the previous message may have changed
+    threadLog.buffer.reset(entry_->text, LogEntry::cMaxLength);
+    threadLog.stream.clear();
+    threadLog.stream.flags(std::ios_base::skipws | std::ios_base::dec);
+    threadLog.stream.precision(6);
+    threadLog.stream.fill(' ');
+    stream_ = &threadLog.stream;
+}
+
+void LogRecord::close(bool push)
+{
+    if(push)
+    {
+        entry_->length = threadLog_->buffer.size();
+        if(threadLog_->stream.bad() && entry_->length >= 3)
+        {
+            // cut off at cMaxLength
+            std::fill(entry_->text + entry_->length - 3, entry_->text + entry_->length, '.');
+        }
+
+        threadLog_->ring->push();
+    }
+
+    threadLog_->active = false;
+    threadLog_ = nullptr;
+    entry_ = nullptr;
+}
+
+}
+}
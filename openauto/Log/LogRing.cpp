@@ -0,0 +1,78 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include "openauto/Log/LogRing.hpp"
+
+namespace openauto
+{
+namespace log
+{
+
+constexpr size_t LogEntry::cMaxLength;
+
+LogRing::LogRing(size_t capacity)
+    : slots_(std::max<size_t>(capacity, 1))
+    , head_(0)
+    , tail_(0)
+    , dropped_(0)
+{
+
+}
+
+LogEntry* LogRing::acquire()
+{
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if(head - tail_.load(std::memory_order_acquire) >= slots_.size())
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    return &slots_[head % slots_.size()];
+}
+
+void LogRing::push()
+{
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+LogEntry* LogRing::front()
+{
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if(head_.load(std::memory_order_acquire) == tail)
+    {
+        return nullptr;
+    }
+
+    return &slots_[tail % slots_.size()];
+}
+
+void LogRing::pop()
+{
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+uint64_t LogRing::takeDropped()
+{
+    return dropped_.exchange(0, std::memory_order_relaxed);
+}
+
+}
+}
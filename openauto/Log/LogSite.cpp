@@ -0,0 +1,105 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <chrono>
+#include <cstring>
+#include "openauto/Log/LogBackend.hpp"
+#include "openauto/Log/LogSite.hpp"
+
+namespace openauto
+{
+namespace log
+{
+
+constexpr uint32_t LogSite::cRateLimitBurst;
+constexpr int64_t LogSite::cRateLimitInterval;
+
+LogSite::LogSite(const char* file, int line)
+    : file_(file)
+    , line_(line)
+    , threshold_(static_cast<int>(Severity::trace))
+    , windowStart_(now())
+    , windowCount_(0)
+    , suppressed_(0)
+{
+    // the module is the file name without directory and extension, e.g. VideoService
+    const char* name = std::strrchr(file, '/');
+    name = name != nullptr ? name + 1 : file;
+    const char* extension = std::strchr(name, '.');
+    module_.assign(name, extension != nullptr ? extension - name : std::strlen(name));
+
+    LogBackend::getInstance().registerSite(*this);
+}
+
+bool LogSite::admit(uint32_t& suppressed)
+{
+    const auto timestamp = now();
+    auto windowStart = windowStart_.load(std::memory_order_relaxed);
+    if(timestamp - windowStart >= cRateLimitInterval && windowStart_.compare_exchange_strong(windowStart, timestamp, std::memory_order_relaxed))
+    {
+        windowCount_.store(0, std::memory_order_relaxed);
+    }
+
+    if(windowCount_.fetch_add(1, std::memory_order_relaxed) < cRateLimitBurst)
+    {
+        suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+uint32_t LogSite::takeSuppressed()
+{
+    if(suppressed_.load(std::memory_order_relaxed) == 0 || now() - windowStart_.load(std::memory_order_relaxed) < cRateLimitInterval)
+    {
+        return 0;
+    }
+
+    return suppressed_.exchange(0, std::memory_order_relaxed);
+}
+
+void LogSite::setThreshold(Severity severity)
+{
+    threshold_.store(static_cast<int>(severity), std::memory_order_relaxed);
+}
+
+const char* LogSite::getFile() const
+{
+    return file_;
+}
+
+int LogSite::getLine() const
+{
+    return line_;
+}
+
+const std::string& LogSite::getModule() const
+{
+    return module_;
+}
+
+int64_t LogSite::now()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+}
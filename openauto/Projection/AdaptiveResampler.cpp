@@ -0,0 +1,201 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "openauto/Projection/AdaptiveResampler.hpp"
+#include "openauto/Projection/VectorMath.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+constexpr size_t AdaptiveResampler::cTaps;
+constexpr size_t AdaptiveResampler::cPhaseBits;
+constexpr size_t AdaptiveResampler::cFractionBits;
+constexpr size_t AdaptiveResampler::cMaxChannels;
+
+AdaptiveResampler::AdaptiveResampler(uint32_t channelCount, size_t maxInputFrames)
+    : channelCount_(std::min<uint32_t>(std::max<uint32_t>(channelCount, 1), cMaxChannels))
+    , capacity_(maxInputFrames + cTaps)
+    , coefficients_(((1 << cPhaseBits) + 1) * cTaps)
+    , differences_((1 << cPhaseBits) * cTaps)
+    , interpolated_(cTaps)
+    , history_(channelCount_ * capacity_)
+    , step_(static_cast<uint64_t>(1) << cFractionBits)
+{
+    this->createFilter();
+    this->reset();
+}
+
+void AdaptiveResampler::createFilter()
+{
+    const size_t phases = 1 << cPhaseBits;
+    const double pi = std::acos(-1.0);
+    const double halfWidth = cTaps / 2.0;
+
+    for(size_t phase = 0; phase <= phases; ++phase)
+    {
+        // the output lies this far past tap cTaps / 2 - 1, a delay of whole frames at phase zero
+        const double center = cTaps / 2.0 - 1.0 + static_cast<double>(phase) / phases;
+        float* coefficients = coefficients_.data() + phase * cTaps;
+        double sum = 0.0;
+
+        for(size_t tap = 0; tap < cTaps; ++tap)
+        {
+            const double x = tap - center;
+            const double sinc = std::fabs(x) < 1e-9 ? 1.0 : std::sin(pi * x) / (pi * x);
+            const double position = std::min(1.0, std::fabs(x) / halfWidth);
+            // Blackman-Harris, zero at the ends of the filter
+            const double window = 0.35875 + 0.48829 * std::cos(pi * position) + 0.14128 * std::cos(2.0 * pi * position) + 0.01168 * std::cos(3.0 * pi * position);
+
+            coefficients[tap] = static_cast<float>(sinc * window);
+            sum += sinc * window;
+        }
+
+        for(size_t tap = 0; tap < cTaps; ++tap)
+        {
+            coefficients[tap] = static_cast<float>(coefficients[tap] / sum);
+        }
+    }
+
+    for(size_t i = 0; i < differences_.size(); ++i)
+    {
+        differences_[i] = coefficients_[i + cTaps] - coefficients_[i];
+    }
+}
+
+void AdaptiveResampler::setRatio(double ratio)
+{
+    step_ = static_cast<uint64_t>(std::llround(ratio * static_cast<double>(static_cast<uint64_t>(1) << cFractionBits)));
+}
+
+double AdaptiveResampler::getRatio() const
+{
+    return static_cast<double>(step_) / static_cast<double>(static_cast<uint64_t>(1) << cFractionBits);
+}
+
+size_t AdaptiveResampler::write(const int16_t* samples, size_t frameCount)
+{
+    if(count_ + frameCount > capacity_)
+    {
+        this->compact();
+    }
+
+    const size_t accepted = std::min(frameCount, capacity_ - count_);
+
+    for(uint32_t channel = 0; channel < channelCount_; ++channel)
+    {
+        float* history = history_.data() + channel * capacity_ + count_;
+        for(size_t frame = 0; frame < accepted; ++frame)
+        {
+            history[frame] = samples[frame * channelCount_ + channel];
+        }
+    }
+
+    count_ += accepted;
+    return accepted;
+}
+
+size_t AdaptiveResampler::read(int16_t* samples, size_t frameCount)
+{
+    const size_t outputFrames = std::min(frameCount, this->getAvailableFrames());
+    const uint64_t fractionMask = (static_cast<uint64_t>(1) << cFractionBits) - 1;
+    const size_t weightBits = cFractionBits - cPhaseBits;
+    const float weightScale = 1.0f / static_cast<float>(static_cast<uint64_t>(1) << weightBits);
+
+    for(size_t frame = 0; frame < outputFrames; ++frame)
+    {
+        const size_t phase = static_cast<size_t>(fraction_ >> weightBits);
+        const float weight = (fraction_ & ((static_cast<uint64_t>(1) << weightBits) - 1)) * weightScale;
+        const float* coefficients = coefficients_.data() + phase * cTaps;
+
+        if(weight != 0.0f)
+        {
+            std::copy(coefficients, coefficients + cTaps, interpolated_.begin());
+            VectorMath::multiplyAdd(interpolated_.data(), differences_.data() + phase * cTaps, weight, cTaps);
+            coefficients = interpolated_.data();
+        }
+
+        for(uint32_t channel = 0; channel < channelCount_; ++channel)
+        {
+            const float value = VectorMath::dot(coefficients, history_.data() + channel * capacity_ + position_, cTaps);
+            samples[frame * channelCount_ + channel] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, std::round(value))));
+        }
+
+        fraction_ += step_;
+        position_ += static_cast<size_t>(fraction_ >> cFractionBits);
+        fraction_ &= fractionMask;
+    }
+
+    return outputFrames;
+}
+
+size_t AdaptiveResampler::getAvailableFrames() const
+{
+    if(position_ + cTaps > count_)
+    {
+        return 0;
+    }
+
+    // every further frame moves the first tap by the step, it must stay within the history
+    const uint64_t room = count_ - cTaps - position_;
+    return static_cast<size_t>((((room + 1) << cFractionBits) - 1 - fraction_) / step_ + 1);
+}
+
+size_t AdaptiveResampler::getRequiredInputFrames(size_t outputFrames) const
+{
+    if(outputFrames == 0)
+    {
+        return 0;
+    }
+
+    const size_t last = position_ + static_cast<size_t>((fraction_ + (outputFrames - 1) * step_) >> cFractionBits);
+    return last + cTaps > count_ ? last + cTaps - count_ : 0;
+}
+
+void AdaptiveResampler::reset()
+{
+    // half a filter of silence in front, so the first output frame is the first input frame
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    count_ = cTaps / 2 - 1;
+    position_ = 0;
+    fraction_ = 0;
+}
+
+void AdaptiveResampler::compact()
+{
+    if(position_ > 0)
+    {
+        const size_t start = std::min(position_, count_);
+        for(uint32_t channel = 0; channel < channelCount_; ++channel)
+        {
+            float* history = history_.data() + channel * capacity_;
+            std::memmove(history, history + start, (count_ - start) * sizeof(float));
+        }
+
+        count_ -= start;
+        position_ -= start;
+    }
+}
+
+}
+}
@@ -0,0 +1,418 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifdef USE_ALSA
+
+#include <algorithm>
+#include <cerrno>
+#include <pthread.h>
+#include "openauto/Projection/AlsaAudioOutput.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+AlsaAudioOutput::AlsaAudioOutput(const std::string& deviceName, uint32_t periodSize, uint32_t periodCount, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+    : deviceName_(deviceName)
+    , periodSize_(periodSize)
+    , periodCount_(std::max<uint32_t>(periodCount, 2))
+    , channelCount_(channelCount)
+    , sampleSize_(sampleSize)
+    , sampleRate_(sampleRate)
+    , audioBuffer_(aasdk::common::cStaticDataSize, RingBufferOverflowPolicy::DROP_OLDEST, channelCount * sampleSize / 8)
+    , lastWriteSize_(0)
+    , underruns_(0)
+    , xruns_(0)
+    , shortCommits_(0)
+    , xrunRequested_(false)
+    , gainRamp_(sampleRate, channelCount)
+    , driftCompensator_(sampleRate, channelCount)
+    , pcm_(nullptr)
+    , running_(false)
+{
+
+}
+
+AlsaAudioOutput::~AlsaAudioOutput()
+{
+    this->stop();
+}
+
+bool AlsaAudioOutput::open()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(pcm_ != nullptr)
+    {
+        return true;
+    }
+
+    if(sampleSize_ != 16)
+    {
+        LOG(error) << "[AlsaAudioOutput] unsupported sample size: " << sampleSize_;
+        return false;
+    }
+
+    const int error = snd_pcm_open(&pcm_, deviceName_.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+    if(error < 0)
+    {
+        LOG(error) << "[AlsaAudioOutput] failed to open " << deviceName_ << ", what: " << snd_strerror(error);
+        pcm_ = nullptr;
+        return false;
+    }
+
+    if(!this->configure())
+    {
+        snd_pcm_close(pcm_);
+        pcm_ = nullptr;
+        return false;
+    }
+
+    audioBuffer_.clear();
+    driftCompensator_.reset();
+    return true;
+}
+
+bool AlsaAudioOutput::configure()
+{
+    auto check = [this](int error, const char* what) {
+        if(error < 0)
+        {
+            LOG(error) << "[AlsaAudioOutput] " << what << " failed on " << deviceName_ << ", what: " << snd_strerror(error);
+        }
+        return error >= 0;
+    };
+
+    snd_pcm_hw_params_t* hwParams;
+    snd_pcm_hw_params_alloca(&hwParams);
+    unsigned int deviceChannels = channelCount_;
+    unsigned int deviceRate = sampleRate_;
+    snd_pcm_uframes_t periodSize = periodSize_;
+    unsigned int periodCount = periodCount_;
+
+    // no resampling in alsa-lib, AudioResampler does it in the writer thread if the device insists on its own rate
+    if(!check(snd_pcm_hw_params_any(pcm_, hwParams), "hw_params_any")
+       || !check(snd_pcm_hw_params_set_rate_resample(pcm_, hwParams, 0), "set_rate_resample")
+       || !check(snd_pcm_hw_params_set_access(pcm_, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED), "set_access")
+       || !check(snd_pcm_hw_params_set_format(pcm_, hwParams, SND_PCM_FORMAT_S16_LE), "set_format")
+       || !check(snd_pcm_hw_params_set_channels_near(pcm_, hwParams, &deviceChannels), "set_channels")
+       || !check(snd_pcm_hw_params_set_rate_near(pcm_, hwParams, &deviceRate, nullptr), "set_rate")
+       || !check(snd_pcm_hw_params_set_period_size_near(pcm_, hwParams, &periodSize, nullptr), "set_period_size")
+       || !check(snd_pcm_hw_params_set_periods_near(pcm_, hwParams, &periodCount, nullptr), "set_periods")
+       || !check(snd_pcm_hw_params(pcm_, hwParams), "hw_params"))
+    {
+        return false;
+    }
+
+    snd_pcm_uframes_t bufferSize = 0;
+    snd_pcm_hw_params_get_period_size(hwParams, &periodSize, nullptr);
+    snd_pcm_hw_params_get_buffer_size(hwParams, &bufferSize);
+
+    // start once the whole ring is primed, then wake up for every period
+    snd_pcm_sw_params_t* swParams;
+    snd_pcm_sw_params_alloca(&swParams);
+    if(!check(snd_pcm_sw_params_current(pcm_, swParams), "sw_params_current")
+       || !check(snd_pcm_sw_params_set_start_threshold(pcm_, swParams, bufferSize), "set_start_threshold")
+       || !check(snd_pcm_sw_params_set_avail_min(pcm_, swParams, periodSize), "set_avail_min")
+       || !check(snd_pcm_sw_params(pcm_, swParams), "sw_params"))
+    {
+        return false;
+    }
+
+    periodSize_ = periodSize;
+
+    if(deviceRate != sampleRate_ || deviceChannels != channelCount_)
+    {
+        const size_t stagingFrames = static_cast<size_t>(static_cast<uint64_t>(periodSize) * sampleRate_ / deviceRate) + 2;
+        staging_.assign(stagingFrames * channelCount_, 0);
+        resampler_ = std::make_unique<AudioResampler>(sampleRate_, channelCount_, deviceRate, deviceChannels, stagingFrames);
+    }
+    else
+    {
+        resampler_.reset();
+    }
+
+    LOG(info) << "[AlsaAudioOutput] opened " << deviceName_
+              << ", rate: " << deviceRate << " Hz, channels: " << deviceChannels
+              << ", period: " << periodSize << " frames, buffer: " << bufferSize << " frames"
+              << (resampler_ != nullptr ? ", resampling" : "");
+    return true;
+}
+
+void AlsaAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    lastWriteSize_ = buffer.size;
+    audioBuffer_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+    driftCompensator_.onWrite(timestamp);
+}
+
+void AlsaAudioOutput::start()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(pcm_ != nullptr && !running_)
+    {
+        running_ = true;
+        thread_ = std::thread(&AlsaAudioOutput::run, this);
+    }
+}
+
+void AlsaAudioOutput::stop()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    this->doSuspend();
+
+    if(pcm_ != nullptr)
+    {
+        snd_pcm_close(pcm_);
+        pcm_ = nullptr;
+
+        const auto gainStatistics = gainRamp_.getStatistics();
+        LOG(info) << "[AlsaAudioOutput] stopped, underruns: " << underruns_ << ", xruns: " << xruns_ << ", short commits: " << shortCommits_
+                  << ", gain ramp avg: " << (gainStatistics.calls > 0 ? gainStatistics.totalTime / gainStatistics.calls : 0) << " ns"
+                  << ", max: " << gainStatistics.maxTime << " ns"
+                  << ", clock drift: " << driftCompensator_.getDrift() << " ppm";
+    }
+}
+
+void AlsaAudioOutput::suspend()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    this->doSuspend();
+}
+
+void AlsaAudioOutput::doSuspend()
+{
+    running_ = false;
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    if(pcm_ != nullptr)
+    {
+        // discard what is queued in the device and get ready for the next start
+        snd_pcm_drop(pcm_);
+        snd_pcm_prepare(pcm_);
+    }
+}
+
+void AlsaAudioOutput::flush()
+{
+    audioBuffer_.clear();
+}
+
+void AlsaAudioOutput::setGain(float gain)
+{
+    gainRamp_.setTarget(gain);
+}
+
+void AlsaAudioOutput::setPlaybackObserver(PlaybackObserver observer)
+{
+    playbackObserver_ = std::move(observer);
+}
+
+uint32_t AlsaAudioOutput::getSampleSize() const
+{
+    return sampleSize_;
+}
+
+uint32_t AlsaAudioOutput::getChannelCount() const
+{
+    return channelCount_;
+}
+
+uint32_t AlsaAudioOutput::getSampleRate() const
+{
+    return sampleRate_;
+}
+
+bool AlsaAudioOutput::isBackpressured() const
+{
+    return audioBuffer_.getFreeSpace() < lastWriteSize_;
+}
+
+size_t AlsaAudioOutput::getBufferedBytes() const
+{
+    return audioBuffer_.getFillLevel();
+}
+
+uint64_t AlsaAudioOutput::getUnderrunCount() const
+{
+    return underruns_;
+}
+
+uint64_t AlsaAudioOutput::getLateCallbackCount() const
+{
+    // an xrun is the device running dry because the writer thread came too late
+    return xruns_;
+}
+
+double AlsaAudioOutput::getClockDrift() const
+{
+    return driftCompensator_.getDrift();
+}
+
+uint64_t AlsaAudioOutput::getShortCommitCount() const
+{
+    return shortCommits_;
+}
+
+void AlsaAudioOutput::injectXrun()
+{
+    xrunRequested_ = true;
+}
+
+void AlsaAudioOutput::run()
+{
+    sched_param parameters;
+    parameters.sched_priority = sched_get_priority_max(SCHED_FIFO) / 2;
+    if(pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) != 0)
+    {
+        LOG(warning) << "[AlsaAudioOutput] no real-time priority for the writer thread, xruns are more likely";
+    }
+
+    while(running_)
+    {
+        if(xrunRequested_.exchange(false) && !this->recover(-EPIPE))
+        {
+            break;
+        }
+
+        const snd_pcm_sframes_t available = snd_pcm_avail_update(pcm_);
+        if(available < 0)
+        {
+            if(!this->recover(static_cast<int>(available)))
+            {
+                break;
+            }
+            continue;
+        }
+
+        if(static_cast<snd_pcm_uframes_t>(available) < periodSize_)
+        {
+            // bounded wait so a suspend is noticed even when the device stalls
+            const int error = snd_pcm_wait(pcm_, 100);
+            if(error < 0 && !this->recover(error))
+            {
+                break;
+            }
+            continue;
+        }
+
+        const snd_pcm_channel_area_t* areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t frames = periodSize_;
+        int error = snd_pcm_mmap_begin(pcm_, &areas, &offset, &frames);
+        if(error < 0)
+        {
+            if(!this->recover(error))
+            {
+                break;
+            }
+            continue;
+        }
+
+        // interleaved access, the first area covers every channel of the frame
+        auto samples = reinterpret_cast<int16_t*>(static_cast<char*>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8);
+        this->fill(samples, frames);
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcm_, offset, frames);
+        if(committed < 0)
+        {
+            if(!this->recover(static_cast<int>(committed)))
+            {
+                break;
+            }
+        }
+        else if(static_cast<snd_pcm_uframes_t>(committed) != frames)
+        {
+            // not an xrun, the device took fewer frames than it handed out and the rest is filled again
+            ++shortCommits_;
+            LOG(warning) << "[AlsaAudioOutput] short commit on " << deviceName_ << ", " << committed << " of " << frames << " frames";
+        }
+    }
+}
+
+bool AlsaAudioOutput::recover(int error)
+{
+    if(error == -EPIPE || error == -ESTRPIPE)
+    {
+        ++xruns_;
+    }
+
+    // re-prepares after an xrun and resumes after a system suspend
+    error = snd_pcm_recover(pcm_, error, 1);
+    if(error < 0)
+    {
+        LOG(error) << "[AlsaAudioOutput] unrecoverable error on " << deviceName_ << ", what: " << snd_strerror(error);
+        return false;
+    }
+
+    return true;
+}
+
+void AlsaAudioOutput::fill(int16_t* samples, size_t frameCount)
+{
+    if(resampler_ == nullptr)
+    {
+        this->read(samples, frameCount);
+        gainRamp_.apply(samples, frameCount);
+        this->notifyPlayback(samples, frameCount);
+        return;
+    }
+
+    const size_t streamFrames = std::min(resampler_->getRequiredInputFrames(frameCount), staging_.size() / channelCount_);
+    this->read(staging_.data(), streamFrames);
+    gainRamp_.apply(staging_.data(), streamFrames);
+    this->notifyPlayback(staging_.data(), streamFrames);
+    resampler_->write(staging_.data(), streamFrames);
+
+    const size_t deviceChannels = resampler_->getOutputChannels();
+    const size_t resampledFrames = resampler_->read(samples, frameCount);
+    std::fill(samples + resampledFrames * deviceChannels, samples + frameCount * deviceChannels, 0);
+}
+
+void AlsaAudioOutput::notifyPlayback(const int16_t* samples, size_t frameCount)
+{
+    if(playbackObserver_)
+    {
+        playbackObserver_(reinterpret_cast<const char*>(samples), frameCount * channelCount_ * sizeof(int16_t), sampleRate_, channelCount_);
+    }
+}
+
+void AlsaAudioOutput::read(int16_t* samples, size_t frameCount)
+{
+    const size_t readFrames = driftCompensator_.read(audioBuffer_, samples, frameCount);
+
+    if(readFrames < frameCount)
+    {
+        ++underruns_;
+        std::fill(samples + readFrames * channelCount_, samples + frameCount * channelCount_, 0);
+    }
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,343 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include "openauto/Projection/AudioInputProcessor.hpp"
+#include "openauto/Projection/VectorMath.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+constexpr std::chrono::milliseconds AudioInputProcessor::cFrameDuration;
+constexpr std::chrono::milliseconds AudioInputProcessor::cEchoTail;
+constexpr std::chrono::microseconds AudioInputProcessor::cFrameBudget;
+constexpr float AudioInputProcessor::cStepSize;
+constexpr float AudioInputProcessor::cDoubleTalkThreshold;
+constexpr size_t AudioInputProcessor::cDoubleTalkHoldFrames;
+constexpr size_t AudioInputProcessor::cNoiseLearningFrames;
+constexpr float AudioInputProcessor::cNoiseRise;
+constexpr float AudioInputProcessor::cMinGain;
+
+AudioInputProcessor::AudioInputProcessor(uint32_t sampleRate, EchoReference::Pointer echoReference)
+    : sampleRate_(sampleRate)
+    , echoReference_(std::move(echoReference))
+    , echoCancellation_(false)
+    , noiseSuppression_(false)
+    , frameSize_(sampleRate * cFrameDuration.count() / 1000)
+    , position_(0)
+    , input_(frameSize_, 0.0f)
+    , output_(frameSize_, 0.0f)
+    , taps_((sampleRate * cEchoTail.count() / 1000 + 3) / 4 * 4)
+    , weights_(taps_, 0.0f)
+    , farEnd_(taps_ - 1 + frameSize_, 0.0f)
+    , doubleTalkHold_(0)
+    , fftSize_(1)
+    , analysis_(2 * frameSize_, 0.0f)
+    , overlap_(frameSize_, 0.0f)
+    , noiseFrames_(0)
+{
+    const double pi = std::acos(-1.0);
+    const size_t windowSize = 2 * frameSize_;
+
+    while(fftSize_ < windowSize)
+    {
+        fftSize_ <<= 1;
+    }
+
+    // square root of a periodic Hann, applied before and after the FFT the overlapped halves sum to one
+    window_.resize(windowSize);
+    for(size_t i = 0; i < windowSize; ++i)
+    {
+        window_[i] = static_cast<float>(std::sqrt(0.5 - 0.5 * std::cos(2.0 * pi * i / windowSize)));
+    }
+
+    real_.resize(fftSize_);
+    imaginary_.resize(fftSize_);
+    cosines_.resize(fftSize_ / 2);
+    sines_.resize(fftSize_ / 2);
+    for(size_t i = 0; i < fftSize_ / 2; ++i)
+    {
+        cosines_[i] = static_cast<float>(std::cos(2.0 * pi * i / fftSize_));
+        sines_[i] = static_cast<float>(-std::sin(2.0 * pi * i / fftSize_));
+    }
+
+    bitReversal_.resize(fftSize_);
+    for(size_t i = 0; i < fftSize_; ++i)
+    {
+        size_t reversed = 0;
+        for(size_t bit = 1, mirror = fftSize_ >> 1; bit < fftSize_; bit <<= 1, mirror >>= 1)
+        {
+            reversed |= (i & bit) != 0 ? mirror : 0;
+        }
+        bitReversal_[i] = reversed;
+    }
+
+    const size_t bins = fftSize_ / 2 + 1;
+    smoothedPower_.resize(bins, 0.0f);
+    noisePower_.resize(bins, 0.0f);
+    previousSnr_.resize(bins, 0.0f);
+}
+
+void AudioInputProcessor::setEchoCancellation(bool enabled)
+{
+    echoCancellation_ = enabled && echoReference_ != nullptr;
+}
+
+void AudioInputProcessor::setNoiseSuppression(bool enabled)
+{
+    noiseSuppression_ = enabled;
+}
+
+bool AudioInputProcessor::isEnabled() const
+{
+    return echoCancellation_ || noiseSuppression_;
+}
+
+void AudioInputProcessor::process(int16_t* samples, size_t frameCount)
+{
+    for(size_t i = 0; i < frameCount; ++i)
+    {
+        input_[position_] = samples[i];
+        samples[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, std::round(output_[position_]))));
+
+        if(++position_ == frameSize_)
+        {
+            this->processFrame();
+            position_ = 0;
+        }
+    }
+}
+
+size_t AudioInputProcessor::getLatencyFrames() const
+{
+    // the overlap-add finishes a frame only once the next one arrived
+    return noiseSuppression_ ? 2 * frameSize_ : frameSize_;
+}
+
+void AudioInputProcessor::reset()
+{
+    position_ = 0;
+    doubleTalkHold_ = 0;
+    noiseFrames_ = 0;
+    std::fill(input_.begin(), input_.end(), 0.0f);
+    std::fill(output_.begin(), output_.end(), 0.0f);
+    std::fill(weights_.begin(), weights_.end(), 0.0f);
+    std::fill(farEnd_.begin(), farEnd_.end(), 0.0f);
+    std::fill(analysis_.begin(), analysis_.end(), 0.0f);
+    std::fill(overlap_.begin(), overlap_.end(), 0.0f);
+    std::fill(previousSnr_.begin(), previousSnr_.end(), 0.0f);
+
+    if(echoReference_ != nullptr)
+    {
+        echoReference_->clear();
+    }
+}
+
+AudioInputProcessorStatistics AudioInputProcessor::getStatistics() const
+{
+    return statistics_;
+}
+
+void AudioInputProcessor::processFrame()
+{
+    const auto started = Clock::now();
+
+    // the far end is consumed even while the canceller is off, so it stays in step with the capture
+    if(echoReference_ != nullptr)
+    {
+        std::copy(farEnd_.end() - (taps_ - 1), farEnd_.end(), farEnd_.begin());
+        echoReference_->read(farEnd_.data() + taps_ - 1, frameSize_);
+    }
+
+    std::copy(input_.begin(), input_.end(), output_.begin());
+
+    if(echoCancellation_)
+    {
+        this->cancelEcho(output_.data());
+    }
+
+    if(noiseSuppression_)
+    {
+        this->suppressNoise(output_.data());
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started);
+    ++statistics_.frames;
+    statistics_.totalTime += elapsed.count();
+    statistics_.maxTime = std::max<uint64_t>(statistics_.maxTime, elapsed.count());
+    statistics_.overBudgetFrames += elapsed > cFrameBudget ? 1 : 0;
+}
+
+void AudioInputProcessor::cancelEcho(float* frame)
+{
+    // Geigel detector: a near end peak above what the echo of the far end could reach is talk
+    float farPeak = 0.0f;
+    float nearPeak = 0.0f;
+    for(auto sample : farEnd_)
+    {
+        farPeak = std::max(farPeak, std::fabs(sample));
+    }
+    for(size_t i = 0; i < frameSize_; ++i)
+    {
+        nearPeak = std::max(nearPeak, std::fabs(frame[i]));
+    }
+
+    if(nearPeak > cDoubleTalkThreshold * farPeak)
+    {
+        doubleTalkHold_ = cDoubleTalkHoldFrames;
+    }
+    else if(doubleTalkHold_ > 0)
+    {
+        --doubleTalkHold_;
+    }
+
+    // the regularization keeps the step bounded when the far end is close to silent
+    const bool adapt = doubleTalkHold_ == 0;
+    const float regularization = taps_ * 1000.0f;
+    float energy = VectorMath::dot(farEnd_.data(), farEnd_.data(), taps_);
+
+    for(size_t n = 0; n < frameSize_; ++n)
+    {
+        const float* window = farEnd_.data() + n;
+        if(n > 0)
+        {
+            energy = std::max(0.0f, energy + window[taps_ - 1] * window[taps_ - 1] - window[-1] * window[-1]);
+        }
+
+        const float error = frame[n] - VectorMath::dot(weights_.data(), window, taps_);
+        frame[n] = error;
+
+        if(adapt)
+        {
+            VectorMath::multiplyAdd(weights_.data(), window, cStepSize * error / (energy + regularization), taps_);
+        }
+    }
+}
+
+void AudioInputProcessor::suppressNoise(float* frame)
+{
+    const size_t bins = fftSize_ / 2 + 1;
+    const size_t windowSize = 2 * frameSize_;
+
+    std::copy(analysis_.begin() + frameSize_, analysis_.end(), analysis_.begin());
+    std::copy(frame, frame + frameSize_, analysis_.begin() + frameSize_);
+
+    for(size_t i = 0; i < windowSize; ++i)
+    {
+        real_[i] = analysis_[i] * window_[i];
+    }
+    std::fill(real_.begin() + windowSize, real_.end(), 0.0f);
+    std::fill(imaginary_.begin(), imaginary_.end(), 0.0f);
+
+    this->transform(false);
+
+    for(size_t k = 0; k < bins; ++k)
+    {
+        const float power = real_[k] * real_[k] + imaginary_[k] * imaginary_[k];
+
+        if(noiseFrames_ < cNoiseLearningFrames)
+        {
+            // assume the first frames are noise, the minimum tracking would take seconds to get there
+            smoothedPower_[k] = noiseFrames_ == 0 ? power : 0.7f * smoothedPower_[k] + 0.3f * power;
+            noisePower_[k] += (power - noisePower_[k]) / (noiseFrames_ + 1);
+        }
+        else
+        {
+            smoothedPower_[k] = 0.7f * smoothedPower_[k] + 0.3f * power;
+            noisePower_[k] = std::min(smoothedPower_[k], noisePower_[k] * cNoiseRise);
+        }
+
+        // decision directed a priori SNR, it keeps the gain from fluctuating into musical noise
+        const float posteriorSnr = power / std::max(noisePower_[k], 1e-3f);
+        const float prioriSnr = 0.98f * previousSnr_[k] + 0.02f * std::max(posteriorSnr - 1.0f, 0.0f);
+        const float gain = std::max(prioriSnr / (1.0f + prioriSnr), cMinGain);
+        previousSnr_[k] = gain * gain * posteriorSnr;
+
+        real_[k] *= gain;
+        imaginary_[k] *= gain;
+        if(k > 0 && k < fftSize_ / 2)
+        {
+            real_[fftSize_ - k] *= gain;
+            imaginary_[fftSize_ - k] *= gain;
+        }
+    }
+
+    noiseFrames_ = std::min(noiseFrames_ + 1, cNoiseLearningFrames);
+    this->transform(true);
+
+    for(size_t i = 0; i < frameSize_; ++i)
+    {
+        frame[i] = overlap_[i] + real_[i] * window_[i];
+        overlap_[i] = real_[frameSize_ + i] * window_[frameSize_ + i];
+    }
+}
+
+void AudioInputProcessor::transform(bool inverse)
+{
+    for(size_t i = 0; i < fftSize_; ++i)
+    {
+        const size_t j = bitReversal_[i];
+        if(i < j)
+        {
+            std::swap(real_[i], real_[j]);
+            std::swap(imaginary_[i], imaginary_[j]);
+        }
+    }
+
+    const float direction = inverse ? -1.0f : 1.0f;
+    for(size_t length = 2; length <= fftSize_; length <<= 1)
+    {
+        const size_t half = length / 2;
+        const size_t stride = fftSize_ / length;
+
+        for(size_t start = 0; start < fftSize_; start += length)
+        {
+            for(size_t k = 0; k < half; ++k)
+            {
+                const float cosine = cosines_[k * stride];
+                const float sine = direction * sines_[k * stride];
+                const size_t even = start + k;
+                const size_t odd = even + half;
+                const float oddReal = real_[odd] * cosine - imaginary_[odd] * sine;
+                const float oddImaginary = real_[odd] * sine + imaginary_[odd] * cosine;
+
+                real_[odd] = real_[even] - oddReal;
+                imaginary_[odd] = imaginary_[even] - oddImaginary;
+                real_[even] += oddReal;
+                imaginary_[even] += oddImaginary;
+            }
+        }
+    }
+
+    if(inverse)
+    {
+        const float scale = 1.0f / fftSize_;
+        for(size_t i = 0; i < fftSize_; ++i)
+        {
+            real_[i] *= scale;
+            imaginary_[i] *= scale;
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,218 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <thread>
+#include "openauto/Projection/AudioMixer.hpp"
+#include "openauto/Projection/AudioMixerInput.hpp"
+#include "openauto/Projection/VectorMath.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+constexpr uint32_t AudioMixer::cPeriodFrames;
+
+AudioMixer::AudioMixer()
+    : users_(0)
+    , mixing_(false)
+    , mixBuffer_(cPeriodFrames * cChannelCount)
+    , lateCallbacks_(0)
+{
+    for(auto& input : inputs_)
+    {
+        input = nullptr;
+    }
+
+    std::vector<RtAudio::Api> apis;
+    RtAudio::getCompiledApi(apis);
+    dac_ = std::find(apis.begin(), apis.end(), RtAudio::LINUX_PULSE) == apis.end() ? std::make_unique<RtAudio>() : std::make_unique<RtAudio>(RtAudio::LINUX_PULSE);
+}
+
+AudioMixer::~AudioMixer()
+{
+    if(dac_->isStreamOpen())
+    {
+        try
+        {
+            if(dac_->isStreamRunning())
+            {
+                dac_->stopStream();
+            }
+        }
+        catch(const RtAudioError& e)
+        {
+            LOG(error) << "[AudioMixer] failed to stop the stream, what: " << e.what();
+        }
+
+        dac_->closeStream();
+    }
+}
+
+std::shared_ptr<AudioMixerInput> AudioMixer::createInput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+{
+    if(channelCount == 0 || channelCount > cChannelCount || sampleSize != 16)
+    {
+        LOG(error) << "[AudioMixer] unsupported input format, channels: " << channelCount << ", sample size: " << sampleSize;
+        return nullptr;
+    }
+
+    auto input = std::make_shared<AudioMixerInput>(this->shared_from_this(), channelCount, sampleSize, sampleRate);
+    for(auto& slot : inputs_)
+    {
+        AudioMixerInput* expected = nullptr;
+        if(slot.compare_exchange_strong(expected, input.get()))
+        {
+            return input;
+        }
+    }
+
+    LOG(error) << "[AudioMixer] all " << cMaxInputs << " inputs are in use.";
+    return nullptr;
+}
+
+uint64_t AudioMixer::getLateCallbackCount() const
+{
+    return lateCallbacks_;
+}
+
+bool AudioMixer::acquire()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(users_ == 0)
+    {
+        if(dac_->getDeviceCount() == 0)
+        {
+            LOG(error) << "No output devices found.";
+            return false;
+        }
+
+        RtAudio::StreamParameters parameters;
+        parameters.deviceId = dac_->getDefaultOutputDevice();
+        parameters.nChannels = cChannelCount;
+        parameters.firstChannel = 0;
+
+        try
+        {
+            RtAudio::StreamOptions streamOptions;
+            streamOptions.flags = RTAUDIO_MINIMIZE_LATENCY | RTAUDIO_SCHEDULE_REALTIME;
+            uint32_t bufferFrames = cPeriodFrames;
+            dac_->openStream(&parameters, nullptr, RTAUDIO_SINT16, cSampleRate, &bufferFrames, &AudioMixer::audioBufferReadHandler, static_cast<void*>(this), &streamOptions);
+            dac_->startStream();
+            LOG(info) << "[AudioMixer] stream started, period: " << bufferFrames << " frames";
+        }
+        catch(const RtAudioError& e)
+        {
+            LOG(error) << "Failed to open audio output, what: " << e.what();
+            if(dac_->isStreamOpen())
+            {
+                dac_->closeStream();
+            }
+            return false;
+        }
+    }
+
+    ++users_;
+    return true;
+}
+
+void AudioMixer::release()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(users_ == 0 || --users_ > 0 || !dac_->isStreamOpen())
+    {
+        return;
+    }
+
+    try
+    {
+        dac_->stopStream();
+    }
+    catch(const RtAudioError& e)
+    {
+        LOG(error) << "Failed to suspend audio output, what: " << e.what();
+    }
+
+    dac_->closeStream();
+    LOG(info) << "[AudioMixer] stream stopped, late callbacks: " << lateCallbacks_;
+}
+
+void AudioMixer::removeInput(AudioMixerInput* input)
+{
+    for(auto& slot : inputs_)
+    {
+        AudioMixerInput* expected = input;
+        slot.compare_exchange_strong(expected, nullptr);
+    }
+
+    // a callback that picked up the input before it was removed may still be mixing it
+    while(mixing_)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void AudioMixer::mix(int16_t* output, size_t frameCount)
+{
+    float* mix = mixBuffer_.data();
+    const size_t sampleCount = frameCount * cChannelCount;
+    std::fill(mix, mix + sampleCount, 0.0f);
+
+    for(auto& slot : inputs_)
+    {
+        auto input = slot.load();
+        if(input != nullptr && input->active_)
+        {
+            input->mixInto(mix, frameCount);
+        }
+    }
+
+    VectorMath::convert(output, mix, 32768.0f, sampleCount);
+}
+
+int AudioMixer::audioBufferReadHandler(void* outputBuffer, void*, unsigned int nBufferFrames,
+                                       double, RtAudioStreamStatus status, void* userData)
+{
+    // runs on the real-time audio thread: no locks, no allocations, nothing that may block
+    AudioMixer* self = static_cast<AudioMixer*>(userData);
+
+    if(status & RTAUDIO_OUTPUT_UNDERFLOW)
+    {
+        ++self->lateCallbacks_;
+    }
+
+    self->mixing_ = true;
+
+    auto output = static_cast<int16_t*>(outputBuffer);
+    for(size_t offset = 0; offset < nBufferFrames; offset += cPeriodFrames)
+    {
+        const size_t frameCount = std::min<size_t>(cPeriodFrames, nBufferFrames - offset);
+        self->mix(output + offset * cChannelCount, frameCount);
+    }
+
+    self->mixing_ = false;
+    return 0;
+}
+
+}
+}
@@ -0,0 +1,210 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include "openauto/Projection/AudioMixerInput.hpp"
+#include "openauto/Projection/VectorMath.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+AudioMixerInput::AudioMixerInput(AudioMixer::Pointer mixer, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+    : mixer_(std::move(mixer))
+    , channelCount_(channelCount)
+    , sampleSize_(sampleSize)
+    , sampleRate_(sampleRate)
+    , audioBuffer_(aasdk::common::cStaticDataSize, RingBufferOverflowPolicy::DROP_OLDEST, channelCount * sampleSize / 8)
+    , lastWriteSize_(0)
+    , opened_(false)
+    , active_(false)
+    , underruns_(0)
+    , staging_(std::max<size_t>(AudioMixer::cPeriodFrames * sampleRate / AudioMixer::cSampleRate + 2, AudioMixer::cPeriodFrames) * std::max<uint32_t>(channelCount, AudioMixer::cChannelCount))
+    , converted_(AudioMixer::cPeriodFrames * AudioMixer::cChannelCount)
+    , gainRamp_(AudioMixer::cSampleRate, AudioMixer::cChannelCount)
+    , resampler_(sampleRate, channelCount, AudioMixer::cSampleRate, AudioMixer::cChannelCount, staging_.size() / std::max<uint32_t>(channelCount, 1))
+    , driftCompensator_(sampleRate, channelCount)
+{
+
+}
+
+AudioMixerInput::~AudioMixerInput()
+{
+    this->stop();
+    mixer_->removeInput(this);
+}
+
+bool AudioMixerInput::open()
+{
+    if(!opened_)
+    {
+        // inactive until start, the mixer callback does not touch it meanwhile
+        driftCompensator_.reset();
+        opened_ = mixer_->acquire();
+    }
+
+    return opened_;
+}
+
+void AudioMixerInput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    lastWriteSize_ = buffer.size;
+    audioBuffer_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+    driftCompensator_.onWrite(timestamp);
+}
+
+void AudioMixerInput::start()
+{
+    active_ = true;
+}
+
+void AudioMixerInput::stop()
+{
+    active_ = false;
+
+    if(opened_)
+    {
+        const auto gainStatistics = gainRamp_.getStatistics();
+        LOG(info) << "[AudioMixerInput] stopped, underruns: " << underruns_
+                  << ", gain ramp avg: " << (gainStatistics.calls > 0 ? gainStatistics.totalTime / gainStatistics.calls : 0) << " ns"
+                  << ", max: " << gainStatistics.maxTime << " ns"
+                  << ", clock drift: " << driftCompensator_.getDrift() << " ppm";
+        mixer_->release();
+        opened_ = false;
+    }
+}
+
+void AudioMixerInput::suspend()
+{
+    active_ = false;
+}
+
+void AudioMixerInput::flush()
+{
+    audioBuffer_.clear();
+}
+
+uint32_t AudioMixerInput::getSampleSize() const
+{
+    return sampleSize_;
+}
+
+uint32_t AudioMixerInput::getChannelCount() const
+{
+    return channelCount_;
+}
+
+uint32_t AudioMixerInput::getSampleRate() const
+{
+    return sampleRate_;
+}
+
+bool AudioMixerInput::isBackpressured() const
+{
+    return audioBuffer_.getFreeSpace() < lastWriteSize_;
+}
+
+size_t AudioMixerInput::getBufferedBytes() const
+{
+    return audioBuffer_.getFillLevel();
+}
+
+uint64_t AudioMixerInput::getUnderrunCount() const
+{
+    return underruns_;
+}
+
+uint64_t AudioMixerInput::getLateCallbackCount() const
+{
+    return mixer_->getLateCallbackCount();
+}
+
+double AudioMixerInput::getClockDrift() const
+{
+    return driftCompensator_.getDrift();
+}
+
+void AudioMixerInput::setGain(float gain)
+{
+    gainRamp_.setTarget(gain);
+}
+
+void AudioMixerInput::setPlaybackObserver(PlaybackObserver observer)
+{
+    playbackObserver_ = std::move(observer);
+}
+
+float AudioMixerInput::getGain() const
+{
+    return gainRamp_.getTarget();
+}
+
+void AudioMixerInput::mixInto(float* mix, size_t frameCount)
+{
+    const size_t convertedFrames = this->convert(frameCount);
+    gainRamp_.mixInto(mix, converted_.data(), convertedFrames);
+
+    if(convertedFrames < frameCount)
+    {
+        ++underruns_;
+    }
+}
+
+void AudioMixerInput::notifyPlayback(size_t frameCount)
+{
+    // what the mixer took from this input, before gain and conversion
+    if(playbackObserver_)
+    {
+        playbackObserver_(reinterpret_cast<const char*>(staging_.data()), frameCount * channelCount_ * sizeof(int16_t), sampleRate_, channelCount_);
+    }
+}
+
+size_t AudioMixerInput::convert(size_t frameCount)
+{
+    const float scale = 1.0f / 32768.0f;
+    float* converted = converted_.data();
+
+    if(sampleRate_ == AudioMixer::cSampleRate && channelCount_ == AudioMixer::cChannelCount)
+    {
+        // the mixer format already, convert without touching individual frames
+        const size_t readCount = driftCompensator_.read(audioBuffer_, staging_.data(), frameCount) * AudioMixer::cChannelCount;
+        const int16_t* samples = staging_.data();
+        this->notifyPlayback(readCount / AudioMixer::cChannelCount);
+
+        VectorMath::convert(converted, samples, scale, readCount);
+
+        return readCount / AudioMixer::cChannelCount;
+    }
+
+    // pull exactly what the resampler needs for this period, mono is spread over both sides
+    const size_t wantedFrames = std::min(resampler_.getRequiredInputFrames(frameCount), staging_.size() / channelCount_);
+    const size_t readFrames = driftCompensator_.read(audioBuffer_, staging_.data(), wantedFrames);
+    this->notifyPlayback(readFrames);
+    resampler_.write(staging_.data(), readFrames);
+
+    const size_t convertedFrames = resampler_.read(converted, frameCount);
+    VectorMath::scale(converted, scale, convertedFrames * AudioMixer::cChannelCount);
+
+    return convertedFrames;
+}
+
+}
+}
@@ -0,0 +1,292 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include "openauto/Projection/AudioResampler.hpp"
+#include "openauto/Projection/VectorMath.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+namespace
+{
+
+constexpr size_t cMaxChannels = 8;
+
+uint64_t greatestCommonDivisor(uint64_t a, uint64_t b)
+{
+    while(b != 0)
+    {
+        const auto remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
+
+// zeroth order modified Bessel function of the first kind, for the Kaiser window
+double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for(int k = 1; k < 50 && term > sum * 1e-12; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+inline void store(float value, float& sample)
+{
+    sample = value;
+}
+
+inline void store(float value, int16_t& sample)
+{
+    value = std::min(std::max(value, -32768.0f), 32767.0f);
+    sample = static_cast<int16_t>(value < 0 ? value - 0.5f : value + 0.5f);
+}
+
+}
+
+constexpr size_t AudioResampler::cBaseTaps;
+constexpr double AudioResampler::cCutoff;
+constexpr double AudioResampler::cKaiserBeta;
+
+AudioResampler::AudioResampler(uint32_t inputRate, uint32_t inputChannels, uint32_t outputRate, uint32_t outputChannels, size_t maxInputFrames)
+    : inputRate_(inputRate)
+    , inputChannels_(std::max<uint32_t>(inputChannels, 1))
+    , outputRate_(outputRate)
+    , outputChannels_(std::max<uint32_t>(outputChannels, 1))
+    , filterChannels_(inputChannels_ == 1 || outputChannels_ == 1 ? 1 : std::min<uint32_t>(std::min(inputChannels_, outputChannels_), cMaxChannels))
+    , interpolation_(outputRate / greatestCommonDivisor(inputRate, outputRate))
+    , decimation_(inputRate / greatestCommonDivisor(inputRate, outputRate))
+    , taps_(inputRate == outputRate ? 1 : cBaseTaps * ((inputRate + outputRate - 1) / outputRate))
+    , capacity_(maxInputFrames + taps_ + decimation_ / interpolation_ + 1)
+    , history_(filterChannels_ * capacity_)
+    , count_(0)
+    , position_(0)
+    , phase_(0)
+{
+    this->createFilter();
+    this->reset();
+}
+
+void AudioResampler::createFilter()
+{
+    coefficients_.assign(interpolation_ * taps_, 0.0f);
+
+    if(taps_ == 1)
+    {
+        coefficients_[0] = 1.0f;
+        return;
+    }
+
+    // prototype low pass at the interpolated rate, cut off below the lower of both Nyquist frequencies
+    const size_t length = interpolation_ * taps_;
+    const double center = (length - 1) / 2.0;
+    const double cutoff = cCutoff * 0.5 * std::min(inputRate_, outputRate_) / (static_cast<double>(interpolation_) * inputRate_);
+    const double windowScale = 1.0 / besselI0(cKaiserBeta);
+    const double pi = std::acos(-1.0);
+
+    for(uint64_t phase = 0; phase < interpolation_; ++phase)
+    {
+        float* coefficients = coefficients_.data() + phase * taps_;
+        double sum = 0.0;
+
+        for(size_t tap = 0; tap < taps_; ++tap)
+        {
+            const double index = static_cast<double>(tap * interpolation_ + phase);
+            const double x = index - center;
+            const double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * x) / (pi * x);
+            const double position = 2.0 * index / (length - 1) - 1.0;
+            const double window = besselI0(cKaiserBeta * std::sqrt(std::max(0.0, 1.0 - position * position))) * windowScale;
+
+            // stored back to front so each output is a forward dot product over the history
+            coefficients[taps_ - 1 - tap] = static_cast<float>(sinc * window);
+            sum += sinc * window;
+        }
+
+        // unity gain at DC in every phase, otherwise the phases modulate a constant signal
+        for(size_t tap = 0; tap < taps_; ++tap)
+        {
+            coefficients[tap] = static_cast<float>(coefficients[tap] / sum);
+        }
+    }
+}
+
+size_t AudioResampler::write(const int16_t* samples, size_t frameCount)
+{
+    if(count_ + frameCount > capacity_)
+    {
+        this->compact();
+    }
+
+    const size_t accepted = std::min(frameCount, capacity_ - count_);
+
+    if(filterChannels_ == 1 && inputChannels_ > 1)
+    {
+        const float scale = 1.0f / inputChannels_;
+        float* history = history_.data() + count_;
+        for(size_t frame = 0; frame < accepted; ++frame)
+        {
+            int32_t sum = 0;
+            for(uint32_t channel = 0; channel < inputChannels_; ++channel)
+            {
+                sum += samples[frame * inputChannels_ + channel];
+            }
+            history[frame] = sum * scale;
+        }
+    }
+    else
+    {
+        for(uint32_t channel = 0; channel < filterChannels_; ++channel)
+        {
+            float* history = history_.data() + channel * capacity_ + count_;
+            for(size_t frame = 0; frame < accepted; ++frame)
+            {
+                history[frame] = samples[frame * inputChannels_ + channel];
+            }
+        }
+    }
+
+    count_ += accepted;
+    return accepted;
+}
+
+size_t AudioResampler::read(int16_t* samples, size_t frameCount)
+{
+    return this->process(samples, frameCount);
+}
+
+size_t AudioResampler::read(float* samples, size_t frameCount)
+{
+    return this->process(samples, frameCount);
+}
+
+template<typename SampleType>
+size_t AudioResampler::process(SampleType* samples, size_t frameCount)
+{
+    const size_t outputFrames = std::min(frameCount, this->getAvailableFrames());
+    std::array<float, cMaxChannels> values;
+
+    for(size_t frame = 0; frame < outputFrames; ++frame)
+    {
+        const float* coefficients = coefficients_.data() + phase_ * taps_;
+        const size_t first = position_ + 1 - taps_;
+
+        for(uint32_t channel = 0; channel < filterChannels_; ++channel)
+        {
+            values[channel] = VectorMath::dot(coefficients, history_.data() + channel * capacity_ + first, taps_);
+        }
+
+        SampleType* output = samples + frame * outputChannels_;
+        for(uint32_t channel = 0; channel < outputChannels_; ++channel)
+        {
+            // mono is spread over every output channel, surplus channels of a wider device stay silent
+            store(filterChannels_ == 1 ? values[0] : (channel < filterChannels_ ? values[channel] : 0.0f), output[channel]);
+        }
+
+        phase_ += decimation_;
+        position_ += phase_ / interpolation_;
+        phase_ %= interpolation_;
+    }
+
+    return outputFrames;
+}
+
+size_t AudioResampler::getAvailableFrames() const
+{
+    if(position_ >= count_)
+    {
+        return 0;
+    }
+
+    return ((count_ - 1 - position_) * interpolation_ + interpolation_ - 1 - phase_) / decimation_ + 1;
+}
+
+size_t AudioResampler::getRequiredInputFrames(size_t outputFrames) const
+{
+    if(outputFrames == 0)
+    {
+        return 0;
+    }
+
+    const size_t last = position_ + (phase_ + (outputFrames - 1) * decimation_) / interpolation_;
+    return last + 1 > count_ ? last + 1 - count_ : 0;
+}
+
+void AudioResampler::reset()
+{
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    count_ = taps_ - 1;
+    position_ = taps_ - 1;
+    phase_ = 0;
+}
+
+void AudioResampler::compact()
+{
+    const size_t start = std::min(position_ + 1 - taps_, count_);
+
+    if(start > 0)
+    {
+        for(uint32_t channel = 0; channel < filterChannels_; ++channel)
+        {
+            float* history = history_.data() + channel * capacity_;
+            std::memmove(history, history + start, (count_ - start) * sizeof(float));
+        }
+
+        count_ -= start;
+        position_ -= start;
+    }
+}
+
+uint32_t AudioResampler::getInputRate() const
+{
+    return inputRate_;
+}
+
+uint32_t AudioResampler::getInputChannels() const
+{
+    return inputChannels_;
+}
+
+uint32_t AudioResampler::getOutputRate() const
+{
+    return outputRate_;
+}
+
+uint32_t AudioResampler::getOutputChannels() const
+{
+    return outputChannels_;
+}
+
+size_t AudioResampler::getTapCount() const
+{
+    return taps_;
+}
+
+}
+}
@@ -0,0 +1,271 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include "openauto/Projection/ClockDriftCompensator.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+constexpr double ClockDriftCompensator::cMaxCorrection;
+constexpr std::chrono::seconds ClockDriftCompensator::cWindow;
+constexpr std::chrono::seconds ClockDriftCompensator::cMinSpan;
+constexpr std::chrono::seconds ClockDriftCompensator::cMaxGap;
+constexpr std::chrono::microseconds ClockDriftCompensator::cMaxJump;
+constexpr std::chrono::milliseconds ClockDriftCompensator::cMaxFillStep;
+constexpr size_t ClockDriftCompensator::cMaxBlockFrames;
+constexpr std::chrono::seconds ClockDriftCompensator::cFillTimeConstant;
+
+ClockDriftCompensator::ClockDriftCompensator(uint32_t sampleRate, uint32_t channelCount)
+    : sampleRate_(sampleRate)
+    , channelCount_(channelCount)
+    , resampler_(channelCount, 2 * cMaxBlockFrames)
+    , input_((cMaxBlockFrames + 64) * channelCount)
+    , phoneResetRequested_(false)
+    , phoneValid_(false)
+    , phoneDrift_(0.0)
+    , playedFrames_(0)
+    , playing_(false)
+    , fillIntegral_(0.0)
+    , timestampDrift_(0.0)
+    , timestampsUsed_(false)
+    , drift_(0.0)
+{
+    this->reset();
+}
+
+void ClockDriftCompensator::onWrite(aasdk::messenger::Timestamp::ValueType timestamp)
+{
+    if(phoneResetRequested_.exchange(false))
+    {
+        phoneTrend_.reset();
+        phoneValid_ = false;
+    }
+
+    // packets without a timestamp say nothing about the clock of the phone
+    if(timestamp == 0)
+    {
+        return;
+    }
+
+    const auto now = Clock::now();
+    const int64_t offset = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count() - static_cast<int64_t>(timestamp);
+
+    if(phoneTrend_.add(now, offset))
+    {
+        phoneDrift_ = phoneTrend_.getDrift();
+        phoneValid_ = phoneTrend_.isValid();
+    }
+}
+
+size_t ClockDriftCompensator::read(RingBuffer& buffer, int16_t* samples, size_t frameCount)
+{
+    const auto now = Clock::now();
+    size_t producedFrames = 0;
+
+    while(producedFrames < frameCount)
+    {
+        const size_t blockFrames = std::min(cMaxBlockFrames, frameCount - producedFrames);
+        const size_t frames = this->readQueue(buffer, samples + producedFrames * channelCount_, blockFrames);
+        producedFrames += frames;
+
+        if(frames < blockFrames)
+        {
+            break;
+        }
+    }
+
+    this->onPlayed(now, frameCount, buffer.getFillLevel() / (channelCount_ * sizeof(int16_t)));
+    return producedFrames;
+}
+
+void ClockDriftCompensator::reset()
+{
+    resampler_.reset();
+    deviceTrend_.reset();
+    playing_ = false;
+    playedFrames_ = 0;
+    fillSum_ = 0;
+    fillCount_ = 0;
+    fillEmptied_ = false;
+    lastFillMean_ = 0;
+    targetFill_ = 0;
+    hasFillMean_ = false;
+    // the drift learned so far stays, it belongs to the clocks and not to the stream
+    phoneResetRequested_ = true;
+}
+
+double ClockDriftCompensator::getDrift() const
+{
+    return drift_;
+}
+
+uint32_t ClockDriftCompensator::getChannelCount() const
+{
+    return channelCount_;
+}
+
+size_t ClockDriftCompensator::readQueue(RingBuffer& buffer, int16_t* samples, size_t frameCount)
+{
+    const size_t frameSize = channelCount_ * sizeof(int16_t);
+    const size_t requiredFrames = std::min(resampler_.getRequiredInputFrames(frameCount), input_.size() / channelCount_);
+    const size_t readFrames = buffer.read(reinterpret_cast<char*>(input_.data()), requiredFrames * frameSize) / frameSize;
+
+    resampler_.write(input_.data(), readFrames);
+    return resampler_.read(samples, frameCount);
+}
+
+void ClockDriftCompensator::onPlayed(Clock::time_point now, size_t frameCount, size_t bufferedFrames)
+{
+    // the device was stopped in between, its clock has to be picked up again
+    if(playing_ && now - lastRead_ > cMaxGap)
+    {
+        deviceTrend_.reset();
+        playing_ = false;
+    }
+
+    if(!playing_)
+    {
+        playing_ = true;
+        playStart_ = now;
+        playedFrames_ = 0;
+    }
+
+    const int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - playStart_).count();
+    const int64_t offset = elapsed - static_cast<int64_t>(playedFrames_ * 1000000 / sampleRate_);
+    playedFrames_ += frameCount;
+    lastRead_ = now;
+
+    fillSum_ += bufferedFrames;
+    ++fillCount_;
+    fillEmptied_ = fillEmptied_ || bufferedFrames == 0;
+
+    if(deviceTrend_.add(now, offset))
+    {
+        this->updateCorrection();
+    }
+}
+
+void ClockDriftCompensator::updateCorrection()
+{
+    if(phoneValid_ && deviceTrend_.isValid())
+    {
+        // from here on the timestamps carry the drift, the fill loop only keeps what they miss
+        if(!timestampsUsed_)
+        {
+            fillIntegral_ = 0;
+            timestampsUsed_ = true;
+        }
+        timestampDrift_ = phoneDrift_ - deviceTrend_.getDrift();
+    }
+
+    // the level the queue settled at after a start, or after the jitter buffer moved it on purpose
+    const double fillMean = fillCount_ > 0 ? fillSum_ / fillCount_ : 0.0;
+    const double maxFillStep = static_cast<double>(sampleRate_) * cMaxFillStep.count() / 1000;
+    if(!hasFillMean_ || fillEmptied_ || std::fabs(fillMean - lastFillMean_) > maxFillStep)
+    {
+        targetFill_ = fillMean;
+    }
+
+    lastFillMean_ = fillMean;
+    hasFillMean_ = true;
+    fillSum_ = 0;
+    fillCount_ = 0;
+    fillEmptied_ = false;
+
+    // critically damped PI loop on the deviation, slow enough to ignore packet sized steps
+    const double timeConstant = static_cast<double>(cFillTimeConstant.count());
+    const double error = (fillMean - targetFill_) / sampleRate_;
+    fillIntegral_ += error * cWindow.count() / (4 * timeConstant * timeConstant) * 1e6;
+    fillIntegral_ = std::max(-cMaxCorrection, std::min(cMaxCorrection, fillIntegral_));
+
+    drift_ = timestampDrift_ + fillIntegral_ + error / timeConstant * 1e6;
+    resampler_.setRatio(1.0 + std::max(-cMaxCorrection, std::min(cMaxCorrection, drift_.load())) * 1e-6);
+}
+
+ClockDriftCompensator::OffsetTrend::OffsetTrend()
+{
+    this->reset();
+}
+
+bool ClockDriftCompensator::OffsetTrend::add(Clock::time_point now, int64_t offset)
+{
+    if(started_ && std::abs(offset - current_.minimum) > cMaxJump.count())
+    {
+        // another timeline, e.g. the phone restarted its stream
+        this->reset();
+    }
+
+    if(!started_)
+    {
+        current_.start = now;
+        current_.minimum = offset;
+        started_ = true;
+        return false;
+    }
+
+    current_.minimum = std::min(current_.minimum, offset);
+
+    if(now - current_.start < cWindow)
+    {
+        return false;
+    }
+
+    if(windowCount_ == windows_.size())
+    {
+        std::move(windows_.begin() + 1, windows_.end(), windows_.begin());
+        --windowCount_;
+    }
+
+    windows_[windowCount_++] = current_;
+    current_.start = now;
+    current_.minimum = offset;
+    return true;
+}
+
+void ClockDriftCompensator::OffsetTrend::reset()
+{
+    windowCount_ = 0;
+    started_ = false;
+}
+
+bool ClockDriftCompensator::OffsetTrend::isValid() const
+{
+    return windowCount_ >= 2 && windows_[windowCount_ - 1].start - windows_[0].start >= cMinSpan;
+}
+
+double ClockDriftCompensator::OffsetTrend::getDrift() const
+{
+    if(windowCount_ < 2)
+    {
+        return 0.0;
+    }
+
+    // the offset is local minus remote time, it shrinks when the remote clock runs faster
+    const auto& first = windows_[0];
+    const auto& last = windows_[windowCount_ - 1];
+    const double span = std::chrono::duration_cast<std::chrono::microseconds>(last.start - first.start).count();
+    return -(last.minimum - first.minimum) / span * 1e6;
+}
+
+}
+}
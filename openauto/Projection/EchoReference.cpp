@@ -0,0 +1,118 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include "openauto/Projection/EchoReference.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+constexpr size_t EchoReference::cRingSize;
+constexpr size_t EchoReference::cMaxBlockFrames;
+
+EchoReference::EchoReference(uint32_t sampleRate)
+    : sampleRate_(sampleRate)
+{
+
+}
+
+IAudioOutput::PlaybackObserver EchoReference::createSource()
+{
+    auto source = std::make_shared<Source>(sampleRate_);
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        sources_.push_back(source);
+    }
+
+    return [source](const char* data, size_t size, uint32_t sampleRate, uint32_t channelCount) {
+        source->write(data, size, sampleRate, channelCount);
+    };
+}
+
+void EchoReference::read(float* samples, size_t frameCount)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    std::fill(samples, samples + frameCount, 0.0f);
+    block_.resize(frameCount);
+
+    for(const auto& source : sources_)
+    {
+        const size_t frames = source->ring.read(reinterpret_cast<char*>(block_.data()), frameCount * sizeof(int16_t)) / sizeof(int16_t);
+        for(size_t i = 0; i < frames; ++i)
+        {
+            samples[i] += block_[i];
+        }
+    }
+}
+
+void EchoReference::clear()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    for(const auto& source : sources_)
+    {
+        source->ring.clear();
+    }
+}
+
+uint32_t EchoReference::getSampleRate() const
+{
+    return sampleRate_;
+}
+
+EchoReference::Source::Source(uint32_t sampleRate)
+    : outputRate(sampleRate)
+    , ring(cRingSize, RingBufferOverflowPolicy::DROP_OLDEST, sizeof(int16_t))
+{
+
+}
+
+void EchoReference::Source::write(const char* data, size_t size, uint32_t sampleRate, uint32_t channelCount)
+{
+    if(resampler == nullptr || resampler->getInputRate() != sampleRate || resampler->getInputChannels() != channelCount)
+    {
+        resampler = std::make_unique<AudioResampler>(sampleRate, channelCount, outputRate, 1, cMaxBlockFrames);
+        converted.resize(cMaxBlockFrames * outputRate / sampleRate + 2);
+    }
+
+    const auto* samples = reinterpret_cast<const int16_t*>(data);
+    size_t frameCount = size / (channelCount * sizeof(int16_t));
+
+    while(frameCount > 0)
+    {
+        const size_t written = resampler->write(samples, std::min(frameCount, cMaxBlockFrames));
+        const size_t frames = resampler->read(converted.data(), std::min(resampler->getAvailableFrames(), converted.size()));
+        ring.write(reinterpret_cast<const char*>(converted.data()), frames * sizeof(int16_t));
+
+        if(written == 0 && frames == 0)
+        {
+            break;
+        }
+
+        samples += written * channelCount;
+        frameCount -= written;
+    }
+}
+
+}
+}
@@ -0,0 +1,146 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "openauto/Projection/FrameDropPolicy.hpp"
+#include "openauto/Projection/H264NalScanner.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+FrameDropPolicy::FrameDropPolicy(uint64_t latencyBudget)
+    : latencyBudget_(latencyBudget)
+    , enabled_(true)
+    , skipToIdr_(false)
+    , droppedNonReference_(0)
+    , droppedUntilIdr_(0)
+    , skipsToIdr_(0)
+{
+
+}
+
+VideoFrameType FrameDropPolicy::classify(const uint8_t* data, size_t size)
+{
+    H264NalScanner scanner(data, size);
+    NalUnit unit;
+
+    // parameter sets and SEI come first, the first slice decides and saves scanning the payload
+    while(scanner.next(unit))
+    {
+        switch(unit.type())
+        {
+        case NalUnitType::IDR:
+            return VideoFrameType::IDR;
+
+        case NalUnitType::SLICE:
+            return unit.refIdc() != 0 ? VideoFrameType::REFERENCE : VideoFrameType::NON_REFERENCE;
+
+        default:
+            break;
+        }
+    }
+
+    return VideoFrameType::CONFIG;
+}
+
+bool FrameDropPolicy::shouldDrop(VideoFrameType type, uint64_t queuedLatency)
+{
+    // parameter sets are tiny and the decoder cannot recover without them
+    if(latencyBudget_ == 0 || !enabled_ || type == VideoFrameType::CONFIG)
+    {
+        return false;
+    }
+
+    if(type == VideoFrameType::IDR)
+    {
+        skipToIdr_ = false;
+        return false;
+    }
+
+    if(skipToIdr_)
+    {
+        ++droppedUntilIdr_;
+        return true;
+    }
+
+    if(queuedLatency <= latencyBudget_)
+    {
+        return false;
+    }
+
+    if(type == VideoFrameType::NON_REFERENCE)
+    {
+        ++droppedNonReference_;
+        return true;
+    }
+
+    // dropping a reference frame corrupts everything predicted from it, so only do it when the queue
+    // is far behind and then skip the whole rest of the GOP
+    if(queuedLatency > latencyBudget_ * 2)
+    {
+        skipToIdr_ = true;
+        ++skipsToIdr_;
+        ++droppedUntilIdr_;
+        return true;
+    }
+
+    return false;
+}
+
+void FrameDropPolicy::skipToIdr()
+{
+    if(!skipToIdr_)
+    {
+        skipToIdr_ = true;
+        ++skipsToIdr_;
+    }
+
+    ++droppedUntilIdr_;
+}
+
+void FrameDropPolicy::reset()
+{
+    skipToIdr_ = false;
+    droppedNonReference_ = 0;
+    droppedUntilIdr_ = 0;
+    skipsToIdr_ = 0;
+}
+
+void FrameDropPolicy::setEnabled(bool enabled)
+{
+    enabled_ = enabled;
+}
+
+bool FrameDropPolicy::isEnabled() const
+{
+    return latencyBudget_ != 0 && enabled_;
+}
+
+FrameDropStatistics FrameDropPolicy::getStatistics() const
+{
+    FrameDropStatistics statistics;
+    statistics.droppedNonReference = droppedNonReference_;
+    statistics.droppedUntilIdr = droppedUntilIdr_;
+    statistics.skipsToIdr = skipsToIdr_;
+    return statistics;
+}
+
+}
+}
@@ -20,7 +20,7 @@
 #include "aasdk/Common/Data.hpp"
 #include "openauto/Projection/GSTVideoOutput.hpp"
 #include "OpenautoLog.hpp"
-#include "h264_stream.h"
+#include "OpenautoTrace.hpp"
 #include <QTimer>
 // these are needed only for pretty printing of data, to be removed
 #include <sstream>
@@ -37,6 +37,16 @@ GSTVideoOutput::GSTVideoOutput(configuration::IConfiguration::Pointer configurat
     : VideoOutput(std::move(configuration))
     , videoContainer_(videoContainer)
     , activeCallback_(activeCallback)
+    , bufferPool_(nullptr)
+    , bufferPoolSize_(0)
+    , writtenFrames_(0)
+    , bufferCopies_(0)
+    , copiedBytes_(0)
+    , pooledBuffers_(0)
+    , bufferAllocations_(0)
+    , rewrittenHeaders_(0)
+    , sourceFull_(false)
+    , dropPolicy_(static_cast<uint64_t>(configuration_->getVideoLatencyBudget()) * 1000)
 {
     this->moveToThread(QApplication::instance()->thread());
     videoWidget_ = new QQuickWidget(videoContainer_);
@@ -50,7 +60,7 @@ GSTVideoOutput::GSTVideoOutput(configuration::IConfiguration::Pointer configurat
 
 
     GError* error = nullptr;
-    std::string vidLaunchStr = "appsrc name=mysrc is-live=true block=false max-latency=100 do-timestamp=true stream-type=stream ! queue ! h264parse ! capssetter caps=\"video/x-h264,colorimetry=bt709\" ! ";
+    std::string vidLaunchStr = "appsrc name=mysrc is-live=true block=false max-latency=100 do-timestamp=true stream-type=stream ! queue name=videoqueue ! h264parse ! capssetter caps=\"video/x-h264,colorimetry=bt709\" ! ";
     vidLaunchStr += ToPipeline(findPreferredVideoDecoder());
     vidLaunchStr += " ! videocrop top=0 bottom=0 name=videocropper ! capsfilter caps=video/x-raw name=mycapsfilter";
     
@@ -79,17 +89,26 @@ GSTVideoOutput::GSTVideoOutput(configuration::IConfiguration::Pointer configurat
 
     vidSrc_ = GST_APP_SRC(gst_bin_get_by_name(GST_BIN(vidPipeline_), "mysrc"));
     gst_app_src_set_stream_type(vidSrc_, GST_APP_STREAM_TYPE_STREAM);
+    g_signal_connect(vidSrc_, "enough-data", G_CALLBACK(&GSTVideoOutput::onEnoughData), this);
+    g_signal_connect(vidSrc_, "need-data", G_CALLBACK(&GSTVideoOutput::onNeedData), this);
 
+    vidQueue_ = gst_bin_get_by_name(GST_BIN(vidPipeline_), "videoqueue");
     vidCrop_ = GST_VIDEO_FILTER(gst_bin_get_by_name(GST_BIN(vidPipeline_), "videocropper"));
 
+    // frames are matched across the pipeline by the PTS stamped in stampBuffer()
+    this->addLatencyProbe(GST_ELEMENT(vidCrop_), &GSTVideoOutput::decodedProbe);
+    this->addLatencyProbe(sink, &GSTVideoOutput::renderedProbe);
+
     connect(this, &GSTVideoOutput::startPlayback, this, &GSTVideoOutput::onStartPlayback, Qt::QueuedConnection);
     connect(this, &GSTVideoOutput::stopPlayback, this, &GSTVideoOutput::onStopPlayback, Qt::QueuedConnection);
 }
 
 GSTVideoOutput::~GSTVideoOutput()
 {
+    this->destroyBufferPool();
     gst_object_unref(vidPipeline_);
     gst_object_unref(vidSrc_);
+    gst_object_unref(vidQueue_);
 }
 
 
@@ -150,6 +169,9 @@ gboolean GSTVideoOutput::busCallback(GstBus* bus, GstMessage* message, gpointer
     case GST_MESSAGE_EOS:
         LOG(info) << "End of stream";
         break;
+    case GST_MESSAGE_LATENCY:
+        self->updatePipelineLatency();
+        break;
     case GST_MESSAGE_STATE_CHANGED:
         GstState old_state, new_state, pending_state;
         gst_message_parse_state_changed(message, &old_state, &new_state, &pending_state);
@@ -169,6 +191,9 @@ gboolean GSTVideoOutput::busCallback(GstBus* bus, GstMessage* message, gpointer
 bool GSTVideoOutput::open()
 {
     LOG(info);
+    this->createBufferPool();
+    dropPolicy_.reset();
+
     GstElement* capsFilter = gst_bin_get_by_name(GST_BIN(vidPipeline_), "mycapsfilter");
     GstPad* convertPad = gst_element_get_static_pad(capsFilter, "sink");
     gst_pad_add_probe(convertPad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, &GSTVideoOutput::convertProbe, this, nullptr);
@@ -200,6 +225,212 @@ GstPadProbeReturn GSTVideoOutput::convertProbe(GstPad* pad, GstPadProbeInfo* inf
     return GST_PAD_PROBE_OK;
 }
 
+void GSTVideoOutput::onEnoughData(GstAppSrc*, gpointer data)
+{
+    static_cast<GSTVideoOutput*>(data)->sourceFull_ = true;
+}
+
+void GSTVideoOutput::onNeedData(GstAppSrc*, guint, gpointer data)
+{
+    static_cast<GSTVideoOutput*>(data)->sourceFull_ = false;
+}
+
+bool GSTVideoOutput::isBackpressured() const
+{
+    // acks are held back while the decoder is more than half of the appsrc queue behind
+    return sourceFull_ || gst_app_src_get_current_level_bytes(vidSrc_) * 2 >= gst_app_src_get_max_bytes(vidSrc_);
+}
+
+void GSTVideoOutput::addLatencyProbe(GstElement* element, GstPadProbeCallback callback)
+{
+    GstPad* pad = gst_element_get_static_pad(element, "sink");
+    if(pad == nullptr)
+    {
+        LOG(error) << "No sink pad on " << GST_ELEMENT_NAME(element) << ", latency will not be tracked";
+        return;
+    }
+
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, callback, this, nullptr);
+    gst_object_unref(pad);
+}
+
+GstPadProbeReturn GSTVideoOutput::decodedProbe(GstPad*, GstPadProbeInfo* info, gpointer data)
+{
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if(buffer != nullptr && GST_BUFFER_PTS_IS_VALID(buffer))
+    {
+        static_cast<GSTVideoOutput*>(data)->latencyTracker_->onDecoded(GST_BUFFER_PTS(buffer));
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn GSTVideoOutput::renderedProbe(GstPad*, GstPadProbeInfo* info, gpointer data)
+{
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if(buffer != nullptr && GST_BUFFER_PTS_IS_VALID(buffer))
+    {
+        static_cast<GSTVideoOutput*>(data)->latencyTracker_->onRendered(GST_BUFFER_PTS(buffer));
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+void GSTVideoOutput::updatePipelineLatency()
+{
+    // the same figures the latency tracer reports, taken from the pipeline whenever it redistributes latency
+    gst_bin_recalculate_latency(GST_BIN(vidPipeline_));
+
+    GstQuery* query = gst_query_new_latency();
+    if(gst_element_query(vidPipeline_, query))
+    {
+        gboolean live = FALSE;
+        GstClockTime minLatency = 0;
+        GstClockTime maxLatency = 0;
+        gst_query_parse_latency(query, &live, &minLatency, &maxLatency);
+
+        latencyTracker_->setPipelineLatency(minLatency / GST_USECOND, GST_CLOCK_TIME_IS_VALID(maxLatency) ? maxLatency / GST_USECOND : 0);
+        LOG(debug) << "pipeline latency, live: " << (live ? "yes" : "no") << ", min: " << GST_TIME_AS_USECONDS(minLatency) << "us";
+    }
+    gst_query_unref(query);
+}
+
+GstClockTime GSTVideoOutput::stampBuffer(GstBuffer* buffer)
+{
+    // appsrc only timestamps buffers which arrive without one, so setting the running time here
+    // keeps do-timestamp semantics while giving us a key to follow the frame through the decoder
+    GstClock* clock = gst_element_get_clock(vidPipeline_);
+    if(clock == nullptr)
+    {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    const GstClockTime now = gst_clock_get_time(clock);
+    const GstClockTime baseTime = gst_element_get_base_time(vidPipeline_);
+    gst_object_unref(clock);
+
+    const GstClockTime pts = now > baseTime ? now - baseTime : 0;
+    GST_BUFFER_PTS(buffer) = pts;
+    GST_BUFFER_DTS(buffer) = pts;
+    return pts;
+}
+
+void GSTVideoOutput::createBufferPool()
+{
+    this->destroyBufferPool();
+
+    // The aasdk payload is released as soon as the channel handler returns, so we cannot hand it to
+    // appsrc wrapped. Instead every message is copied exactly once into a buffer recycled by this pool.
+    // Encoded frames never come close to the raw frame size, half of the NV12 size leaves plenty of room
+    // for IDR frames. Anything bigger falls back to a one-off allocation.
+    const QSize videoSize = this->getVideoSize();
+    const guint framesPerSecond = this->getVideoFPS() == aasdk::proto::enums::VideoFPS::_60 ? 60 : 30;
+    const guint minBuffers = framesPerSecond / 10 + 2;
+    bufferPoolSize_ = static_cast<size_t>(videoSize.width() * videoSize.height() * 3 / 4);
+
+    bufferPool_ = gst_buffer_pool_new();
+    GstStructure* config = gst_buffer_pool_get_config(bufferPool_);
+    gst_buffer_pool_config_set_params(config, nullptr, bufferPoolSize_, minBuffers, minBuffers * 2);
+
+    if(!gst_buffer_pool_set_config(bufferPool_, config) || !gst_buffer_pool_set_active(bufferPool_, TRUE))
+    {
+        LOG(error) << "Failed to activate video buffer pool, falling back to per-frame allocations";
+        gst_object_unref(bufferPool_);
+        bufferPool_ = nullptr;
+        return;
+    }
+
+    LOG(info) << "Created video buffer pool of " << minBuffers << "-" << minBuffers * 2 << " buffers, " << bufferPoolSize_ << " bytes each";
+}
+
+void GSTVideoOutput::destroyBufferPool()
+{
+    if(bufferPool_ != nullptr)
+    {
+        gst_buffer_pool_set_active(bufferPool_, FALSE);
+        gst_object_unref(bufferPool_);
+        bufferPool_ = nullptr;
+    }
+}
+
+GstBuffer* GSTVideoOutput::acquireBuffer(size_t size)
+{
+    if(bufferPool_ != nullptr && size <= bufferPoolSize_)
+    {
+        GstBuffer* buffer = nullptr;
+        GstBufferPoolAcquireParams params = {};
+        params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+
+        if(gst_buffer_pool_acquire_buffer(bufferPool_, &buffer, &params) == GST_FLOW_OK)
+        {
+            gst_buffer_set_size(buffer, size);
+            ++pooledBuffers_;
+            return buffer;
+        }
+    }
+
+    ++bufferAllocations_;
+    GstBuffer* buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
+    if(buffer == nullptr)
+    {
+        LOG(error) << "Failed to allocate a video buffer of " << size << " bytes";
+    }
+
+    return buffer;
+}
+
+bool GSTVideoOutput::pushBuffer(const uint8_t* data, size_t size)
+{
+    GstBuffer* buffer = this->acquireBuffer(size);
+    if(buffer == nullptr)
+    {
+        latencyTracker_->onDropped();
+        return false;
+    }
+
+    gst_buffer_fill(buffer, 0, data, size);
+    ++bufferCopies_;
+    copiedBytes_ += size;
+
+    return this->pushToSource(buffer, size);
+}
+
+bool GSTVideoOutput::pushToSource(GstBuffer* buffer, size_t size)
+{
+    // every received frame has to leave the tracker's receive FIFO, otherwise all later
+    // samples are matched against the receive time of an older frame
+    const GstClockTime pts = this->stampBuffer(buffer);
+    if(GST_CLOCK_TIME_IS_VALID(pts))
+    {
+        latencyTracker_->onPushed(pts);
+    }
+    else
+    {
+        latencyTracker_->onDropped();
+    }
+
+    int ret = gst_app_src_push_buffer(vidSrc_, buffer);
+    if(ret != GST_FLOW_OK)
+    {
+        LOG(warning) << "push buffer returned " << ret << " for " << size << "bytes";
+        return false;
+    }
+
+    return true;
+}
+
+VideoBufferStatistics GSTVideoOutput::getBufferStatistics() const
+{
+    VideoBufferStatistics statistics;
+    statistics.frames = writtenFrames_;
+    statistics.copies = bufferCopies_;
+    statistics.copiedBytes = copiedBytes_;
+    statistics.pooledBuffers = pooledBuffers_;
+    statistics.allocations = bufferAllocations_;
+    statistics.rewrittenHeaders = rewrittenHeaders_;
+    return statistics;
+}
+
 bool GSTVideoOutput::init()
 {
     LOG(info) << "init";
@@ -208,105 +439,108 @@ bool GSTVideoOutput::init()
     return true;
 }
 
+uint64_t GSTVideoOutput::getQueuedLatency() const
+{
+    guint64 level = 0;
+    g_object_get(vidQueue_, "current-level-time", &level, nullptr);
+    return level / GST_USECOND;
+}
+
+void GSTVideoOutput::setFrameDropping(bool enabled)
+{
+    dropPolicy_.setEnabled(enabled);
+}
+
+FrameDropStatistics GSTVideoOutput::getDropStatistics() const
+{
+    return dropPolicy_.getStatistics();
+}
+
 void GSTVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
-    if(!firstHeaderParsed && this->configuration_->getWhitescreenWorkaround())
+    // a decoder that cannot keep up would otherwise turn the projection into an ever growing replay
+    if(dropPolicy_.shouldDrop(FrameDropPolicy::classify(buffer.cdata, buffer.size), this->getQueuedLatency()))
     {
-        // I really really really hate this.
-
-        // Raspberry Pi hardware h264 decode appears broken if video_signal_type VUI parameters are given in the h264 header
-        // And we don't have control over Android Auto putting these parameters in (which it does.. on some model phones)
-        // So we pull in h264bitstream to edit this header on the fly
-        
-        // This is not a fix, I want to be very clear about that. I don't know what else I'm breaking, or run the 
-        // risk of breaking by doing this. This code should only remain here as long as the Pi Engineers haven't released
-        // a firmware/driver fix for this yet. An issue has been opened upstream at https://github.com/raspberrypi/firmware/issues/1673
-
-        // Android Auto seems nice enough to always start a message with a new h264 packet,
-        // but that doesn't mean we don't have multiple within the message.
-        // So if we have a message that _could_ fit two packets (which are delimited by 0x00000001)
-        // then we try to find the second and save the data it contains, while editing and replacing the first.
-        
-        // This header should also always be within the first video message we receive from a device... I think
-        
-        std::vector<uint8_t> delimit_sequence{0x00, 0x00, 0x00, 0x01};
-        std::vector<uint8_t>::iterator sequence_split;
-        std::vector<uint8_t> incoming_buffer(&buffer.cdata[0], &buffer.cdata[buffer.size]);
-
-        int nal_start, nal_end;
-        uint8_t* buf = (uint8_t *) buffer.cdata;
-        int len = buffer.size;
-        h264_stream_t* h = h264_new();
-        // finds the first NAL packet
-        find_nal_unit(buf, len, &nal_start, &nal_end);
-        // parses it
-        read_nal_unit(h, &buf[nal_start], nal_end - nal_start);
-        // wipe all the color description stuff that breaks Pis
-        h->sps->vui.video_signal_type_present_flag = 0x00;
-        h->sps->vui.video_format = 0x00;
-        h->sps->vui.video_full_range_flag = 0x00;
-        h->sps->vui.colour_description_present_flag = 0x00;
-        h->sps->vui.video_format = 0x00;
-        h->sps->vui.video_full_range_flag = 0x00;
-        h->sps->vui.colour_description_present_flag = 0x00;
-        h->sps->vui.colour_primaries = 0x00;
-        h->sps->vui.transfer_characteristics = 0x00;
-        h->sps->vui.matrix_coefficients = 0x00;
-
-        // grab some storage
-        uint8_t* out_buf = new uint8_t[30];
-
-        // write it to the storage's 3rd index, because h264bitstream seems to have a bug
-        // where it both doesn't write the delimiter, and it prepends a leading 0x00
-        len = write_nal_unit(h, &out_buf[3], 30) + 3;
-        // write the delimiter back
-        out_buf[0] = 0x00;
-        out_buf[1] = 0x00;
-        out_buf[2] = 0x00;
-        out_buf[3] = 0x01;
-
-        // output to gstreamer
-        GstBuffer* buffer_ = gst_buffer_new_and_alloc(len);
-        gst_buffer_fill(buffer_, 0, out_buf, len);
-        int ret = gst_app_src_push_buffer((GstAppSrc*)vidSrc_, buffer_);
-        if(ret != GST_FLOW_OK)
-        {
-            LOG(info) << "Injecting header failed";
-        }
-
-        // then check if there's data we need to save
-        if(incoming_buffer.size() >= 8){
-            sequence_split = std::search(incoming_buffer.begin()+4, incoming_buffer.end(), delimit_sequence.begin(), delimit_sequence.end());
-            if(sequence_split != incoming_buffer.end()){
-                std::vector<uint8_t> incoming_data_saved(sequence_split, incoming_buffer.end());
-                GstBuffer* buffer_ = gst_buffer_new_and_alloc(incoming_data_saved.size());
-                gst_buffer_fill(buffer_, 0, incoming_data_saved.data(), incoming_data_saved.size());
-                int ret = gst_app_src_push_buffer((GstAppSrc*)vidSrc_, buffer_);
-                if(ret != GST_FLOW_OK)
-                {
-                    LOG(info) << "Injecting partial header failed";
-                }
-            }
-        }
-        LOG(info) << "Intercepted and replaced h264 header";
+        latencyTracker_->onDropped();
+        return;
+    }
 
-        firstHeaderParsed=true;
+    // Raspberry Pi hardware h264 decode appears broken if video_signal_type VUI parameters are given in the h264 header
+    // And we don't have control over Android Auto putting these parameters in (which it does.. on some model phones)
+    // So every SPS is rewritten on the fly without them, phones resend it with each IDR and after an encoder restart.
+    // An issue has been opened upstream at https://github.com/raspberrypi/firmware/issues/1673
+    if(this->configuration_->getWhitescreenWorkaround() && H264NalScanner::contains(buffer.cdata, buffer.size, NalUnitType::SPS))
+    {
+        this->pushRewrittenBuffer(buffer.cdata, buffer.size);
     }
     else
     {
-        GstBuffer* buffer_ = gst_buffer_new_and_alloc(buffer.size);
-        gst_buffer_fill(buffer_, 0, buffer.cdata, buffer.size);
-        int ret = gst_app_src_push_buffer((GstAppSrc*)vidSrc_, buffer_);
-        if(ret != GST_FLOW_OK)
+        this->pushBuffer(buffer.cdata, buffer.size);
+    }
+
+    ++writtenFrames_;
+}
+
+bool GSTVideoOutput::pushRewrittenBuffer(const uint8_t* data, size_t size)
+{
+    // removing bits can shift new emulation prevention bytes into the SPS, the slack usually covers them
+    // and the checks below fall back to the unmodified frame when it does not
+    GstBuffer* buffer = this->acquireBuffer(size + cSpsRewriteSlack);
+    if(buffer == nullptr)
+    {
+        latencyTracker_->onDropped();
+        return false;
+    }
+
+    GstMapInfo map;
+    if(!gst_buffer_map(buffer, &map, GST_MAP_WRITE))
+    {
+        gst_buffer_unref(buffer);
+        latencyTracker_->onDropped();
+        return false;
+    }
+
+    H264NalScanner scanner(data, size);
+    NalUnit unit;
+    const uint8_t* copied = data;
+    size_t written = 0;
+
+    while(scanner.next(unit))
+    {
+        if(unit.type() == NalUnitType::SPS && spsRewriter_.rewrite(unit))
         {
-            LOG(info) << "push buffer returned " << ret << " for " << buffer.size << "bytes";
+            const size_t prefixSize = static_cast<size_t>(unit.data - copied);
+            const size_t tailSize = static_cast<size_t>(data + size - (unit.data + unit.size));
+            if(written + prefixSize + spsRewriter_.size() + tailSize > map.size)
+            {
+                gst_buffer_unmap(buffer, &map);
+                gst_buffer_unref(buffer);
+                return this->pushBuffer(data, size);
+            }
+
+            memcpy(map.data + written, copied, prefixSize);
+            written += prefixSize;
+            memcpy(map.data + written, spsRewriter_.data(), spsRewriter_.size());
+            written += spsRewriter_.size();
+            copied = unit.data + unit.size;
+            ++rewrittenHeaders_;
         }
     }
+
+    memcpy(map.data + written, copied, static_cast<size_t>(data + size - copied));
+    written += static_cast<size_t>(data + size - copied);
+    gst_buffer_unmap(buffer, &map);
+    gst_buffer_set_size(buffer, written);
+
+    ++bufferCopies_;
+    copiedBytes_ += written;
+
+    return this->pushToSource(buffer, written);
 }
 
 void GSTVideoOutput::onStartPlayback()
 {
-    firstHeaderParsed = false;
+    TRACE_METHOD("qt", "GSTVideoOutput");
     if(activeCallback_ != nullptr)
     {
         activeCallback_(true);
@@ -335,7 +569,23 @@ void GSTVideoOutput::stop()
 
 void GSTVideoOutput::onStopPlayback()
 {
-    firstHeaderParsed = false;
+    TRACE_METHOD("qt", "GSTVideoOutput");
+    const auto statistics = this->getBufferStatistics();
+    LOG(info) << "Video buffers, frames: " << statistics.frames
+              << ", copies: " << statistics.copies
+              << ", copied bytes: " << statistics.copiedBytes
+              << ", pooled: " << statistics.pooledBuffers
+              << ", allocations: " << statistics.allocations
+              << ", rewritten headers: " << statistics.rewrittenHeaders;
+
+    // behind a QueuedVideoOutput the queue drops and logs the statistics
+    if(dropPolicy_.isEnabled())
+    {
+        const auto dropStatistics = this->getDropStatistics();
+        LOG(info) << "Video drops, non-reference: " << dropStatistics.droppedNonReference
+                  << ", until IDR: " << dropStatistics.droppedUntilIdr
+                  << ", skips to IDR: " << dropStatistics.skipsToIdr;
+    }
 
     if(activeCallback_ != nullptr)
     {
@@ -350,6 +600,21 @@ void GSTVideoOutput::onStopPlayback()
     videoWidget_->hide();
 }
 
+QSize GSTVideoOutput::getVideoSize() const
+{
+    switch(this->getVideoResolution()){
+        case aasdk::proto::enums::VideoResolution_Enum__1080p:
+            return QSize(1920, 1080);
+        case aasdk::proto::enums::VideoResolution_Enum__720p:
+            return QSize(1280, 720);
+        case aasdk::proto::enums::VideoResolution_Enum__480p:
+            return QSize(800, 480);
+        default:
+            LOG(info) << "Unhandled video resolution. Set to default 480p";
+            return QSize(800, 480);
+    }
+}
+
 void GSTVideoOutput::resize()
 {
     LOG(info) << "Got resize request to "<< videoContainer_->width() << "x" << videoContainer_->height();
@@ -359,31 +624,12 @@ void GSTVideoOutput::resize()
         videoWidget_->resize(videoContainer_->size());
     }
 
-    int width = 0;
-    int height = 0;
+    const QSize videoSize = this->getVideoSize();
+    int width = videoSize.width();
+    int height = videoSize.height();
     int containerWidth = videoContainer_->width();
     int containerHeight = videoContainer_->height();
 
-    switch(this->getVideoResolution()){
-        case aasdk::proto::enums::VideoResolution_Enum__1080p:
-            width = 1920;
-            height = 1080;
-            break;
-        case aasdk::proto::enums::VideoResolution_Enum__720p:
-            width = 1280;
-            height = 720;
-            break;
-        case aasdk::proto::enums::VideoResolution_Enum__480p:
-            width = 800;
-            height = 480;
-            break;
-        default:
-            LOG(info) << "Unhandled video resolution. Set to default 480p";
-            width = 800;
-            height = 480;
-            break;
-    }
-
     double marginWidth = 0;
     double marginHeight = 0;
 
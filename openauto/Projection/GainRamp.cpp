@@ -0,0 +1,148 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include "openauto/Projection/GainRamp.hpp"
+#include "openauto/Projection/VectorMath.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+constexpr std::chrono::milliseconds GainRamp::cRampTime;
+
+GainRamp::GainRamp(uint32_t sampleRate, uint32_t channelCount)
+    : channelCount_(std::max<uint32_t>(channelCount, 1))
+    , rampFrames_(std::max<size_t>(sampleRate * cRampTime.count() / 1000, 1))
+    , target_(1.0f)
+    , current_(1.0f)
+    , step_(0.0f)
+    , stepTarget_(1.0f)
+    , calls_(0)
+    , rampingCalls_(0)
+    , totalTime_(0)
+    , maxTime_(0)
+{
+
+}
+
+void GainRamp::setTarget(float gain)
+{
+    target_ = gain;
+}
+
+float GainRamp::getTarget() const
+{
+    return target_;
+}
+
+void GainRamp::apply(int16_t* samples, size_t frameCount)
+{
+    this->process(samples, frameCount);
+}
+
+void GainRamp::apply(float* samples, size_t frameCount)
+{
+    this->process(samples, frameCount);
+}
+
+void GainRamp::mixInto(float* mix, float* samples, size_t frameCount)
+{
+    const auto started = Clock::now();
+    const size_t rampedCount = this->ramp(samples, frameCount) * channelCount_;
+
+    // the steady gain is applied while accumulating, the samples are not touched twice
+    VectorMath::multiplyAdd(mix, samples, 1.0f, rampedCount);
+    if(current_ != 0.0f)
+    {
+        VectorMath::multiplyAdd(mix + rampedCount, samples + rampedCount, current_, frameCount * channelCount_ - rampedCount);
+    }
+
+    this->record(started, rampedCount > 0);
+}
+
+template<typename SampleType>
+void GainRamp::process(SampleType* samples, size_t frameCount)
+{
+    const auto started = Clock::now();
+    const size_t rampedCount = this->ramp(samples, frameCount) * channelCount_;
+
+    if(current_ != 1.0f)
+    {
+        VectorMath::scale(samples + rampedCount, current_, frameCount * channelCount_ - rampedCount);
+    }
+
+    this->record(started, rampedCount > 0);
+}
+
+template<typename SampleType>
+size_t GainRamp::ramp(SampleType* samples, size_t frameCount)
+{
+    const float target = target_;
+
+    if(target != stepTarget_)
+    {
+        // a full swing takes cRampTime, a change of direction mid-ramp starts from where it is
+        stepTarget_ = target;
+        step_ = (target - current_) / rampFrames_;
+    }
+
+    if(current_ == target)
+    {
+        return 0;
+    }
+
+    const size_t remainingFrames = std::min<size_t>(frameCount, static_cast<size_t>(std::ceil(std::fabs(target - current_) / std::fabs(step_))));
+    VectorMath::ramp(samples, current_, step_, remainingFrames, channelCount_);
+    current_ = remainingFrames * std::fabs(step_) >= std::fabs(target - current_) ? target : current_ + step_ * remainingFrames;
+
+    return remainingFrames;
+}
+
+void GainRamp::record(Clock::time_point started, bool ramping)
+{
+    const uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count();
+
+    // single writer, plain loads and stores are enough
+    calls_.store(calls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    totalTime_.store(totalTime_.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+    if(ramping)
+    {
+        rampingCalls_.store(rampingCalls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    if(elapsed > maxTime_.load(std::memory_order_relaxed))
+    {
+        maxTime_.store(elapsed, std::memory_order_relaxed);
+    }
+}
+
+GainRampStatistics GainRamp::getStatistics() const
+{
+    GainRampStatistics statistics;
+    statistics.calls = calls_;
+    statistics.rampingCalls = rampingCalls_;
+    statistics.totalTime = totalTime_;
+    statistics.maxTime = maxTime_;
+    return statistics;
+}
+
+}
+}
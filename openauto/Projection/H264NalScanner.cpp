@@ -0,0 +1,510 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+#include "openauto/Projection/H264NalScanner.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+namespace
+{
+
+class BitReader
+{
+public:
+    BitReader(const uint8_t* data, size_t size)
+        : data_(data)
+        , bits_(size * 8)
+        , position_(0)
+        , overrun_(false)
+    {
+    }
+
+    uint32_t readBit()
+    {
+        if(position_ >= bits_)
+        {
+            overrun_ = true;
+            return 0;
+        }
+
+        const uint32_t bit = (data_[position_ >> 3] >> (7 - (position_ & 7))) & 0x01;
+        ++position_;
+        return bit;
+    }
+
+    uint32_t readBits(unsigned int count)
+    {
+        uint32_t value = 0;
+        while(count-- > 0)
+        {
+            value = (value << 1) | this->readBit();
+        }
+        return value;
+    }
+
+    uint32_t readUe()
+    {
+        unsigned int leadingZeros = 0;
+        while(this->readBit() == 0)
+        {
+            if(overrun_ || ++leadingZeros > 31)
+            {
+                overrun_ = true;
+                return 0;
+            }
+        }
+
+        return ((1u << leadingZeros) - 1) + this->readBits(leadingZeros);
+    }
+
+    int32_t readSe()
+    {
+        const uint32_t value = this->readUe();
+        return (value & 0x01) ? static_cast<int32_t>((value + 1) / 2) : -static_cast<int32_t>(value / 2);
+    }
+
+    size_t position() const
+    {
+        return position_;
+    }
+
+    bool overrun() const
+    {
+        return overrun_;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t bits_;
+    size_t position_;
+    bool overrun_;
+};
+
+class BitWriter
+{
+public:
+    BitWriter(uint8_t* data, size_t size)
+        : data_(data)
+        , bits_(size * 8)
+        , position_(0)
+    {
+        memset(data_, 0, size);
+    }
+
+    bool writeBit(uint32_t bit)
+    {
+        if(position_ >= bits_)
+        {
+            return false;
+        }
+
+        if(bit != 0)
+        {
+            data_[position_ >> 3] |= 0x80 >> (position_ & 7);
+        }
+        ++position_;
+        return true;
+    }
+
+    size_t size() const
+    {
+        return (position_ + 7) / 8;
+    }
+
+private:
+    uint8_t* data_;
+    size_t bits_;
+    size_t position_;
+};
+
+inline uint32_t bitAt(const uint8_t* data, size_t position)
+{
+    return (data[position >> 3] >> (7 - (position & 7))) & 0x01;
+}
+
+void skipScalingList(BitReader& reader, int size)
+{
+    int32_t lastScale = 8;
+    int32_t nextScale = 8;
+
+    for(int i = 0; i < size && !reader.overrun(); ++i)
+    {
+        if(nextScale != 0)
+        {
+            nextScale = (lastScale + reader.readSe() + 256) % 256;
+        }
+        lastScale = nextScale == 0 ? lastScale : nextScale;
+    }
+}
+
+bool hasChromaFormatInfo(uint32_t profileIdc)
+{
+    switch(profileIdc)
+    {
+    case 44: case 83: case 86: case 100: case 110: case 118:
+    case 122: case 128: case 134: case 135: case 138: case 139: case 244:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Walks seq_parameter_set_data() up to the VUI video_signal_type fields and returns the bit range they occupy,
+// including the video_signal_type_present_flag itself.
+bool locateVideoSignalType(const uint8_t* rbsp, size_t size, size_t& begin, size_t& end)
+{
+    BitReader reader(rbsp, size);
+
+    const uint32_t profileIdc = reader.readBits(8);
+    reader.readBits(16); // constraint flags, level_idc
+    reader.readUe(); // seq_parameter_set_id
+
+    if(hasChromaFormatInfo(profileIdc))
+    {
+        const uint32_t chromaFormatIdc = reader.readUe();
+        if(chromaFormatIdc == 3)
+        {
+            reader.readBit(); // separate_colour_plane_flag
+        }
+        reader.readUe(); // bit_depth_luma_minus8
+        reader.readUe(); // bit_depth_chroma_minus8
+        reader.readBit(); // qpprime_y_zero_transform_bypass_flag
+
+        if(reader.readBit()) // seq_scaling_matrix_present_flag
+        {
+            const int lists = chromaFormatIdc != 3 ? 8 : 12;
+            for(int i = 0; i < lists && !reader.overrun(); ++i)
+            {
+                if(reader.readBit())
+                {
+                    skipScalingList(reader, i < 6 ? 16 : 64);
+                }
+            }
+        }
+    }
+
+    reader.readUe(); // log2_max_frame_num_minus4
+    const uint32_t picOrderCntType = reader.readUe();
+    if(picOrderCntType == 0)
+    {
+        reader.readUe(); // log2_max_pic_order_cnt_lsb_minus4
+    }
+    else if(picOrderCntType == 1)
+    {
+        reader.readBit(); // delta_pic_order_always_zero_flag
+        reader.readSe(); // offset_for_non_ref_pic
+        reader.readSe(); // offset_for_top_to_bottom_field
+        const uint32_t cycle = reader.readUe();
+        if(cycle > 255)
+        {
+            return false;
+        }
+        for(uint32_t i = 0; i < cycle && !reader.overrun(); ++i)
+        {
+            reader.readSe();
+        }
+    }
+
+    reader.readUe(); // max_num_ref_frames
+    reader.readBit(); // gaps_in_frame_num_value_allowed_flag
+    reader.readUe(); // pic_width_in_mbs_minus1
+    reader.readUe(); // pic_height_in_map_units_minus1
+    if(!reader.readBit()) // frame_mbs_only_flag
+    {
+        reader.readBit(); // mb_adaptive_frame_field_flag
+    }
+    reader.readBit(); // direct_8x8_inference_flag
+    if(reader.readBit()) // frame_cropping_flag
+    {
+        reader.readUe();
+        reader.readUe();
+        reader.readUe();
+        reader.readUe();
+    }
+
+    if(!reader.readBit()) // vui_parameters_present_flag
+    {
+        return false;
+    }
+
+    if(reader.readBit()) // aspect_ratio_info_present_flag
+    {
+        if(reader.readBits(8) == 255) // Extended_SAR
+        {
+            reader.readBits(32); // sar_width, sar_height
+        }
+    }
+
+    if(reader.readBit()) // overscan_info_present_flag
+    {
+        reader.readBit(); // overscan_appropriate_flag
+    }
+
+    begin = reader.position();
+    if(!reader.readBit()) // video_signal_type_present_flag
+    {
+        return false;
+    }
+
+    reader.readBits(3); // video_format
+    reader.readBit(); // video_full_range_flag
+    if(reader.readBit()) // colour_description_present_flag
+    {
+        reader.readBits(24); // colour_primaries, transfer_characteristics, matrix_coefficients
+    }
+    end = reader.position();
+
+    return !reader.overrun();
+}
+
+}
+
+H264NalScanner::H264NalScanner(const uint8_t* data, size_t size)
+    : end_(data + size)
+    , current_(findStartCode(data, data + size))
+{
+}
+
+bool H264NalScanner::next(NalUnit& unit)
+{
+    while(current_ + 3 < end_)
+    {
+        const uint8_t* data = current_ + 3;
+        const uint8_t* nextStartCode = findStartCode(data, end_);
+        const uint8_t* dataEnd = nextStartCode;
+
+        // trailing zeros belong either to a 4 byte start code or to trailing_zero_8bits
+        while(dataEnd > data && dataEnd[-1] == 0x00)
+        {
+            --dataEnd;
+        }
+
+        unit.start = current_;
+        unit.data = data;
+        unit.size = static_cast<size_t>(dataEnd - data);
+        current_ = nextStartCode;
+
+        if(unit.size > 0)
+        {
+            return true;
+        }
+    }
+
+    current_ = end_;
+    return false;
+}
+
+const uint8_t* H264NalScanner::findStartCode(const uint8_t* begin, const uint8_t* end)
+{
+    const uint8_t* p = begin;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+
+    while(end - p >= 18)
+    {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        const __m128i third = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2));
+        const __m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(first, zero), _mm_cmpeq_epi8(second, zero)), _mm_cmpeq_epi8(third, one));
+        const int mask = _mm_movemask_epi8(match);
+
+        if(mask != 0)
+        {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const uint8x16_t zero = vdupq_n_u8(0);
+    const uint8x16_t one = vdupq_n_u8(1);
+
+    while(end - p >= 18)
+    {
+        const uint8x16_t match = vandq_u8(vandq_u8(vceqq_u8(vld1q_u8(p), zero), vceqq_u8(vld1q_u8(p + 1), zero)), vceqq_u8(vld1q_u8(p + 2), one));
+        const uint64x2_t mask = vreinterpretq_u64_u8(match);
+        const uint64_t low = vgetq_lane_u64(mask, 0);
+        const uint64_t high = vgetq_lane_u64(mask, 1);
+
+        if(low != 0)
+        {
+            return p + __builtin_ctzll(low) / 8;
+        }
+        else if(high != 0)
+        {
+            return p + 8 + __builtin_ctzll(high) / 8;
+        }
+        p += 16;
+    }
+#endif
+
+    for(; end - p >= 3; ++p)
+    {
+        if(p[2] > 1)
+        {
+            p += 2;
+        }
+        else if(p[0] == 0x00 && p[1] == 0x00 && p[2] == 0x01)
+        {
+            return p;
+        }
+    }
+
+    return end;
+}
+
+bool H264NalScanner::contains(const uint8_t* data, size_t size, NalUnitType type)
+{
+    H264NalScanner scanner(data, size);
+    NalUnit unit;
+
+    while(scanner.next(unit))
+    {
+        if(unit.type() == type)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool H264SpsRewriter::rewrite(const NalUnit& unit)
+{
+    outputSize_ = 0;
+
+    if(unit.type() != NalUnitType::SPS || unit.size < 2 || unit.size > cMaxSpsSize)
+    {
+        return false;
+    }
+
+    const size_t rbspSize = this->unescape(unit.data + 1, unit.size - 1);
+    size_t begin = 0;
+    size_t end = 0;
+
+    if(rbspSize == 0 || !locateVideoSignalType(rbsp_, rbspSize, begin, end))
+    {
+        return false;
+    }
+
+    // the rbsp_stop_one_bit is the last bit set, everything after it is alignment
+    size_t lastByte = rbspSize;
+    while(lastByte > 0 && rbsp_[lastByte - 1] == 0x00)
+    {
+        --lastByte;
+    }
+    if(lastByte == 0)
+    {
+        return false;
+    }
+    const size_t stopBit = (lastByte - 1) * 8 + 7 - __builtin_ctz(rbsp_[lastByte - 1]);
+    if(stopBit < end)
+    {
+        return false;
+    }
+
+    BitWriter writer(rewritten_, sizeof(rewritten_));
+    bool written = true;
+    for(size_t i = 0; i < begin; ++i)
+    {
+        written &= writer.writeBit(bitAt(rbsp_, i));
+    }
+    written &= writer.writeBit(0); // video_signal_type_present_flag
+    for(size_t i = end; i <= stopBit; ++i)
+    {
+        written &= writer.writeBit(bitAt(rbsp_, i));
+    }
+
+    if(!written)
+    {
+        return false;
+    }
+
+    output_[0] = unit.data[0];
+    outputSize_ = this->escape(writer.size());
+    return outputSize_ > 0;
+}
+
+const uint8_t* H264SpsRewriter::data() const
+{
+    return output_;
+}
+
+size_t H264SpsRewriter::size() const
+{
+    return outputSize_;
+}
+
+size_t H264SpsRewriter::unescape(const uint8_t* data, size_t size)
+{
+    size_t rbspSize = 0;
+    unsigned int zeros = 0;
+
+    for(size_t i = 0; i < size; ++i)
+    {
+        if(zeros >= 2 && data[i] == 0x03)
+        {
+            zeros = 0;
+            continue;
+        }
+
+        if(rbspSize == sizeof(rbsp_))
+        {
+            return 0;
+        }
+
+        rbsp_[rbspSize++] = data[i];
+        zeros = data[i] == 0x00 ? zeros + 1 : 0;
+    }
+
+    return rbspSize;
+}
+
+size_t H264SpsRewriter::escape(size_t size)
+{
+    size_t outputSize = 1;
+    unsigned int zeros = 0;
+
+    for(size_t i = 0; i < size; ++i)
+    {
+        if(zeros >= 2 && rewritten_[i] <= 0x03)
+        {
+            output_[outputSize++] = 0x03;
+            zeros = 0;
+        }
+
+        output_[outputSize++] = rewritten_[i];
+        zeros = rewritten_[i] == 0x00 ? zeros + 1 : 0;
+    }
+
+    return outputSize;
+}
+
+}
+}
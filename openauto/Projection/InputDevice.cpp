@@ -251,7 +251,7 @@ bool InputDevice::handleTouchEvent(QEvent* event)
         touchLocation->set_pointer_id(pointer_map[pointers[i].id()]);
     }
 
-    eventHandler_->onTouchEvent(inputEventIndication);
+    eventHandler_->onTouchEvent(std::move(inputEventIndication));
 
     return true;
 
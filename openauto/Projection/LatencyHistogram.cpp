@@ -0,0 +1,82 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include "openauto/Projection/LatencyHistogram.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+LatencyHistogram::LatencyHistogram()
+    : next_(0)
+    , count_(0)
+{
+}
+
+void LatencyHistogram::add(uint64_t value)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    samples_[next_] = value;
+    next_ = (next_ + 1) % cWindowSize;
+    ++count_;
+}
+
+void LatencyHistogram::reset()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    next_ = 0;
+    count_ = 0;
+}
+
+LatencyPercentiles LatencyHistogram::getPercentiles() const
+{
+    std::array<uint64_t, cWindowSize> window;
+    LatencyPercentiles percentiles;
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        percentiles.count = count_;
+        window = samples_;
+    }
+
+    const size_t size = std::min<uint64_t>(percentiles.count, cWindowSize);
+    if(size == 0)
+    {
+        return percentiles;
+    }
+
+    auto percentile = [&window, size](size_t rank) {
+        auto nth = window.begin() + std::min(size - 1, size * rank / 100);
+        std::nth_element(window.begin(), nth, window.begin() + size);
+        return *nth;
+    };
+
+    percentiles.p50 = percentile(50);
+    percentiles.p95 = percentile(95);
+    percentiles.p99 = percentile(99);
+    percentiles.max = *std::max_element(window.begin(), window.begin() + size);
+    return percentiles;
+}
+
+}
+}
@@ -0,0 +1,387 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifdef USE_LIBAV
+
+#include <algorithm>
+#include <chrono>
+#include <QApplication>
+#include <QPainter>
+#include "openauto/Projection/LibavVideoOutput.hpp"
+#include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+LibavVideoSurface::LibavVideoSurface(VideoLatencyTracker::Pointer latencyTracker, QWidget* parent)
+    : QWidget(parent)
+    , latencyTracker_(std::move(latencyTracker))
+    , pts_(0)
+    , pending_(false)
+{
+    // every pixel is covered by the frame, skip erasing the background first
+    this->setAttribute(Qt::WA_OpaquePaintEvent);
+    this->setAttribute(Qt::WA_NoSystemBackground);
+}
+
+void LibavVideoSurface::present(QImage& image, uint64_t pts)
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        std::swap(image_, image);
+        pts_ = pts;
+        pending_ = true;
+    }
+
+    QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+}
+
+QSize LibavVideoSurface::getFrameSize() const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return frameSize_;
+}
+
+void LibavVideoSurface::paintEvent(QPaintEvent*)
+{
+    QImage image;
+    uint64_t pts = 0;
+    bool pending = false;
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        image = image_;
+        pts = pts_;
+        pending = pending_;
+        pending_ = false;
+    }
+
+    QPainter painter(this);
+    if(image.isNull())
+    {
+        painter.fillRect(this->rect(), Qt::black);
+        return;
+    }
+
+    painter.drawImage(this->rect(), image);
+
+    if(pending)
+    {
+        latencyTracker_->onRendered(pts);
+    }
+}
+
+void LibavVideoSurface::resizeEvent(QResizeEvent*)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    frameSize_ = this->size();
+}
+
+LibavVideoOutput::LibavVideoOutput(configuration::IConfiguration::Pointer configuration, QWidget* videoContainer)
+    : VideoOutput(std::move(configuration))
+    , videoContainer_(videoContainer)
+    , codecContext_(nullptr)
+    , packet_(nullptr)
+    , frame_(nullptr)
+    , swsContext_(nullptr)
+    , running_(false)
+    , nextPts_(0)
+{
+    this->moveToThread(QApplication::instance()->thread());
+    connect(this, &LibavVideoOutput::startPlayback, this, &LibavVideoOutput::onStartPlayback, Qt::QueuedConnection);
+    connect(this, &LibavVideoOutput::stopPlayback, this, &LibavVideoOutput::onStopPlayback, Qt::QueuedConnection);
+
+    QMetaObject::invokeMethod(this, "createVideoOutput", Qt::BlockingQueuedConnection);
+}
+
+LibavVideoOutput::~LibavVideoOutput()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        running_ = false;
+    }
+    condition_.notify_one();
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    this->closeDecoder();
+}
+
+void LibavVideoOutput::createVideoOutput()
+{
+    TRACE_METHOD("qt", "LibavVideoOutput");
+    LOG(debug) << "create.";
+    videoSurface_ = std::make_unique<LibavVideoSurface>(latencyTracker_, videoContainer_);
+}
+
+bool LibavVideoOutput::open()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(running_)
+    {
+        return true;
+    }
+
+    if(!this->openDecoder())
+    {
+        this->closeDecoder();
+        return false;
+    }
+
+    running_ = true;
+    packets_.clear();
+    thread_ = std::thread(&LibavVideoOutput::run, this);
+    return true;
+}
+
+bool LibavVideoOutput::openDecoder()
+{
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+    if(codec == nullptr)
+    {
+        LOG(error) << "[LibavVideoOutput] h264 decoder is not available.";
+        return false;
+    }
+
+    codecContext_ = avcodec_alloc_context3(codec);
+    packet_ = av_packet_alloc();
+    frame_ = av_frame_alloc();
+    if(codecContext_ == nullptr || packet_ == nullptr || frame_ == nullptr)
+    {
+        LOG(error) << "[LibavVideoOutput] failed to allocate the decoder.";
+        return false;
+    }
+
+    codecContext_->thread_count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if(configuration_->getVideoFrameThreading())
+    {
+        // more throughput on slow cores, at the cost of one frame of delay per decoding thread
+        codecContext_->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    }
+    else
+    {
+        codecContext_->thread_type = FF_THREAD_SLICE;
+        codecContext_->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    }
+    codecContext_->flags2 |= AV_CODEC_FLAG2_FAST;
+
+    const int result = avcodec_open2(codecContext_, codec, nullptr);
+    if(result < 0)
+    {
+        LOG(error) << "[LibavVideoOutput] failed to open the decoder: " << result;
+        return false;
+    }
+
+    LOG(info) << "[LibavVideoOutput] decoding with " << codecContext_->thread_count << " threads, "
+              << (codecContext_->active_thread_type == FF_THREAD_FRAME ? "frame" : "slice") << " threading.";
+    return true;
+}
+
+void LibavVideoOutput::closeDecoder()
+{
+    avcodec_free_context(&codecContext_);
+    av_packet_free(&packet_);
+    av_frame_free(&frame_);
+    sws_freeContext(swsContext_);
+    swsContext_ = nullptr;
+}
+
+bool LibavVideoOutput::init()
+{
+    emit startPlayback();
+    return true;
+}
+
+void LibavVideoOutput::write(uint64_t, const aasdk::common::DataConstBuffer& buffer)
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        if(!running_)
+        {
+            return;
+        }
+
+        Packet packet;
+        packet.pts = nextPts_++;
+        // the bitstream reader may overread the end of the packet by up to the padding size
+        packet.data.resize(buffer.size + AV_INPUT_BUFFER_PADDING_SIZE, 0);
+        std::copy(buffer.cdata, buffer.cdata + buffer.size, packet.data.begin());
+        packet.data.resize(buffer.size);
+
+        latencyTracker_->onPushed(packet.pts);
+        packets_.push_back(std::move(packet));
+    }
+
+    condition_.notify_one();
+}
+
+void LibavVideoOutput::stop()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        running_ = false;
+    }
+    condition_.notify_one();
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+
+        const auto decodeTime = decodeTime_.getPercentiles();
+        LOG(info) << "[LibavVideoOutput] decode time [us], samples: " << decodeTime.count
+                  << ", p50: " << decodeTime.p50
+                  << ", p95: " << decodeTime.p95
+                  << ", p99: " << decodeTime.p99
+                  << ", max: " << decodeTime.max;
+    }
+
+    this->closeDecoder();
+    emit stopPlayback();
+}
+
+bool LibavVideoOutput::isBackpressured() const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return packets_.size() >= cMaxQueuedPackets;
+}
+
+LatencyPercentiles LibavVideoOutput::getDecodeTime() const
+{
+    return decodeTime_.getPercentiles();
+}
+
+void LibavVideoOutput::resize()
+{
+    if(videoSurface_ != nullptr && videoContainer_ != nullptr)
+    {
+        videoSurface_->resize(videoContainer_->size());
+    }
+}
+
+void LibavVideoOutput::onStartPlayback()
+{
+    TRACE_METHOD("qt", "LibavVideoOutput");
+    if(videoContainer_ == nullptr)
+    {
+        videoSurface_->setFocus();
+        videoSurface_->setWindowFlags(Qt::WindowStaysOnTopHint);
+        videoSurface_->showFullScreen();
+    }
+    else
+    {
+        videoSurface_->resize(videoContainer_->size());
+        videoSurface_->show();
+    }
+}
+
+void LibavVideoOutput::onStopPlayback()
+{
+    TRACE_METHOD("qt", "LibavVideoOutput");
+    videoSurface_->hide();
+}
+
+void LibavVideoOutput::run()
+{
+    std::unique_lock<decltype(mutex_)> lock(mutex_);
+
+    while(true)
+    {
+        condition_.wait(lock, [this]() { return !running_ || !packets_.empty(); });
+        if(!running_)
+        {
+            break;
+        }
+
+        auto packet = std::move(packets_.front());
+        packets_.pop_front();
+        lock.unlock();
+        this->decode(packet);
+        lock.lock();
+    }
+}
+
+void LibavVideoOutput::decode(Packet& packet)
+{
+    packet_->data = packet.data.data();
+    packet_->size = static_cast<int>(packet.data.size());
+    packet_->pts = static_cast<int64_t>(packet.pts);
+
+    const auto started = std::chrono::steady_clock::now();
+    int result = avcodec_send_packet(codecContext_, packet_);
+    if(result < 0)
+    {
+        LOG(error) << "[LibavVideoOutput] failed to send packet: " << result;
+        return;
+    }
+
+    while((result = avcodec_receive_frame(codecContext_, frame_)) == 0)
+    {
+        // with frame threading a frame comes out for an earlier packet, the time then includes the pipeline delay
+        decodeTime_.add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count());
+        latencyTracker_->onDecoded(static_cast<uint64_t>(frame_->pts));
+        this->present(frame_);
+        av_frame_unref(frame_);
+    }
+
+    if(result != AVERROR(EAGAIN) && result != AVERROR_EOF)
+    {
+        LOG(error) << "[LibavVideoOutput] failed to decode frame: " << result;
+    }
+}
+
+void LibavVideoOutput::present(const AVFrame* frame)
+{
+    const auto frameSize = videoSurface_->getFrameSize();
+    if(frameSize.isEmpty())
+    {
+        return;
+    }
+
+    // scaling to the surface in swscale is much cheaper than letting QPainter do it
+    swsContext_ = sws_getCachedContext(swsContext_, frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+                                       frameSize.width(), frameSize.height(), AV_PIX_FMT_RGB32,
+                                       SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    if(swsContext_ == nullptr)
+    {
+        return;
+    }
+
+    // the surface hands back the previous frame, its buffer is reused unless it is still being painted
+    if(image_.size() != frameSize)
+    {
+        image_ = QImage(frameSize, QImage::Format_RGB32);
+    }
+
+    uint8_t* destination[] = {image_.bits()};
+    const int destinationStride[] = {image_.bytesPerLine()};
+    sws_scale(swsContext_, frame->data, frame->linesize, 0, frame->height, destination, destinationStride);
+    videoSurface_->present(image_, static_cast<uint64_t>(frame->pts));
+}
+
+}
+}
+
+#endif
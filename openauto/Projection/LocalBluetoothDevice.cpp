@@ -18,6 +18,7 @@
 
 #include <QApplication>
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 #include "openauto/Projection/LocalBluetoothDevice.hpp"
 
 namespace openauto
@@ -36,6 +37,7 @@ LocalBluetoothDevice::LocalBluetoothDevice()
 
 void LocalBluetoothDevice::createBluetoothLocalDevice()
 {
+    TRACE_METHOD("qt", "LocalBluetoothDevice");
     LOG(debug) << "create.";
 
     localDevice_ = std::make_unique<QBluetoothLocalDevice>(QBluetoothAddress());
@@ -86,6 +88,7 @@ bool LocalBluetoothDevice::isAvailable() const
 
 void LocalBluetoothDevice::onStartPairing(const QString& address, PairingPromise::Pointer promise)
 {
+    TRACE_METHOD("qt", "LocalBluetoothDevice");
     LOG(debug) << "onStartPairing, address: " << address.toStdString();
 
     std::lock_guard<decltype(mutex_)> lock(mutex_);
@@ -0,0 +1,206 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "openauto/Projection/NullAudioOutput.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+NullAudioOutput::NullAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+    : channelCount_(channelCount)
+    , sampleSize_(sampleSize)
+    , sampleRate_(sampleRate)
+    , audioBuffer_(aasdk::common::cStaticDataSize, RingBufferOverflowPolicy::DROP_OLDEST, channelCount * sampleSize / 8)
+    , lastWriteSize_(0)
+    , underruns_(0)
+    , lateCallbacks_(0)
+    , gainRamp_(sampleRate, channelCount)
+    , running_(false)
+{
+    if(sampleSize_ == 16)
+    {
+        driftCompensator_ = std::make_shared<ClockDriftCompensator>(sampleRate_, channelCount_);
+        audioBuffer_.setDriftCompensator(driftCompensator_);
+    }
+}
+
+NullAudioOutput::~NullAudioOutput()
+{
+    this->doStop();
+}
+
+bool NullAudioOutput::open()
+{
+    return audioBuffer_.isOpen() || audioBuffer_.open(QIODevice::ReadWrite);
+}
+
+void NullAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    lastWriteSize_ = buffer.size;
+    audioBuffer_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+
+    if(driftCompensator_ != nullptr)
+    {
+        driftCompensator_->onWrite(timestamp);
+    }
+}
+
+void NullAudioOutput::start()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(!running_)
+    {
+        running_ = true;
+        thread_ = std::thread(&NullAudioOutput::run, this);
+    }
+}
+
+void NullAudioOutput::stop()
+{
+    this->doStop();
+}
+
+void NullAudioOutput::suspend()
+{
+    this->doStop();
+}
+
+void NullAudioOutput::doStop()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        running_ = false;
+    }
+    condition_.notify_one();
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+void NullAudioOutput::flush()
+{
+    audioBuffer_.reset();
+}
+
+void NullAudioOutput::setGain(float gain)
+{
+    gainRamp_.setTarget(gain);
+}
+
+void NullAudioOutput::setPlaybackObserver(PlaybackObserver observer)
+{
+    playbackObserver_ = std::move(observer);
+}
+
+uint32_t NullAudioOutput::getSampleSize() const
+{
+    return sampleSize_;
+}
+
+uint32_t NullAudioOutput::getChannelCount() const
+{
+    return channelCount_;
+}
+
+uint32_t NullAudioOutput::getSampleRate() const
+{
+    return sampleRate_;
+}
+
+bool NullAudioOutput::isBackpressured() const
+{
+    return audioBuffer_.bytesFree() < static_cast<qint64>(lastWriteSize_);
+}
+
+size_t NullAudioOutput::getBufferedBytes() const
+{
+    return audioBuffer_.getStatistics().fillLevel;
+}
+
+uint64_t NullAudioOutput::getUnderrunCount() const
+{
+    return underruns_;
+}
+
+uint64_t NullAudioOutput::getLateCallbackCount() const
+{
+    return lateCallbacks_;
+}
+
+double NullAudioOutput::getClockDrift() const
+{
+    return driftCompensator_ != nullptr ? driftCompensator_->getDrift() : 0.0;
+}
+
+void NullAudioOutput::onPeriod(const char*, size_t)
+{
+}
+
+void NullAudioOutput::run()
+{
+    const uint32_t periodFrames = sampleRate_ == 16000 ? 1024 : 2048;
+    const size_t periodSize = periodFrames * (sampleSize_ / 8) * channelCount_;
+    const auto periodDuration = std::chrono::microseconds(static_cast<uint64_t>(periodFrames) * 1000000 / sampleRate_);
+    std::vector<char> period(periodSize);
+    auto nextPeriod = std::chrono::steady_clock::now() + periodDuration;
+
+    std::unique_lock<decltype(mutex_)> lock(mutex_);
+    while(!condition_.wait_until(lock, nextPeriod, [this]() { return !running_; }))
+    {
+        lock.unlock();
+
+        // woken up only when the next period was already due, a DAC would have run dry
+        if(std::chrono::steady_clock::now() >= nextPeriod + periodDuration)
+        {
+            ++lateCallbacks_;
+        }
+
+        const auto read = audioBuffer_.read(period.data(), periodSize);
+        if(read < static_cast<qint64>(periodSize))
+        {
+            ++underruns_;
+            std::fill(period.begin() + std::max<qint64>(read, 0), period.end(), 0);
+        }
+
+        if(sampleSize_ == 16)
+        {
+            gainRamp_.apply(reinterpret_cast<int16_t*>(period.data()), periodFrames);
+        }
+
+        if(playbackObserver_)
+        {
+            playbackObserver_(period.data(), periodSize, sampleRate_, channelCount_);
+        }
+
+        this->onPeriod(period.data(), periodSize);
+        nextPeriod += periodDuration;
+        lock.lock();
+    }
+}
+
+}
+}
@@ -0,0 +1,142 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <chrono>
+#include "openauto/Projection/NullVideoOutput.hpp"
+#include "openauto/Projection/FrameDropPolicy.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+NullVideoOutput::NullVideoOutput(configuration::IConfiguration::Pointer configuration)
+    : VideoOutput(std::move(configuration))
+    , running_(false)
+    , nextPts_(0)
+    , decodedFrames_(0)
+{
+
+}
+
+NullVideoOutput::~NullVideoOutput()
+{
+    this->stop();
+}
+
+bool NullVideoOutput::open()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(!running_)
+    {
+        running_ = true;
+        queue_.clear();
+        thread_ = std::thread(&NullVideoOutput::run, this);
+    }
+
+    return true;
+}
+
+bool NullVideoOutput::init()
+{
+    return true;
+}
+
+void NullVideoOutput::write(uint64_t, const aasdk::common::DataConstBuffer& buffer)
+{
+    // parameter sets cost a decoder next to nothing
+    if(FrameDropPolicy::classify(buffer.cdata, buffer.size) == VideoFrameType::CONFIG)
+    {
+        latencyTracker_->onDropped();
+        return;
+    }
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        const uint64_t pts = nextPts_++;
+        latencyTracker_->onPushed(pts);
+        queue_.push_back(pts);
+    }
+
+    condition_.notify_one();
+}
+
+void NullVideoOutput::stop()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        running_ = false;
+    }
+    condition_.notify_one();
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+        LOG(info) << "Null video output decoded " << decodedFrames_ << " frames";
+    }
+}
+
+bool NullVideoOutput::isBackpressured() const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return queue_.size() >= cMaxQueuedFrames;
+}
+
+uint64_t NullVideoOutput::getDecodedFrames() const
+{
+    return decodedFrames_;
+}
+
+void NullVideoOutput::run()
+{
+    const auto frameInterval = std::chrono::microseconds(this->getVideoFPS() == aasdk::proto::enums::VideoFPS::_30 ? 1000000 / 30 : 1000000 / 60);
+    auto nextSlot = std::chrono::steady_clock::now();
+    std::unique_lock<decltype(mutex_)> lock(mutex_);
+
+    while(true)
+    {
+        condition_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+        if(!running_)
+        {
+            break;
+        }
+
+        // a decoder running at exactly the display rate, idle time is not carried over as credit
+        nextSlot = std::max(nextSlot, std::chrono::steady_clock::now()) + frameInterval;
+        lock.unlock();
+        std::this_thread::sleep_until(nextSlot);
+        lock.lock();
+
+        if(queue_.empty())
+        {
+            continue;
+        }
+
+        const uint64_t pts = queue_.front();
+        queue_.pop_front();
+        latencyTracker_->onDecoded(pts);
+        latencyTracker_->onRendered(pts);
+        ++decodedFrames_;
+    }
+}
+
+}
+}
@@ -16,17 +16,30 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <QApplication>
 #include "openauto/Projection/QtAudioInput.hpp"
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 
 namespace openauto
 {
 namespace projection
 {
 
-QtAudioInput::QtAudioInput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+constexpr size_t QtAudioInput::cChunkSize;
+constexpr size_t QtAudioInput::cChunkPoolSize;
+constexpr size_t QtAudioInput::cRingSize;
+constexpr size_t QtAudioInput::cDeviceReadFrames;
+
+QtAudioInput::QtAudioInput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, AudioInputProcessor::Pointer processor)
     : ioDevice_(nullptr)
+    , processor_(channelCount == 1 && sampleSize == 16 ? std::move(processor) : nullptr)
+    , ring_(cRingSize, RingBufferOverflowPolicy::DROP_OLDEST, channelCount * sampleSize / 8)
+    , chunkSize_(cChunkSize / (channelCount * sampleSize / 8) * (channelCount * sampleSize / 8))
+    , capturedFrames_(0)
+    , chunks_(0)
+    , poolMisses_(0)
 {
     qRegisterMetaType<IAudioInput::StartPromise::Pointer>("StartPromise::Pointer");
 
@@ -45,8 +58,40 @@ QtAudioInput::QtAudioInput(uint32_t channelCount, uint32_t sampleSize, uint32_t
 
 void QtAudioInput::createAudioInput()
 {
+    TRACE_METHOD("qt", "QtAudioInput");
     LOG(debug) << "create.";
-    audioInput_ = (std::make_unique<QAudioInput>(QAudioDeviceInfo::defaultInputDevice(), audioFormat_));
+    const auto deviceInfo = QAudioDeviceInfo::defaultInputDevice();
+    const auto preferredFormat = deviceInfo.preferredFormat();
+    deviceFormat_ = audioFormat_;
+    deviceFormat_.setSampleRate(preferredFormat.sampleRate());
+    deviceFormat_.setChannelCount(preferredFormat.channelCount());
+
+    if(audioFormat_.sampleSize() == 16 && deviceFormat_.sampleRate() > 0 && deviceFormat_.channelCount() > 0 && deviceFormat_ != audioFormat_ && deviceInfo.isFormatSupported(deviceFormat_))
+    {
+        // record the way the device runs and convert here instead of in the sound server
+        resampler_ = std::make_unique<AudioResampler>(deviceFormat_.sampleRate(), deviceFormat_.channelCount(), audioFormat_.sampleRate(), audioFormat_.channelCount());
+        LOG(info) << "Resampling audio input from " << deviceFormat_.sampleRate() << " Hz " << deviceFormat_.channelCount() << " ch"
+                  << " to " << audioFormat_.sampleRate() << " Hz " << audioFormat_.channelCount() << " ch";
+    }
+    else
+    {
+        deviceFormat_ = audioFormat_;
+    }
+
+    audioInput_ = (std::make_unique<QAudioInput>(deviceInfo, deviceFormat_));
+
+    deviceSamples_.resize(cDeviceReadFrames * deviceFormat_.channelCount());
+    if(resampler_ != nullptr)
+    {
+        // one device read plus the fraction of a frame the resampler may carry over
+        convertedSamples_.resize((cDeviceReadFrames * audioFormat_.sampleRate() / deviceFormat_.sampleRate() + 2) * audioFormat_.channelCount());
+    }
+
+    chunkPool_.reserve(cChunkPoolSize);
+    for(size_t i = 0; i < cChunkPoolSize; ++i)
+    {
+        chunkPool_.emplace_back(chunkSize_, 0);
+    }
 }
 
 bool QtAudioInput::open()
@@ -78,6 +123,17 @@ void QtAudioInput::read(ReadPromise::Pointer promise)
     else
     {
         readPromise_ = std::move(promise);
+        this->deliverChunk();
+    }
+}
+
+void QtAudioInput::release(aasdk::common::Data data)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(chunkPool_.size() < cChunkPoolSize && data.capacity() >= chunkSize_)
+    {
+        chunkPool_.push_back(std::move(data));
     }
 }
 
@@ -91,6 +147,21 @@ void QtAudioInput::stop()
     emit stopRecording();
 }
 
+void QtAudioInput::setSignalProcessing(bool echoCancellation, bool noiseSuppression)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(processor_ != nullptr)
+    {
+        processor_->setEchoCancellation(echoCancellation);
+        processor_->setNoiseSuppression(noiseSuppression);
+    }
+    else if(echoCancellation || noiseSuppression)
+    {
+        LOG(info) << "[QtAudioInput] no signal processing available for this input.";
+    }
+}
+
 uint32_t QtAudioInput::getSampleSize() const
 {
     return audioFormat_.sampleSize();
@@ -106,12 +177,33 @@ uint32_t QtAudioInput::getSampleRate() const
     return audioFormat_.sampleRate();
 }
 
+uint64_t QtAudioInput::getOverrunCount() const
+{
+    return ring_.getStatistics().overflows;
+}
+
+uint64_t QtAudioInput::getDroppedFrameCount() const
+{
+    return ring_.getStatistics().overflowBytes / this->getFrameSize();
+}
+
+size_t QtAudioInput::getFrameSize() const
+{
+    return audioFormat_.channelCount() * audioFormat_.sampleSize() / 8;
+}
+
 void QtAudioInput::onStartRecording(StartPromise::Pointer promise)
 {
+    TRACE_METHOD("qt", "QtAudioInput");
     std::lock_guard<decltype(mutex_)> lock(mutex_);
 
     ioDevice_ = audioInput_->start();
 
+    if(processor_ != nullptr)
+    {
+        processor_->reset();
+    }
+
     if(ioDevice_ != nullptr)
     {
         connect(ioDevice_, &QIODevice::readyRead, this, &QtAudioInput::onReadyRead, Qt::QueuedConnection);
@@ -125,6 +217,7 @@ void QtAudioInput::onStartRecording(StartPromise::Pointer promise)
 
 void QtAudioInput::onStopRecording()
 {
+    TRACE_METHOD("qt", "QtAudioInput");
     std::lock_guard<decltype(mutex_)> lock(mutex_);
 
     if(readPromise_ != nullptr)
@@ -138,35 +231,115 @@ void QtAudioInput::onStopRecording()
         ioDevice_->reset();
         ioDevice_->disconnect();
         ioDevice_ = nullptr;
+
+        LOG(info) << "[QtAudioInput] stopped, chunks: " << chunks_
+                  << ", overruns: " << this->getOverrunCount()
+                  << ", dropped frames: " << this->getDroppedFrameCount()
+                  << ", pool misses: " << poolMisses_;
+
+        if(processor_ != nullptr && processor_->getStatistics().frames > 0)
+        {
+            const auto statistics = processor_->getStatistics();
+            LOG(info) << "[QtAudioInput] signal processing frames: " << statistics.frames
+                      << ", avg: " << statistics.totalTime / statistics.frames / 1000 << " us"
+                      << ", max: " << statistics.maxTime / 1000 << " us"
+                      << ", over budget: " << statistics.overBudgetFrames;
+        }
     }
 
     audioInput_->stop();
+    ring_.clear();
+
+    if(resampler_ != nullptr)
+    {
+        resampler_->reset();
+    }
 }
 
 void QtAudioInput::onReadyRead()
 {
+    TRACE_METHOD("qt", "QtAudioInput");
     std::lock_guard<decltype(mutex_)> lock(mutex_);
 
-    if(readPromise_ == nullptr)
+    if(ioDevice_ == nullptr)
     {
         return;
     }
 
-    aasdk::common::Data data(cSampleSize, 0);
-    aasdk::common::DataBuffer buffer(data);
-    auto readSize = ioDevice_->read(reinterpret_cast<char*>(buffer.data), buffer.size);
+    this->drainDevice();
+    this->deliverChunk();
+}
+
+void QtAudioInput::drainDevice()
+{
+    const size_t deviceFrameSize = deviceFormat_.channelCount() * sizeof(int16_t);
+    const size_t frameSize = this->getFrameSize();
 
-    if(readSize != -1)
+    for(;;)
     {
-        data.resize(readSize);
-        readPromise_->resolve(std::move(data));
-        readPromise_.reset();
+        const auto readSize = ioDevice_->read(reinterpret_cast<char*>(deviceSamples_.data()), cDeviceReadFrames * deviceFrameSize);
+        if(readSize <= 0)
+        {
+            break;
+        }
+
+        captureTime_ = std::chrono::high_resolution_clock::now();
+
+        int16_t* samples = deviceSamples_.data();
+        size_t frames = readSize / frameSize;
+
+        if(resampler_ != nullptr)
+        {
+            resampler_->write(deviceSamples_.data(), readSize / deviceFrameSize);
+            samples = convertedSamples_.data();
+            frames = resampler_->read(samples, std::min(resampler_->getAvailableFrames(), convertedSamples_.size() / audioFormat_.channelCount()));
+        }
+
+        if(processor_ != nullptr && processor_->isEnabled())
+        {
+            processor_->process(samples, frames);
+        }
+
+        ring_.write(reinterpret_cast<const char*>(samples), frames * frameSize);
+        capturedFrames_ += frames;
     }
-    else
+}
+
+void QtAudioInput::deliverChunk()
+{
+    if(readPromise_ == nullptr || ring_.getFillLevel() < chunkSize_)
     {
-        readPromise_->reject();
-        readPromise_.reset();
+        return;
     }
+
+    // the ring holds the newest frames, the chunk starts where the unread ones begin
+    const size_t frameSize = this->getFrameSize();
+    const uint64_t firstFrame = capturedFrames_ - ring_.getFillLevel() / frameSize;
+    const size_t processingLatency = processor_ != nullptr && processor_->isEnabled() ? processor_->getLatencyFrames() : 0;
+    const auto age = std::chrono::microseconds((capturedFrames_ - firstFrame + processingLatency) * 1000000 / audioFormat_.sampleRate());
+
+    AudioInputChunk chunk;
+    chunk.timestamp = std::chrono::duration_cast<std::chrono::microseconds>((captureTime_ - age).time_since_epoch()).count();
+    chunk.data = this->acquireChunk();
+    ring_.read(reinterpret_cast<char*>(chunk.data.data()), chunkSize_);
+    ++chunks_;
+
+    readPromise_->resolve(std::move(chunk));
+    readPromise_.reset();
+}
+
+aasdk::common::Data QtAudioInput::acquireChunk()
+{
+    if(chunkPool_.empty())
+    {
+        ++poolMisses_;
+        return aasdk::common::Data(chunkSize_, 0);
+    }
+
+    auto data = std::move(chunkPool_.back());
+    chunkPool_.pop_back();
+    data.resize(chunkSize_);
+    return data;
 }
 
 }
@@ -19,6 +19,7 @@
 #include <QApplication>
 #include "openauto/Projection/QtAudioOutput.hpp"
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 
 
 namespace openauto
@@ -26,8 +27,13 @@ namespace openauto
 namespace projection
 {
 
+constexpr size_t QtAudioOutput::cResamplerChunkFrames;
+
 QtAudioOutput::QtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
-    : playbackStarted_(false)
+    : audioBuffer_(aasdk::common::cStaticDataSize, RingBufferOverflowPolicy::DROP_OLDEST, channelCount * sampleSize / 8)
+    , lastWriteSize_(0)
+    , playbackStarted_(false)
+    , underruns_(0)
 {
     audioFormat_.setChannelCount(channelCount);
     audioFormat_.setSampleRate(sampleRate);
@@ -40,14 +46,39 @@ QtAudioOutput::QtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_
     connect(this, &QtAudioOutput::startPlayback, this, &QtAudioOutput::onStartPlayback);
     connect(this, &QtAudioOutput::suspendPlayback, this, &QtAudioOutput::onSuspendPlayback);
     connect(this, &QtAudioOutput::stopPlayback, this, &QtAudioOutput::onStopPlayback);
+    connect(this, &QtAudioOutput::changeVolume, this, &QtAudioOutput::onChangeVolume);
 
     QMetaObject::invokeMethod(this, "createAudioOutput", Qt::BlockingQueuedConnection);
 }
 
 void QtAudioOutput::createAudioOutput()
 {
+    TRACE_METHOD("qt", "QtAudioOutput");
     LOG(debug) << "create.";
-    audioOutput_ = std::make_unique<QAudioOutput>(QAudioDeviceInfo::defaultOutputDevice(), audioFormat_);
+    const auto deviceInfo = QAudioDeviceInfo::defaultOutputDevice();
+    deviceFormat_ = audioFormat_;
+    deviceFormat_.setSampleRate(deviceInfo.preferredFormat().sampleRate());
+
+    if(audioFormat_.sampleSize() == 16 && deviceFormat_.sampleRate() > 0 && deviceFormat_.sampleRate() != audioFormat_.sampleRate() && deviceInfo.isFormatSupported(deviceFormat_))
+    {
+        // convert here instead of in the sound server, channel mapping is cheap enough to leave to it
+        resampler_ = std::make_unique<AudioResampler>(audioFormat_.sampleRate(), audioFormat_.channelCount(), deviceFormat_.sampleRate(), audioFormat_.channelCount(), cResamplerChunkFrames);
+        resampled_.resize((cResamplerChunkFrames * deviceFormat_.sampleRate() / audioFormat_.sampleRate() + 2) * audioFormat_.channelCount());
+        LOG(info) << "Resampling audio output from " << audioFormat_.sampleRate() << " Hz to " << deviceFormat_.sampleRate() << " Hz";
+    }
+    else
+    {
+        deviceFormat_ = audioFormat_;
+    }
+
+    if(deviceFormat_.sampleSize() == 16)
+    {
+        driftCompensator_ = std::make_shared<ClockDriftCompensator>(deviceFormat_.sampleRate(), deviceFormat_.channelCount());
+        audioBuffer_.setDriftCompensator(driftCompensator_);
+    }
+
+    audioOutput_ = std::make_unique<QAudioOutput>(deviceInfo, deviceFormat_);
+    connect(audioOutput_.get(), &QAudioOutput::stateChanged, this, &QtAudioOutput::onStateChanged);
 }
 
 bool QtAudioOutput::open()
@@ -55,9 +86,34 @@ bool QtAudioOutput::open()
     return audioBuffer_.open(QIODevice::ReadWrite);
 }
 
-void QtAudioOutput::write(aasdk::messenger::Timestamp::ValueType, const aasdk::common::DataConstBuffer& buffer)
+void QtAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
-    audioBuffer_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+    if(driftCompensator_ != nullptr)
+    {
+        driftCompensator_->onWrite(timestamp);
+    }
+
+    if(resampler_ == nullptr)
+    {
+        lastWriteSize_ = buffer.size;
+        audioBuffer_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+        return;
+    }
+
+    const size_t frameSize = audioFormat_.channelCount() * sizeof(int16_t);
+    const int16_t* samples = reinterpret_cast<const int16_t*>(buffer.cdata);
+    size_t remainingFrames = buffer.size / frameSize;
+    lastWriteSize_ = 0;
+
+    while(remainingFrames > 0)
+    {
+        const size_t written = resampler_->write(samples, std::min(remainingFrames, cResamplerChunkFrames));
+        const size_t resampledFrames = resampler_->read(resampled_.data(), resampled_.size() / audioFormat_.channelCount());
+        audioBuffer_.write(reinterpret_cast<const char*>(resampled_.data()), resampledFrames * frameSize);
+        lastWriteSize_ += resampledFrames * frameSize;
+        samples += written * audioFormat_.channelCount();
+        remainingFrames -= written;
+    }
 }
 
 void QtAudioOutput::start()
@@ -75,6 +131,35 @@ void QtAudioOutput::suspend()
     emit suspendPlayback();
 }
 
+void QtAudioOutput::flush()
+{
+    audioBuffer_.reset();
+
+    if(resampler_ != nullptr)
+    {
+        resampler_->reset();
+    }
+}
+
+void QtAudioOutput::setPlaybackObserver(PlaybackObserver observer)
+{
+    // QAudioOutput pulls from audioBuffer_, a read is the closest this gets to the device
+    const uint32_t sampleRate = deviceFormat_.sampleRate();
+    const uint32_t channelCount = deviceFormat_.channelCount();
+    audioBuffer_.setReadObserver([observer, sampleRate, channelCount](const char* data, size_t size) {
+        if(observer)
+        {
+            observer(data, size, sampleRate, channelCount);
+        }
+    });
+}
+
+void QtAudioOutput::setGain(float gain)
+{
+    // QAudioOutput applies the volume itself, the samples never pass through here
+    emit changeVolume(gain);
+}
+
 uint32_t QtAudioOutput::getSampleSize() const
 {
     return audioFormat_.sampleSize();
@@ -90,8 +175,37 @@ uint32_t QtAudioOutput::getSampleRate() const
     return audioFormat_.sampleRate();
 }
 
+bool QtAudioOutput::isBackpressured() const
+{
+    // the ring overwrites unread samples when it overflows, so hold back once the next packet would not fit
+    return audioBuffer_.bytesFree() < static_cast<qint64>(lastWriteSize_);
+}
+
+size_t QtAudioOutput::getBufferedBytes() const
+{
+    // in bytes of the stream, the jitter buffer compares them with what it wrote
+    return static_cast<size_t>(static_cast<uint64_t>(audioBuffer_.getStatistics().fillLevel) * audioFormat_.sampleRate() / deviceFormat_.sampleRate());
+}
+
+uint64_t QtAudioOutput::getUnderrunCount() const
+{
+    return underruns_;
+}
+
+uint64_t QtAudioOutput::getLateCallbackCount() const
+{
+    // QAudioOutput pulls on its own schedule and does not report when it was late
+    return 0;
+}
+
+double QtAudioOutput::getClockDrift() const
+{
+    return driftCompensator_ != nullptr ? driftCompensator_->getDrift() : 0.0;
+}
+
 void QtAudioOutput::onStartPlayback()
 {
+    TRACE_METHOD("qt", "QtAudioOutput");
     if(!playbackStarted_)
     {
         audioOutput_->start(&audioBuffer_);
@@ -105,11 +219,13 @@ void QtAudioOutput::onStartPlayback()
 
 void QtAudioOutput::onSuspendPlayback()
 {
+    TRACE_METHOD("qt", "QtAudioOutput");
     audioOutput_->suspend();
 }
 
 void QtAudioOutput::onStopPlayback()
 {
+    TRACE_METHOD("qt", "QtAudioOutput");
     if(playbackStarted_)
     {
         audioOutput_->stop();
@@ -117,5 +233,18 @@ void QtAudioOutput::onStopPlayback()
     }
 }
 
+void QtAudioOutput::onChangeVolume(qreal volume)
+{
+    audioOutput_->setVolume(volume);
+}
+
+void QtAudioOutput::onStateChanged(QAudio::State state)
+{
+    if(state == QAudio::IdleState && audioOutput_->error() == QAudio::UnderrunError)
+    {
+        ++underruns_;
+    }
+}
+
 }
 }
@@ -19,6 +19,7 @@
 #include <QApplication>
 #include "openauto/Projection/QtVideoOutput.hpp"
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 
 namespace openauto
 {
@@ -27,6 +28,8 @@ namespace projection
 
 QtVideoOutput::QtVideoOutput(configuration::IConfiguration::Pointer configuration, QWidget* videoContainer)
     : VideoOutput(std::move(configuration))
+    // dropping bytes would corrupt the bitstream, the player is given time to catch up instead
+    , videoBuffer_(aasdk::common::cStaticDataSize, RingBufferOverflowPolicy::BLOCK)
     , videoContainer_(videoContainer)
 {
     this->moveToThread(QApplication::instance()->thread());
@@ -38,6 +41,7 @@ QtVideoOutput::QtVideoOutput(configuration::IConfiguration::Pointer configuratio
 
 void QtVideoOutput::createVideoOutput()
 {
+    TRACE_METHOD("qt", "QtVideoOutput");
     LOG(debug) << "create.";
     videoWidget_ = std::make_unique<QVideoWidget>(videoContainer_);
     mediaPlayer_ = std::make_unique<QMediaPlayer>(nullptr, QMediaPlayer::StreamPlayback);
@@ -75,6 +79,7 @@ void QtVideoOutput::resize()
 
 void QtVideoOutput::onStartPlayback()
 {
+    TRACE_METHOD("qt", "QtVideoOutput");
     if(videoContainer_ == nullptr)
     {
         videoWidget_->setAspectRatioMode(Qt::IgnoreAspectRatio);
@@ -95,6 +100,7 @@ void QtVideoOutput::onStartPlayback()
 
 void QtVideoOutput::onStopPlayback()
 {
+    TRACE_METHOD("qt", "QtVideoOutput");
     videoWidget_->hide();
     mediaPlayer_->stop();
 }
@@ -0,0 +1,231 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <limits>
+#include "openauto/Projection/QueuedVideoOutput.hpp"
+#include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+constexpr std::chrono::milliseconds QueuedVideoOutput::cMaxSlotWait;
+constexpr std::chrono::milliseconds QueuedVideoOutput::cSlotPollInterval;
+constexpr std::chrono::milliseconds QueuedVideoOutput::cIdleTimeout;
+
+QueuedVideoOutput::QueuedVideoOutput(IVideoOutput::Pointer output, uint64_t latencyBudget)
+    : output_(std::move(output))
+    , latencyBudget_(latencyBudget)
+    , queue_(cQueueCapacity)
+    , dropPolicy_(latencyBudget)
+    , queuedFrames_(0)
+    , overflows_(0)
+    , maxDepth_(0)
+    , running_(false)
+    , waiting_(false)
+{
+    output_->setFrameDropping(false);
+}
+
+QueuedVideoOutput::~QueuedVideoOutput()
+{
+    this->stopSubmission();
+}
+
+bool QueuedVideoOutput::open()
+{
+    return output_->open();
+}
+
+bool QueuedVideoOutput::init()
+{
+    const bool result = output_->init();
+
+    if(!running_)
+    {
+        dropPolicy_.reset();
+        queuedFrames_ = 0;
+        overflows_ = 0;
+        maxDepth_ = 0;
+        running_ = true;
+        thread_ = std::thread(&QueuedVideoOutput::run, this);
+    }
+
+    return result;
+}
+
+void QueuedVideoOutput::write(uint64_t timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    const auto now = VideoFrameQueue::Clock::now();
+    const auto type = FrameDropPolicy::classify(buffer.cdata, buffer.size);
+    VideoFrame* frame = queue_.acquire();
+
+    if(frame == nullptr)
+    {
+        ++overflows_;
+    }
+
+    // a full queue counts as far behind, however young its frames are
+    const uint64_t queuedLatency = frame == nullptr ? std::numeric_limits<uint64_t>::max() : queue_.getOldestAge(now).count() + output_->getQueuedLatency();
+    if(dropPolicy_.shouldDrop(type, queuedLatency))
+    {
+        output_->getLatencyTracker()->onDropped();
+        return;
+    }
+
+    if(frame == nullptr && (frame = this->waitForSlot()) == nullptr)
+    {
+        // an IDR or parameter set that does not fit, the decoder can only pick up again at the next IDR
+        dropPolicy_.skipToIdr();
+        output_->getLatencyTracker()->onDropped();
+        return;
+    }
+
+    frame->timestamp = timestamp;
+    frame->received = now;
+    frame->data.assign(buffer.cdata, buffer.cdata + buffer.size);
+    queue_.push();
+    ++queuedFrames_;
+    maxDepth_ = std::max(maxDepth_, queue_.size());
+
+    if(waiting_)
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        condition_.notify_one();
+    }
+}
+
+void QueuedVideoOutput::stop()
+{
+    this->stopSubmission();
+
+    const auto statistics = dropPolicy_.getStatistics();
+    LOG(info) << "[QueuedVideoOutput] stopped, frames: " << queuedFrames_
+              << ", max depth: " << maxDepth_ << "/" << queue_.getCapacity()
+              << ", overflows: " << overflows_
+              << ", dropped non-reference: " << statistics.droppedNonReference
+              << ", dropped until IDR: " << statistics.droppedUntilIdr
+              << ", skips to IDR: " << statistics.skipsToIdr;
+
+    output_->stop();
+}
+
+aasdk::proto::enums::VideoFPS::Enum QueuedVideoOutput::getVideoFPS() const
+{
+    return output_->getVideoFPS();
+}
+
+aasdk::proto::enums::VideoResolution::Enum QueuedVideoOutput::getVideoResolution() const
+{
+    return output_->getVideoResolution();
+}
+
+size_t QueuedVideoOutput::getScreenDPI() const
+{
+    return output_->getScreenDPI();
+}
+
+QRect QueuedVideoOutput::getVideoMargins() const
+{
+    return output_->getVideoMargins();
+}
+
+VideoLatencyTracker::Pointer QueuedVideoOutput::getLatencyTracker() const
+{
+    return output_->getLatencyTracker();
+}
+
+bool QueuedVideoOutput::isBackpressured() const
+{
+    // acks are held back once half of the queue is in use, the phone then slows down before frames are dropped
+    return queue_.size() * 2 >= queue_.getCapacity() || output_->isBackpressured();
+}
+
+uint64_t QueuedVideoOutput::getQueuedLatency() const
+{
+    return queue_.getOldestAge(VideoFrameQueue::Clock::now()).count() + output_->getQueuedLatency();
+}
+
+void QueuedVideoOutput::setFrameDropping(bool enabled)
+{
+    dropPolicy_.setEnabled(enabled);
+}
+
+void QueuedVideoOutput::run()
+{
+    trace::Tracer::setThreadName("video-submit");
+
+    while(running_)
+    {
+        VideoFrame* frame = queue_.front();
+
+        if(frame == nullptr)
+        {
+            // the timeout covers a push that raced with going to sleep
+            std::unique_lock<decltype(mutex_)> lock(mutex_);
+            waiting_ = true;
+            condition_.wait_for(lock, cIdleTimeout, [this]() { return !running_ || queue_.size() > 0; });
+            waiting_ = false;
+            continue;
+        }
+
+        {
+            TRACE_SCOPE_VALUE("output", "video submit", "size", frame->data.size());
+            output_->write(frame->timestamp, aasdk::common::DataConstBuffer(frame->data.data(), frame->data.size()));
+        }
+
+        queue_.pop();
+    }
+}
+
+VideoFrame* QueuedVideoOutput::waitForSlot()
+{
+    // without a budget nothing may be dropped, wait like the synchronous write did
+    const auto deadline = VideoFrameQueue::Clock::now() + cMaxSlotWait;
+    VideoFrame* frame = nullptr;
+
+    while(running_ && (frame = queue_.acquire()) == nullptr && (latencyBudget_ == 0 || VideoFrameQueue::Clock::now() < deadline))
+    {
+        std::this_thread::sleep_for(cSlotPollInterval);
+    }
+
+    return frame;
+}
+
+void QueuedVideoOutput::stopSubmission()
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        running_ = false;
+    }
+    condition_.notify_one();
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    queue_.clear();
+}
+
+}
+}
@@ -0,0 +1,225 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "openauto/Projection/RingBuffer.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+namespace
+{
+
+constexpr std::chrono::milliseconds cBlockTimeout(100);
+constexpr std::chrono::milliseconds cBlockPollInterval(1);
+
+size_t roundUpToPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while(result < value)
+    {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+}
+
+RingBuffer::RingBuffer(size_t capacity, RingBufferOverflowPolicy policy, size_t alignment)
+    : data_(roundUpToPowerOfTwo(std::max(capacity, alignment)))
+    , mask_(data_.size() - 1)
+    , alignment_(std::max<size_t>(alignment, 1))
+    , policy_(policy)
+    , head_(0)
+    , tail_(0)
+    , overflows_(0)
+    , overflowBytes_(0)
+    , underflows_(0)
+{
+
+}
+
+size_t RingBuffer::write(const char* data, size_t size)
+{
+    const size_t capacity = data_.size();
+    size_t accepted = size;
+    size_t dropped = 0;
+
+    if(policy_ == RingBufferOverflowPolicy::DROP_OLDEST && size > capacity)
+    {
+        dropped = size - capacity;
+        data += dropped;
+        accepted = capacity;
+    }
+
+    const size_t head = head_.load(std::memory_order_relaxed);
+    size_t used = head - tail_.load(std::memory_order_acquire);
+
+    if(capacity - used < accepted)
+    {
+        if(policy_ == RingBufferOverflowPolicy::BLOCK)
+        {
+            used = this->waitForSpace(head, accepted);
+        }
+
+        if(policy_ == RingBufferOverflowPolicy::DROP_OLDEST)
+        {
+            dropped += this->discardOldest(head, accepted);
+        }
+        else if(capacity - used < accepted)
+        {
+            dropped += accepted - (capacity - used);
+            accepted = capacity - used;
+        }
+    }
+
+    if(dropped > 0)
+    {
+        ++overflows_;
+        overflowBytes_ += dropped;
+    }
+
+    this->copyIn(head, data, accepted);
+    head_.store(head + accepted, std::memory_order_release);
+    return accepted;
+}
+
+size_t RingBuffer::read(char* data, size_t size)
+{
+    size_t tail = tail_.load(std::memory_order_acquire);
+    size_t count = 0;
+
+    while(true)
+    {
+        count = std::min(size, head_.load(std::memory_order_acquire) - tail);
+        this->copyOut(tail, data, count);
+
+        // the writer may have discarded the bytes or clear() dropped them while they were copied, then
+        // the copy is stale and has to be repeated from the new tail, the same way a seqlock reader retries
+        if(tail_.compare_exchange_strong(tail, tail + count, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            break;
+        }
+    }
+
+    if(count < size)
+    {
+        ++underflows_;
+    }
+
+    return count;
+}
+
+void RingBuffer::clear()
+{
+    const size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_acquire);
+
+    while(tail < head && !tail_.compare_exchange_weak(tail, head, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+    }
+}
+
+size_t RingBuffer::getCapacity() const
+{
+    return data_.size();
+}
+
+size_t RingBuffer::getFillLevel() const
+{
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return head_.load(std::memory_order_acquire) - tail;
+}
+
+size_t RingBuffer::getFreeSpace() const
+{
+    return data_.size() - this->getFillLevel();
+}
+
+RingBufferOverflowPolicy RingBuffer::getPolicy() const
+{
+    return policy_;
+}
+
+RingBufferStatistics RingBuffer::getStatistics() const
+{
+    RingBufferStatistics statistics;
+    statistics.capacity = data_.size();
+    statistics.fillLevel = this->getFillLevel();
+    statistics.overflows = overflows_;
+    statistics.overflowBytes = overflowBytes_;
+    statistics.underflows = underflows_;
+    return statistics;
+}
+
+size_t RingBuffer::waitForSpace(size_t head, size_t size) const
+{
+    const auto deadline = std::chrono::steady_clock::now() + cBlockTimeout;
+    size_t used = head - tail_.load(std::memory_order_acquire);
+
+    while(data_.size() - used < size && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(cBlockPollInterval);
+        used = head - tail_.load(std::memory_order_acquire);
+    }
+
+    return used;
+}
+
+size_t RingBuffer::discardOldest(size_t head, size_t size)
+{
+    size_t tail = tail_.load(std::memory_order_acquire);
+
+    // the reader keeps advancing the tail meanwhile, so only move it as far as still needed
+    while(data_.size() - (head - tail) < size)
+    {
+        const size_t newTail = (head + size - data_.size() + alignment_ - 1) / alignment_ * alignment_;
+        if(tail_.compare_exchange_weak(tail, newTail, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return newTail - tail;
+        }
+    }
+
+    return 0;
+}
+
+void RingBuffer::copyIn(size_t position, const char* data, size_t size)
+{
+    const size_t offset = position & mask_;
+    const size_t first = std::min(size, data_.size() - offset);
+    std::memcpy(data_.data() + offset, data, first);
+    std::memcpy(data_.data(), data + first, size - first);
+}
+
+void RingBuffer::copyOut(size_t position, char* data, size_t size) const
+{
+    const size_t offset = position & mask_;
+    const size_t first = std::min(size, data_.size() - offset);
+    std::memcpy(data, data_.data() + offset, first);
+    std::memcpy(data + first, data_.data(), size - first);
+}
+
+}
+}
@@ -16,6 +16,8 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cstring>
 #include "openauto/Projection/RtAudioOutput.hpp"
 #include "OpenautoLog.hpp"
 
@@ -24,11 +26,22 @@ namespace openauto
 namespace projection
 {
 
+constexpr size_t RtAudioOutput::cFadeFrames;
+
 RtAudioOutput::RtAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
     : channelCount_(channelCount)
     , sampleSize_(sampleSize)
     , sampleRate_(sampleRate)
+    , audioBuffer_(aasdk::common::cStaticDataSize, RingBufferOverflowPolicy::DROP_OLDEST, channelCount * sampleSize / 8)
+    , lastWriteSize_(0)
+    , underruns_(0)
+    , lateCallbacks_(0)
+    , concealing_(true)
+    , gainRamp_(sampleRate, channelCount)
+    , driftCompensator_(sampleRate, channelCount)
 {
+    lastFrame_.fill(0);
+
     std::vector<RtAudio::Api> apis;
     RtAudio::getCompiledApi(apis);
     dac_ = std::find(apis.begin(), apis.end(), RtAudio::LINUX_PULSE) == apis.end() ? std::make_unique<RtAudio>() : std::make_unique<RtAudio>(RtAudio::LINUX_PULSE);
@@ -38,7 +51,11 @@ bool RtAudioOutput::open()
 {
     std::lock_guard<decltype(mutex_)> lock(mutex_);
 
-    if(dac_->getDeviceCount() > 0)
+    if(channelCount_ > cMaxChannelCount || sampleSize_ != 16)
+    {
+        LOG(error) << "Unsupported audio format, channels: " << channelCount_ << ", sample size: " << sampleSize_;
+    }
+    else if(dac_->getDeviceCount() > 0)
     {
         RtAudio::StreamParameters parameters;
         parameters.deviceId = dac_->getDefaultOutputDevice();
@@ -47,11 +64,35 @@ bool RtAudioOutput::open()
 
         try
         {
+            // open the device the way it runs anyway so the sound server does not convert in another process
+            const auto deviceInfo = dac_->getDeviceInfo(parameters.deviceId);
+            const uint32_t deviceRate = deviceInfo.preferredSampleRate > 0 ? deviceInfo.preferredSampleRate : sampleRate_;
+            parameters.nChannels = channelCount_ == 1 && deviceInfo.outputChannels >= 2 ? 2 : channelCount_;
+
             RtAudio::StreamOptions streamOptions;
             streamOptions.flags = RTAUDIO_MINIMIZE_LATENCY | RTAUDIO_SCHEDULE_REALTIME;
             uint32_t bufferFrames = sampleRate_ == 16000 ? 1024 : 2048; //according to the observation of audio packets
-            dac_->openStream(&parameters, nullptr, RTAUDIO_SINT16, sampleRate_, &bufferFrames, &RtAudioOutput::audioBufferReadHandler, static_cast<void*>(this), &streamOptions);
-            return audioBuffer_.open(QIODevice::ReadWrite);
+            bufferFrames = static_cast<uint32_t>(static_cast<uint64_t>(bufferFrames) * deviceRate / sampleRate_);
+            dac_->openStream(&parameters, nullptr, RTAUDIO_SINT16, deviceRate, &bufferFrames, &RtAudioOutput::audioBufferReadHandler, static_cast<void*>(this), &streamOptions);
+
+            if(deviceRate != sampleRate_ || parameters.nChannels != channelCount_)
+            {
+                const size_t stagingFrames = static_cast<size_t>(static_cast<uint64_t>(bufferFrames) * sampleRate_ / deviceRate) + 2;
+                staging_.assign(stagingFrames * channelCount_, 0);
+                resampler_ = std::make_unique<AudioResampler>(sampleRate_, channelCount_, deviceRate, parameters.nChannels, stagingFrames);
+                LOG(info) << "Resampling audio output, stream: " << sampleRate_ << " Hz " << channelCount_ << " ch"
+                          << ", device: " << deviceRate << " Hz " << parameters.nChannels << " ch";
+            }
+            else
+            {
+                resampler_.reset();
+            }
+
+            audioBuffer_.clear();
+            driftCompensator_.reset();
+            concealing_ = true;
+            lastFrame_.fill(0);
+            return true;
         }
         catch(const RtAudioError& e)
         {
@@ -68,7 +109,9 @@ bool RtAudioOutput::open()
 
 void RtAudioOutput::write(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
+    lastWriteSize_ = buffer.size;
     audioBuffer_.write(reinterpret_cast<const char*>(buffer.cdata), buffer.size);
+    driftCompensator_.onWrite(timestamp);
 }
 
 void RtAudioOutput::start()
@@ -97,6 +140,11 @@ void RtAudioOutput::stop()
     if(dac_->isStreamOpen())
     {
         dac_->closeStream();
+        const auto gainStatistics = gainRamp_.getStatistics();
+        LOG(info) << "Audio output stopped, underruns: " << underruns_ << ", late callbacks: " << lateCallbacks_
+                  << ", gain ramp avg: " << (gainStatistics.calls > 0 ? gainStatistics.totalTime / gainStatistics.calls : 0) << " ns"
+                  << ", max: " << gainStatistics.maxTime << " ns"
+                  << ", clock drift: " << driftCompensator_.getDrift() << " ppm";
     }
 }
 
@@ -105,6 +153,22 @@ void RtAudioOutput::suspend()
     //not needed
 }
 
+void RtAudioOutput::flush()
+{
+    // clearing from the writer side is safe, the ring drops the oldest bytes
+    audioBuffer_.clear();
+}
+
+void RtAudioOutput::setGain(float gain)
+{
+    gainRamp_.setTarget(gain);
+}
+
+void RtAudioOutput::setPlaybackObserver(PlaybackObserver observer)
+{
+    playbackObserver_ = std::move(observer);
+}
+
 uint32_t RtAudioOutput::getSampleSize() const
 {
     return sampleSize_;
@@ -120,6 +184,32 @@ uint32_t RtAudioOutput::getSampleRate() const
     return sampleRate_;
 }
 
+bool RtAudioOutput::isBackpressured() const
+{
+    // the ring overwrites unread samples when it overflows, so hold back once the next packet would not fit
+    return audioBuffer_.getFreeSpace() < lastWriteSize_;
+}
+
+size_t RtAudioOutput::getBufferedBytes() const
+{
+    return audioBuffer_.getFillLevel();
+}
+
+uint64_t RtAudioOutput::getUnderrunCount() const
+{
+    return underruns_;
+}
+
+uint64_t RtAudioOutput::getLateCallbackCount() const
+{
+    return lateCallbacks_;
+}
+
+double RtAudioOutput::getClockDrift() const
+{
+    return driftCompensator_.getDrift();
+}
+
 void RtAudioOutput::doSuspend()
 {
     if(dac_->isStreamOpen() && dac_->isStreamRunning())
@@ -135,14 +225,112 @@ void RtAudioOutput::doSuspend()
     }
 }
 
-int RtAudioOutput::audioBufferReadHandler(void* outputBuffer, void* inputBuffer, unsigned int nBufferFrames,
-                                          double streamTime, RtAudioStreamStatus status, void* userData)
+void RtAudioOutput::fill(int16_t* samples, size_t frameCount)
 {
+    const size_t frameSize = channelCount_ * sizeof(int16_t);
+    const size_t readFrames = driftCompensator_.read(audioBuffer_, samples, frameCount);
+    size_t filledFrames = readFrames;
+
+    // playback resumes after an underrun, ramp up instead of jumping to the signal
+    if(concealing_ && readFrames > 0)
+    {
+        const size_t fadeFrames = std::min(cFadeFrames, readFrames);
+        for(size_t frame = 0; frame < fadeFrames; ++frame)
+        {
+            for(size_t channel = 0; channel < channelCount_; ++channel)
+            {
+                auto& sample = samples[frame * channelCount_ + channel];
+                sample = static_cast<int16_t>(sample * static_cast<int32_t>(frame) / static_cast<int32_t>(fadeFrames));
+            }
+        }
+        concealing_ = false;
+    }
+
+    if(readFrames < frameCount)
+    {
+        ++underruns_;
+
+        if(!concealing_)
+        {
+            if(readFrames > 0)
+            {
+                // fade out the tail of what arrived
+                const size_t fadeFrames = std::min(cFadeFrames, readFrames);
+                const size_t fadeStart = readFrames - fadeFrames;
+                for(size_t frame = 0; frame < fadeFrames; ++frame)
+                {
+                    for(size_t channel = 0; channel < channelCount_; ++channel)
+                    {
+                        auto& sample = samples[(fadeStart + frame) * channelCount_ + channel];
+                        sample = static_cast<int16_t>(sample * static_cast<int32_t>(fadeFrames - frame - 1) / static_cast<int32_t>(fadeFrames));
+                    }
+                }
+            }
+            else
+            {
+                // nothing arrived, decay from the last frame that was played
+                const size_t fadeFrames = std::min(cFadeFrames, frameCount);
+                for(size_t frame = 0; frame < fadeFrames; ++frame)
+                {
+                    for(size_t channel = 0; channel < channelCount_; ++channel)
+                    {
+                        samples[frame * channelCount_ + channel] = static_cast<int16_t>(lastFrame_[channel] * static_cast<int32_t>(fadeFrames - frame - 1) / static_cast<int32_t>(fadeFrames));
+                    }
+                }
+                filledFrames = fadeFrames;
+            }
+
+            concealing_ = true;
+        }
+
+        std::memset(samples + filledFrames * channelCount_, 0, (frameCount - filledFrames) * frameSize);
+    }
+    else
+    {
+        std::copy(samples + (frameCount - 1) * channelCount_, samples + frameCount * channelCount_, lastFrame_.begin());
+    }
+}
+
+void RtAudioOutput::notifyPlayback(const int16_t* samples, size_t frameCount)
+{
+    if(playbackObserver_)
+    {
+        playbackObserver_(reinterpret_cast<const char*>(samples), frameCount * channelCount_ * sizeof(int16_t), sampleRate_, channelCount_);
+    }
+}
+
+int RtAudioOutput::audioBufferReadHandler(void* outputBuffer, void*, unsigned int nBufferFrames,
+                                          double, RtAudioStreamStatus status, void* userData)
+{
+    // runs on the real-time audio thread: no locks, no allocations, nothing that may block
     RtAudioOutput* self = static_cast<RtAudioOutput*>(userData);
-    std::lock_guard<decltype(self->mutex_)> lock(self->mutex_);
 
-    const auto bufferSize = nBufferFrames * (self->sampleSize_ / 8) * self->channelCount_;
-    self->audioBuffer_.read(reinterpret_cast<char*>(outputBuffer), bufferSize);
+    if(status & RTAUDIO_OUTPUT_UNDERFLOW)
+    {
+        ++self->lateCallbacks_;
+    }
+
+    int16_t* output = static_cast<int16_t*>(outputBuffer);
+
+    if(self->resampler_ == nullptr)
+    {
+        self->fill(output, nBufferFrames);
+        self->gainRamp_.apply(output, nBufferFrames);
+        self->notifyPlayback(output, nBufferFrames);
+    }
+    else
+    {
+        // produce the stream frames this period needs, then convert them to the device format
+        const size_t frameCount = std::min(self->resampler_->getRequiredInputFrames(nBufferFrames), self->staging_.size() / self->channelCount_);
+        self->fill(self->staging_.data(), frameCount);
+        self->gainRamp_.apply(self->staging_.data(), frameCount);
+        self->notifyPlayback(self->staging_.data(), frameCount);
+        self->resampler_->write(self->staging_.data(), frameCount);
+
+        const size_t outputChannels = self->resampler_->getOutputChannels();
+        const size_t resampledFrames = self->resampler_->read(output, nBufferFrames);
+        std::fill(output + resampledFrames * outputChannels, output + nBufferFrames * outputChannels, 0);
+    }
     return 0;
 }
 
@@ -16,6 +16,7 @@
 *  along with openauto. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include "openauto/Projection/SequentialBuffer.hpp"
 
 namespace openauto
@@ -23,8 +24,8 @@ namespace openauto
 namespace projection
 {
 
-SequentialBuffer::SequentialBuffer()
-    : data_(aasdk::common::cStaticDataSize)
+SequentialBuffer::SequentialBuffer(size_t capacity, RingBufferOverflowPolicy policy, size_t alignment)
+    : data_(capacity, policy, alignment)
 {
 }
 
@@ -35,32 +36,45 @@ bool SequentialBuffer::isSequential() const
 
 bool SequentialBuffer::open(OpenMode mode)
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
-
     return QIODevice::open(mode);
 }
 
 qint64 SequentialBuffer::readData(char *data, qint64 maxlen)
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    qint64 size = 0;
+
+    if(driftCompensator_ != nullptr)
+    {
+        const size_t frameSize = driftCompensator_->getChannelCount() * sizeof(int16_t);
+        size = driftCompensator_->read(data_, reinterpret_cast<int16_t*>(data), maxlen / frameSize) * frameSize;
+    }
+    else
+    {
+        size = data_.read(data, maxlen);
+    }
 
-    if(data_.empty())
+    if(readObserver_)
     {
-        return 0;
+        readObserver_(data, size);
     }
 
-    const auto len = std::min<size_t>(maxlen, data_.size());
-    std::copy(data_.begin(), data_.begin() + len, data);
-    data_.erase_begin(len);
+    return size;
+}
 
-    return len;
+void SequentialBuffer::setReadObserver(std::function<void(const char* data, size_t size)> observer)
+{
+    readObserver_ = std::move(observer);
 }
 
-qint64 SequentialBuffer::writeData(const char *data, qint64 len)
+void SequentialBuffer::setDriftCompensator(ClockDriftCompensator::Pointer compensator)
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    driftCompensator_ = std::move(compensator);
+}
 
-    data_.insert(data_.end(), data, data + len);
+qint64 SequentialBuffer::writeData(const char *data, qint64 len)
+{
+    // bytes dropped by the overflow policy show up in the statistics, not as a short write
+    data_.write(data, len);
     emit readyRead();
     return len;
 }
@@ -70,6 +84,16 @@ qint64 SequentialBuffer::size() const
     return this->bytesAvailable();
 }
 
+qint64 SequentialBuffer::bytesFree() const
+{
+    return data_.getFreeSpace();
+}
+
+RingBufferStatistics SequentialBuffer::getStatistics() const
+{
+    return data_.getStatistics();
+}
+
 qint64 SequentialBuffer::pos() const
 {
     return 0;
@@ -94,9 +118,7 @@ bool SequentialBuffer::reset()
 
 qint64 SequentialBuffer::bytesAvailable() const
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
-
-    return QIODevice::bytesAvailable() + std::max<qint64>(1, data_.size());
+    return QIODevice::bytesAvailable() + std::max<qint64>(1, data_.getFillLevel());
 }
 
 bool SequentialBuffer::canReadLine() const
@@ -0,0 +1,236 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#include "openauto/Projection/VectorMath.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+namespace
+{
+
+// four lanes at a time for float and int16_t samples alike, so every kernel below is written once
+#if defined(__SSE2__)
+#define VECTOR_MATH_LANES
+
+typedef __m128 Lanes;
+
+inline Lanes splat(float value) { return _mm_set1_ps(value); }
+inline Lanes lanes(float first, float second, float third, float fourth) { return _mm_setr_ps(first, second, third, fourth); }
+inline Lanes add(Lanes first, Lanes second) { return _mm_add_ps(first, second); }
+inline Lanes multiply(Lanes first, Lanes second) { return _mm_mul_ps(first, second); }
+inline Lanes load(const float* values) { return _mm_loadu_ps(values); }
+inline void store(float* values, Lanes value) { _mm_storeu_ps(values, value); }
+
+inline Lanes load(const int16_t* values)
+{
+    const __m128i samples = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values));
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+}
+
+inline void store(int16_t* values, Lanes value)
+{
+    const __m128i samples = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f)));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(values), _mm_packs_epi32(samples, samples));
+}
+#elif defined(__ARM_NEON)
+#define VECTOR_MATH_LANES
+
+typedef float32x4_t Lanes;
+
+inline Lanes splat(float value) { return vdupq_n_f32(value); }
+inline Lanes add(Lanes first, Lanes second) { return vaddq_f32(first, second); }
+inline Lanes multiply(Lanes first, Lanes second) { return vmulq_f32(first, second); }
+inline Lanes load(const float* values) { return vld1q_f32(values); }
+inline void store(float* values, Lanes value) { vst1q_f32(values, value); }
+
+inline Lanes lanes(float first, float second, float third, float fourth)
+{
+    const float values[] = {first, second, third, fourth};
+    return vld1q_f32(values);
+}
+
+inline Lanes load(const int16_t* values)
+{
+    return vcvtq_f32_s32(vmovl_s16(vld1_s16(values)));
+}
+
+inline void store(int16_t* values, Lanes value)
+{
+    vst1_s16(values, vqmovn_s32(vcvtq_s32_f32(vminq_f32(vmaxq_f32(value, vdupq_n_f32(-32768.0f)), vdupq_n_f32(32767.0f)))));
+}
+#endif
+
+inline void storeSample(float* value, float sample)
+{
+    *value = sample;
+}
+
+inline void storeSample(int16_t* value, float sample)
+{
+    *value = static_cast<int16_t>(std::min(std::max(sample, -32768.0f), 32767.0f));
+}
+
+template<typename OutputType, typename InputType>
+void scaleInto(OutputType* output, const InputType* input, float factor, size_t count)
+{
+    size_t i = 0;
+
+#if defined(VECTOR_MATH_LANES)
+    const Lanes scale = splat(factor);
+    for(; i + 4 <= count; i += 4)
+    {
+        store(output + i, multiply(load(input + i), scale));
+    }
+#endif
+
+    for(; i < count; ++i)
+    {
+        storeSample(output + i, input[i] * factor);
+    }
+}
+
+template<typename SampleType>
+void rampInPlace(SampleType* values, float start, float step, size_t frameCount, uint32_t channelCount)
+{
+    const size_t count = frameCount * channelCount;
+    size_t i = 0;
+
+#if defined(VECTOR_MATH_LANES)
+    if(channelCount == 1 || channelCount == 2)
+    {
+        // frame number of every lane, counted in floats which stay exact far beyond any period
+        Lanes frames = channelCount == 1 ? lanes(1.0f, 2.0f, 3.0f, 4.0f) : lanes(1.0f, 1.0f, 2.0f, 2.0f);
+        const Lanes increment = splat(4.0f / channelCount);
+        const Lanes startGain = splat(start);
+        const Lanes stepGain = splat(step);
+
+        for(; i + 4 <= count; i += 4)
+        {
+            store(values + i, multiply(load(values + i), add(startGain, multiply(stepGain, frames))));
+            frames = add(frames, increment);
+        }
+    }
+#endif
+
+    for(; i < count; ++i)
+    {
+        storeSample(values + i, values[i] * (start + step * static_cast<float>(i / channelCount + 1)));
+    }
+}
+
+}
+
+float VectorMath::dot(const float* first, const float* second, size_t count)
+{
+    size_t i = 0;
+    float result = 0.0f;
+
+#if defined(__SSE__)
+    __m128 sum = _mm_setzero_ps();
+    for(; i + 4 <= count; i += 4)
+    {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(first + i), _mm_loadu_ps(second + i)));
+    }
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+    result = _mm_cvtss_f32(sum);
+#elif defined(__ARM_NEON)
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for(; i + 4 <= count; i += 4)
+    {
+        sum = vmlaq_f32(sum, vld1q_f32(first + i), vld1q_f32(second + i));
+    }
+    const float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    result = vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+
+    for(; i < count; ++i)
+    {
+        result += first[i] * second[i];
+    }
+
+    return result;
+}
+
+void VectorMath::multiplyAdd(float* accumulator, const float* values, float factor, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE__)
+    const __m128 scale = _mm_set1_ps(factor);
+    for(; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(accumulator + i, _mm_add_ps(_mm_loadu_ps(accumulator + i), _mm_mul_ps(scale, _mm_loadu_ps(values + i))));
+    }
+#elif defined(__ARM_NEON)
+    for(; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(accumulator + i, vmlaq_n_f32(vld1q_f32(accumulator + i), vld1q_f32(values + i), factor));
+    }
+#endif
+
+    for(; i < count; ++i)
+    {
+        accumulator[i] += factor * values[i];
+    }
+}
+
+void VectorMath::scale(float* values, float factor, size_t count)
+{
+    scaleInto(values, values, factor, count);
+}
+
+void VectorMath::scale(int16_t* values, float factor, size_t count)
+{
+    scaleInto(values, values, factor, count);
+}
+
+void VectorMath::convert(int16_t* output, const float* input, float factor, size_t count)
+{
+    scaleInto(output, input, factor, count);
+}
+
+void VectorMath::convert(float* output, const int16_t* input, float factor, size_t count)
+{
+    scaleInto(output, input, factor, count);
+}
+
+void VectorMath::ramp(float* values, float start, float step, size_t frameCount, uint32_t channelCount)
+{
+    rampInPlace(values, start, step, frameCount, channelCount);
+}
+
+void VectorMath::ramp(int16_t* values, float start, float step, size_t frameCount, uint32_t channelCount)
+{
+    rampInPlace(values, start, step, frameCount, channelCount);
+}
+
+}
+}
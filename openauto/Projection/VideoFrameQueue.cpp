@@ -0,0 +1,98 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include "openauto/Projection/VideoFrameQueue.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+VideoFrameQueue::VideoFrameQueue(size_t capacity)
+    : slots_(std::max<size_t>(capacity, 1))
+    , head_(0)
+    , tail_(0)
+{
+
+}
+
+VideoFrame* VideoFrameQueue::acquire()
+{
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if(head - tail_.load(std::memory_order_acquire) >= slots_.size())
+    {
+        return nullptr;
+    }
+
+    return &slots_[head % slots_.size()];
+}
+
+void VideoFrameQueue::push()
+{
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+std::chrono::microseconds VideoFrameQueue::getOldestAge(Clock::time_point now) const
+{
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    if(head == tail)
+    {
+        return std::chrono::microseconds(0);
+    }
+
+    // only the producer writes the receive time, so reading it here cannot race
+    return std::chrono::duration_cast<std::chrono::microseconds>(now - slots_[tail % slots_.size()].received);
+}
+
+VideoFrame* VideoFrameQueue::front()
+{
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if(head_.load(std::memory_order_acquire) == tail)
+    {
+        return nullptr;
+    }
+
+    return &slots_[tail % slots_.size()];
+}
+
+void VideoFrameQueue::pop()
+{
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void VideoFrameQueue::clear()
+{
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+size_t VideoFrameQueue::size() const
+{
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return head_.load(std::memory_order_acquire) - tail;
+}
+
+size_t VideoFrameQueue::getCapacity() const
+{
+    return slots_.size();
+}
+
+}
+}
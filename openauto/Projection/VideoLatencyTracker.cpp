@@ -0,0 +1,216 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "openauto/Projection/VideoLatencyTracker.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+VideoLatencyTracker::VideoLatencyTracker()
+    : receivedHead_(0)
+    , receivedCount_(0)
+    , nextFrame_(0)
+    , pipelineMinLatency_(0)
+    , pipelineMaxLatency_(0)
+{
+}
+
+void VideoLatencyTracker::onReceived()
+{
+    const auto now = Clock::now();
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    // frames are handed to the output in the order they were received, the oldest entry is dropped
+    // when the output does not report pushes at all
+    received_[(receivedHead_ + receivedCount_) % cMaxFramesInFlight] = now;
+    if(receivedCount_ == cMaxFramesInFlight)
+    {
+        receivedHead_ = (receivedHead_ + 1) % cMaxFramesInFlight;
+    }
+    else
+    {
+        ++receivedCount_;
+    }
+}
+
+void VideoLatencyTracker::onPushed(uint64_t pts)
+{
+    const auto now = Clock::now();
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    Frame& frame = frames_[nextFrame_];
+    nextFrame_ = (nextFrame_ + 1) % cMaxFramesInFlight;
+
+    frame.pts = pts;
+    frame.pushed = now;
+    frame.decoded = Clock::time_point();
+    frame.received = now;
+    frame.valid = true;
+
+    if(receivedCount_ > 0)
+    {
+        frame.received = received_[receivedHead_];
+        receivedHead_ = (receivedHead_ + 1) % cMaxFramesInFlight;
+        --receivedCount_;
+        this->addSample(VideoLatencyStage::RECEIVE_TO_PUSH, frame.received, frame.pushed);
+    }
+}
+
+void VideoLatencyTracker::onDropped()
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    if(receivedCount_ > 0)
+    {
+        receivedHead_ = (receivedHead_ + 1) % cMaxFramesInFlight;
+        --receivedCount_;
+    }
+}
+
+void VideoLatencyTracker::onDecoded(uint64_t pts)
+{
+    const auto now = Clock::now();
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    Frame* frame = this->findFrame(pts);
+    if(frame != nullptr && frame->decoded == Clock::time_point())
+    {
+        frame->decoded = now;
+        this->addSample(VideoLatencyStage::PUSH_TO_DECODE, frame->pushed, now);
+    }
+}
+
+void VideoLatencyTracker::onRendered(uint64_t pts)
+{
+    const auto now = Clock::now();
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    Frame* frame = this->findFrame(pts);
+    if(frame != nullptr)
+    {
+        if(frame->decoded != Clock::time_point())
+        {
+            this->addSample(VideoLatencyStage::DECODE_TO_RENDER, frame->decoded, now);
+        }
+        this->addSample(VideoLatencyStage::RECEIVE_TO_RENDER, frame->received, now);
+        frame->valid = false;
+    }
+}
+
+void VideoLatencyTracker::setPipelineLatency(uint64_t minLatency, uint64_t maxLatency)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    pipelineMinLatency_ = minLatency;
+    pipelineMaxLatency_ = maxLatency;
+}
+
+VideoLatencyReport VideoLatencyTracker::getReport() const
+{
+    VideoLatencyReport report;
+
+    for(size_t i = 0; i < histograms_.size(); ++i)
+    {
+        report.stages[i] = histograms_[i].getPercentiles();
+    }
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    report.pipelineMinLatency = pipelineMinLatency_;
+    report.pipelineMaxLatency = pipelineMaxLatency_;
+    return report;
+}
+
+void VideoLatencyTracker::dump() const
+{
+    const auto report = this->getReport();
+
+    for(size_t i = 0; i < report.stages.size(); ++i)
+    {
+        const auto& stage = report.stages[i];
+        LOG(info) << "video latency " << stageName(static_cast<VideoLatencyStage>(i))
+                  << " [us], samples: " << stage.count
+                  << ", p50: " << stage.p50
+                  << ", p95: " << stage.p95
+                  << ", p99: " << stage.p99
+                  << ", max: " << stage.max;
+    }
+
+    LOG(info) << "video latency reported by pipeline [us], min: " << report.pipelineMinLatency
+              << ", max: " << report.pipelineMaxLatency;
+}
+
+void VideoLatencyTracker::reset()
+{
+    for(auto& histogram : histograms_)
+    {
+        histogram.reset();
+    }
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    receivedHead_ = 0;
+    receivedCount_ = 0;
+    for(auto& frame : frames_)
+    {
+        frame.valid = false;
+    }
+    pipelineMinLatency_ = 0;
+    pipelineMaxLatency_ = 0;
+}
+
+const char* VideoLatencyTracker::stageName(VideoLatencyStage stage)
+{
+    switch(stage)
+    {
+    case VideoLatencyStage::RECEIVE_TO_PUSH:
+        return "receive->push";
+    case VideoLatencyStage::PUSH_TO_DECODE:
+        return "push->decode";
+    case VideoLatencyStage::DECODE_TO_RENDER:
+        return "decode->render";
+    case VideoLatencyStage::RECEIVE_TO_RENDER:
+        return "receive->render";
+    default:
+        return "unknown";
+    }
+}
+
+VideoLatencyTracker::Frame* VideoLatencyTracker::findFrame(uint64_t pts)
+{
+    for(auto& frame : frames_)
+    {
+        if(frame.valid && frame.pts == pts)
+        {
+            return &frame;
+        }
+    }
+
+    return nullptr;
+}
+
+void VideoLatencyTracker::addSample(VideoLatencyStage stage, Clock::time_point from, Clock::time_point to)
+{
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    histograms_[static_cast<size_t>(stage)].add(elapsed > 0 ? static_cast<uint64_t>(elapsed) : 0);
+}
+
+}
+}
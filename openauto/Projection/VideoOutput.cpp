@@ -25,6 +25,7 @@ namespace projection
 
 VideoOutput::VideoOutput(configuration::IConfiguration::Pointer configuration)
     : configuration_(std::move(configuration))
+    , latencyTracker_(std::make_shared<VideoLatencyTracker>())
 {
 
 }
@@ -49,5 +50,25 @@ QRect VideoOutput::getVideoMargins() const
     return configuration_->getVideoMargins();
 }
 
+VideoLatencyTracker::Pointer VideoOutput::getLatencyTracker() const
+{
+    return latencyTracker_;
+}
+
+bool VideoOutput::isBackpressured() const
+{
+    return false;
+}
+
+uint64_t VideoOutput::getQueuedLatency() const
+{
+    return 0;
+}
+
+void VideoOutput::setFrameDropping(bool)
+{
+
+}
+
 }
 }
@@ -0,0 +1,110 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "openauto/Projection/WavFileAudioOutput.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace projection
+{
+
+namespace
+{
+
+void writeLittleEndian(std::ofstream& file, uint32_t value, size_t size)
+{
+    for(size_t i = 0; i < size; ++i)
+    {
+        file.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+}
+
+WavFileAudioOutput::WavFileAudioOutput(const std::string& path, uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate)
+    : NullAudioOutput(channelCount, sampleSize, sampleRate)
+    , path_(path)
+    , dataSize_(0)
+{
+
+}
+
+WavFileAudioOutput::~WavFileAudioOutput()
+{
+    this->stop();
+}
+
+bool WavFileAudioOutput::open()
+{
+    if(!file_.is_open())
+    {
+        file_.open(path_, std::ios::binary | std::ios::trunc);
+        if(!file_.is_open())
+        {
+            LOG(error) << "Failed to open audio file " << path_;
+            return false;
+        }
+
+        dataSize_ = 0;
+        this->writeHeader();
+    }
+
+    return NullAudioOutput::open();
+}
+
+void WavFileAudioOutput::stop()
+{
+    this->doStop();
+
+    if(file_.is_open())
+    {
+        file_.seekp(0);
+        this->writeHeader();
+        file_.close();
+        LOG(info) << "Wrote " << dataSize_ << " bytes of audio to " << path_;
+    }
+}
+
+void WavFileAudioOutput::onPeriod(const char* data, size_t size)
+{
+    file_.write(data, size);
+    dataSize_ += size;
+}
+
+void WavFileAudioOutput::writeHeader()
+{
+    const uint32_t blockAlign = this->getChannelCount() * this->getSampleSize() / 8;
+
+    file_.write("RIFF", 4);
+    writeLittleEndian(file_, 36 + dataSize_, 4);
+    file_.write("WAVEfmt ", 8);
+    writeLittleEndian(file_, 16, 4);
+    writeLittleEndian(file_, 1, 2);
+    writeLittleEndian(file_, this->getChannelCount(), 2);
+    writeLittleEndian(file_, this->getSampleRate(), 4);
+    writeLittleEndian(file_, this->getSampleRate() * blockAlign, 4);
+    writeLittleEndian(file_, blockAlign, 2);
+    writeLittleEndian(file_, this->getSampleSize(), 2);
+    file_.write("data", 4);
+    writeLittleEndian(file_, dataSize_, 4);
+}
+
+}
+}
@@ -19,6 +19,7 @@
 #include "aasdk/Channel/Control/ControlServiceChannel.hpp"
 #include "openauto/Service/AndroidAutoEntity.hpp"
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 
 namespace openauto
 {
@@ -31,6 +32,7 @@ AndroidAutoEntity::AndroidAutoEntity(boost::asio::io_service& ioService,
                                      aasdk::messenger::IMessenger::Pointer messenger,
                                      configuration::IConfiguration::Pointer configuration,
                                      ServiceList serviceList,
+                                     AudioFocusController::Pointer audioFocusController,
                                      IPinger::Pointer pinger)
     : strand_(ioService)
     , cryptor_(std::move(cryptor))
@@ -39,6 +41,7 @@ AndroidAutoEntity::AndroidAutoEntity(boost::asio::io_service& ioService,
     , controlServiceChannel_(std::make_shared<aasdk::channel::control::ControlServiceChannel>(strand_, messenger_))
     , configuration_(std::move(configuration))
     , serviceList_(std::move(serviceList))
+    , audioFocusController_(std::move(audioFocusController))
     , pinger_(std::move(pinger))
     , eventHandler_(nullptr)
 {
@@ -58,6 +61,7 @@ void AndroidAutoEntity::start(IAndroidAutoEntityEventHandler& eventHandler)
         std::for_each(serviceList_.begin(), serviceList_.end(), std::bind(&IService::start, std::placeholders::_1));
         this->schedulePing();
 
+        TRACE_INSTANT("entity", "version request");
         auto versionRequestPromise = aasdk::channel::SendPromise::defer(strand_);
         versionRequestPromise->then([]() {}, std::bind(&AndroidAutoEntity::onChannelError, this->shared_from_this(), std::placeholders::_1));
         controlServiceChannel_->sendVersionRequest(std::move(versionRequestPromise));
@@ -81,6 +85,7 @@ void AndroidAutoEntity::stop()
 
 void AndroidAutoEntity::onVersionResponse(uint16_t majorCode, uint16_t minorCode, aasdk::proto::enums::VersionResponseStatus::Enum status)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(info) << "version response, version: " << majorCode
                        << "." << minorCode
                        << ", status: " << status;
@@ -112,6 +117,7 @@ void AndroidAutoEntity::onVersionResponse(uint16_t majorCode, uint16_t minorCode
 
 void AndroidAutoEntity::onHandshake(const aasdk::common::DataConstBuffer& payload)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(info) << "Handshake, size: " << payload.size;
 
     try
@@ -129,6 +135,7 @@ void AndroidAutoEntity::onHandshake(const aasdk::common::DataConstBuffer& payloa
         else
         {
             LOG(info) << "Auth completed.";
+            TRACE_INSTANT("entity", "auth complete");
 
             aasdk::proto::messages::AuthCompleteIndication authCompleteIndication;
             authCompleteIndication.set_status(aasdk::proto::enums::Status::OK);
@@ -148,6 +155,7 @@ void AndroidAutoEntity::onHandshake(const aasdk::common::DataConstBuffer& payloa
 
 void AndroidAutoEntity::onServiceDiscoveryRequest(const aasdk::proto::messages::ServiceDiscoveryRequest& request)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(info) << "Discovery request, device name: " << request.device_name()
                        << ", brand: " << request.device_brand();
 
@@ -175,11 +183,10 @@ void AndroidAutoEntity::onServiceDiscoveryRequest(const aasdk::proto::messages::
 
 void AndroidAutoEntity::onAudioFocusRequest(const aasdk::proto::messages::AudioFocusRequest& request)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(info) << "requested audio focus, type: " << request.audio_focus_type();
 
-    aasdk::proto::enums::AudioFocusState::Enum audioFocusState =
-            request.audio_focus_type() == aasdk::proto::enums::AudioFocusType::RELEASE ? aasdk::proto::enums::AudioFocusState::LOSS
-                                                                                       : aasdk::proto::enums::AudioFocusState::GAIN;
+    aasdk::proto::enums::AudioFocusState::Enum audioFocusState = audioFocusController_->onFocusRequest(request.audio_focus_type());
 
     LOG(info) << "audio focus state: " << audioFocusState;
 
@@ -194,6 +201,7 @@ void AndroidAutoEntity::onAudioFocusRequest(const aasdk::proto::messages::AudioF
 
 void AndroidAutoEntity::onShutdownRequest(const aasdk::proto::messages::ShutdownRequest& request)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(info) << "Shutdown request, reason: " << request.reason();
 
     aasdk::proto::messages::ShutdownResponse response;
@@ -206,12 +214,14 @@ void AndroidAutoEntity::onShutdownRequest(const aasdk::proto::messages::Shutdown
 
 void AndroidAutoEntity::onShutdownResponse(const aasdk::proto::messages::ShutdownResponse&)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(info) << "Shutdown response ";
     this->triggerQuit();
 }
 
 void AndroidAutoEntity::onNavigationFocusRequest(const aasdk::proto::messages::NavigationFocusRequest& request)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(info) << "navigation focus request, type: " << request.type();
 
     aasdk::proto::messages::NavigationFocusResponse response;
@@ -225,6 +235,7 @@ void AndroidAutoEntity::onNavigationFocusRequest(const aasdk::proto::messages::N
 
 void AndroidAutoEntity::onVoiceSessionRequest(const aasdk::proto::messages::VoiceSessionRequest& request)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(info) << "Voice session request, type: " << ((request.type() == 1) ? "START" : ((request.type() == 2) ? "STOP" : "UNKNOWN"));
 
     auto promise = aasdk::channel::SendPromise::defer(strand_);
@@ -234,6 +245,7 @@ void AndroidAutoEntity::onVoiceSessionRequest(const aasdk::proto::messages::Voic
 
 void AndroidAutoEntity::onPingRequest(const aasdk::proto::messages::PingRequest& request)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(info) << "Ping Request";
 
     aasdk::proto::messages::PingResponse response;
@@ -246,12 +258,14 @@ void AndroidAutoEntity::onPingRequest(const aasdk::proto::messages::PingRequest&
 
 void AndroidAutoEntity::onPingResponse(const aasdk::proto::messages::PingResponse&)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     pinger_->pong();
     controlServiceChannel_->receive(this->shared_from_this());
 }
 
 void AndroidAutoEntity::onChannelError(const aasdk::error::Error& e)
 {
+    TRACE_METHOD("entity", "AndroidAutoEntity");
     LOG(error) << "channel error: " << e.what();
     this->triggerQuit();
 }
@@ -67,7 +67,7 @@ IAndroidAutoEntity::Pointer AndroidAutoEntityFactory::create(aasdk::transport::I
 
     auto serviceList = serviceFactory_.create(messenger);
     auto pinger(std::make_shared<Pinger>(ioService_, 5000));
-    return std::make_shared<AndroidAutoEntity>(ioService_, std::move(cryptor), std::move(transport), std::move(messenger), configuration_, std::move(serviceList), std::move(pinger));
+    return std::make_shared<AndroidAutoEntity>(ioService_, std::move(cryptor), std::move(transport), std::move(messenger), configuration_, std::move(serviceList), serviceFactory_.getAudioFocusController(), std::move(pinger));
 }
 
 }
@@ -0,0 +1,108 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "openauto/Service/AudioFocusController.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace service
+{
+
+AudioFocusController::AudioFocusController(float duckingGain)
+    : duckingGain_(duckingGain)
+    , focusType_(aasdk::proto::enums::AudioFocusType::NONE)
+    , ducked_(false)
+{
+
+}
+
+void AudioFocusController::registerOutput(aasdk::messenger::ChannelId channelId, projection::IAudioOutput::Pointer audioOutput)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    outputs_[channelId] = audioOutput;
+}
+
+aasdk::proto::enums::AudioFocusState::Enum AudioFocusController::onFocusRequest(aasdk::proto::enums::AudioFocusType::Enum focusType)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+    // the phone mixes its own streams, it only needs to hear that it owns the output
+    if(focusType == aasdk::proto::enums::AudioFocusType::RELEASE)
+    {
+        focusType_ = aasdk::proto::enums::AudioFocusType::NONE;
+        this->update();
+        return aasdk::proto::enums::AudioFocusState::LOSS;
+    }
+
+    focusType_ = focusType;
+    this->update();
+    return aasdk::proto::enums::AudioFocusState::GAIN;
+}
+
+void AudioFocusController::onChannelStarted(aasdk::messenger::ChannelId channelId)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    activeChannels_.insert(channelId);
+    this->update();
+}
+
+void AudioFocusController::onChannelStopped(aasdk::messenger::ChannelId channelId)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    activeChannels_.erase(channelId);
+    this->update();
+}
+
+bool AudioFocusController::isDucked() const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return ducked_;
+}
+
+void AudioFocusController::update()
+{
+    const bool ducked = activeChannels_.count(aasdk::messenger::ChannelId::SPEECH_AUDIO) > 0
+            || activeChannels_.count(aasdk::messenger::ChannelId::SYSTEM_AUDIO) > 0
+            || focusType_ == aasdk::proto::enums::AudioFocusType::GAIN_TRANSIENT
+            || focusType_ == aasdk::proto::enums::AudioFocusType::GAIN_NAVI;
+
+    if(ducked == ducked_)
+    {
+        return;
+    }
+
+    ducked_ = ducked;
+    LOG(info) << "[AudioFocusController] media " << (ducked_ ? "ducked" : "restored")
+              << ", focus: " << focusType_
+              << ", active channels: " << activeChannels_.size();
+
+    auto mediaOutput = outputs_.find(aasdk::messenger::ChannelId::MEDIA_AUDIO);
+    if(mediaOutput != outputs_.end())
+    {
+        auto audioOutput = mediaOutput->second.lock();
+        if(audioOutput != nullptr)
+        {
+            audioOutput->setGain(ducked_ ? duckingGain_ : 1.0f);
+        }
+    }
+}
+
+}
+}
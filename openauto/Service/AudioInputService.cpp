@@ -18,7 +18,9 @@
 
 #include <time.h>
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 #include "openauto/Service/AudioInputService.hpp"
+#include "openauto/Service/SendPromisePool.hpp"
 
 namespace openauto
 {
@@ -45,7 +47,8 @@ void AudioInputService::start()
 void AudioInputService::stop()
 {
     strand_.dispatch([this, self = this->shared_from_this()]() {
-        LOG(info) << "stop.";
+        LOG(info) << "stop, input overruns: " << audioInput_->getOverrunCount()
+                  << ", dropped frames: " << audioInput_->getDroppedFrameCount();
         audioInput_->stop();
     });
 }
@@ -68,6 +71,7 @@ void AudioInputService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryRes
 
 void AudioInputService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
+    TRACE_METHOD("service", "AudioInputService");
     LOG(info) << "open request, priority: " << request.priority();
     const aasdk::proto::enums::Status::Enum status = audioInput_->open() ? aasdk::proto::enums::Status::OK : aasdk::proto::enums::Status::FAIL;
     LOG(info) << "open status: " << status;
@@ -84,6 +88,7 @@ void AudioInputService::onChannelOpenRequest(const aasdk::proto::messages::Chann
 
 void AudioInputService::onAVChannelSetupRequest(const aasdk::proto::messages::AVChannelSetupRequest& request)
 {
+    TRACE_METHOD("service", "AudioInputService");
     LOG(info) << "setup request, config index: " << request.config_index();
     const aasdk::proto::enums::AVChannelSetupStatus::Enum status = aasdk::proto::enums::AVChannelSetupStatus::OK;
     LOG(info) << "setup status: " << status;
@@ -103,6 +108,7 @@ void AudioInputService::onAVChannelSetupRequest(const aasdk::proto::messages::AV
 
 void AudioInputService::onAVInputOpenRequest(const aasdk::proto::messages::AVInputOpenRequest& request)
 {
+    TRACE_METHOD("service", "AudioInputService");
     LOG(info) << "input open request, open: " << request.open()
                        << ", anc: " << request.anc()
                        << ", ec: " << request.ec()
@@ -110,6 +116,8 @@ void AudioInputService::onAVInputOpenRequest(const aasdk::proto::messages::AVInp
 
     if(request.open())
     {
+        audioInput_->setSignalProcessing(request.ec(), request.anc());
+
         auto startPromise = projection::IAudioInput::StartPromise::defer(strand_);
         startPromise->then(std::bind(&AudioInputService::onAudioInputOpenSucceed, this->shared_from_this()),
             [this, self = this->shared_from_this()]() {
@@ -144,16 +152,19 @@ void AudioInputService::onAVInputOpenRequest(const aasdk::proto::messages::AVInp
 
 void AudioInputService::onAVMediaAckIndication(const aasdk::proto::messages::AVMediaAckIndication&)
 {
+    TRACE_METHOD("service", "AudioInputService");
     channel_->receive(this->shared_from_this());
 }
 
 void AudioInputService::onChannelError(const aasdk::error::Error& e)
 {
+    TRACE_METHOD("service", "AudioInputService");
     LOG(error) << "channel error: " << e.what();
 }
 
 void AudioInputService::onAudioInputOpenSucceed()
 {
+    TRACE_METHOD("service", "AudioInputService");
     LOG(info) << "audio input open succeed.";
 
     aasdk::proto::messages::AVInputOpenResponse response;
@@ -167,14 +178,17 @@ void AudioInputService::onAudioInputOpenSucceed()
     this->readAudioInput();
 }
 
-void AudioInputService::onAudioInputDataReady(aasdk::common::Data data)
+void AudioInputService::onAudioInputDataReady(projection::AudioInputChunk chunk)
 {
-    auto sendPromise = aasdk::channel::SendPromise::defer(strand_);
+    TRACE_METHOD("service", "AudioInputService");
+    // the resolve handler has to keep the service alive for the next read, only the promise is pooled
+    auto sendPromise = SendPromisePool::defer(strand_);
     sendPromise->then(std::bind(&AudioInputService::readAudioInput, this->shared_from_this()),
                      std::bind(&AudioInputService::onChannelError, this->shared_from_this(), std::placeholders::_1));
 
-    auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch());
-    channel_->sendAVMediaWithTimestampIndication(timestamp.count(), std::move(data), std::move(sendPromise));
+    // the message gets its own copy of the payload, the chunk can go back to the pool right away
+    channel_->sendAVMediaWithTimestampIndication(chunk.timestamp, chunk.data, std::move(sendPromise));
+    audioInput_->release(std::move(chunk.data));
 }
 
 void AudioInputService::readAudioInput()
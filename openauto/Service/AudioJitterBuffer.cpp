@@ -0,0 +1,185 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstdlib>
+#include "openauto/Service/AudioJitterBuffer.hpp"
+
+namespace openauto
+{
+namespace service
+{
+
+namespace
+{
+
+// timestamps further off than this are a new timeline, not late or lost packets
+constexpr uint64_t cMaxTimestampJump = 1000000;
+constexpr uint64_t cGapTolerance = 1000;
+constexpr uint64_t cUnderrunStep = 10000;
+constexpr std::chrono::seconds cUnderrunDecayInterval(10);
+
+}
+
+constexpr std::chrono::microseconds AudioJitterBuffer::cMinTarget;
+constexpr std::chrono::microseconds AudioJitterBuffer::cMaxTarget;
+
+AudioJitterBuffer::AudioJitterBuffer()
+    : sampleRate_(0)
+    , frameSize_(0)
+{
+    this->reset();
+}
+
+void AudioJitterBuffer::setFormat(uint32_t sampleRate, uint32_t frameSize)
+{
+    sampleRate_ = sampleRate;
+    frameSize_ = frameSize;
+}
+
+AudioJitterDecision AudioJitterBuffer::onPacket(uint64_t timestamp, size_t size, size_t bufferedBytes, uint64_t underruns)
+{
+    AudioJitterDecision decision;
+    if(sampleRate_ == 0 || frameSize_ == 0)
+    {
+        return decision;
+    }
+
+    ++statistics_.packets;
+    const auto arrival = Clock::now();
+    const uint64_t packetDuration = this->toDuration(size);
+
+    // packets without a timestamp only take part in the depth control
+    if(timestamp != 0)
+    {
+        if(synchronized_ && timestamp + cMaxTimestampJump > nextTimestamp_ && timestamp + packetDuration <= nextTimestamp_)
+        {
+            ++statistics_.latePackets;
+            decision.drop = true;
+            return decision;
+        }
+
+        if(synchronized_ && (timestamp + cMaxTimestampJump <= nextTimestamp_ || timestamp > nextTimestamp_ + cMaxTimestampJump))
+        {
+            ++statistics_.discontinuities;
+            synchronized_ = false;
+        }
+        else if(synchronized_ && timestamp > nextTimestamp_ + cGapTolerance)
+        {
+            ++statistics_.missingPackets;
+        }
+
+        this->updateJitter(timestamp, arrival);
+        nextTimestamp_ = timestamp + packetDuration;
+    }
+
+    this->updateTarget(packetDuration, underruns);
+    statistics_.depth = this->toDuration(bufferedBytes);
+
+    if(bufferedBytes == 0)
+    {
+        // the output ran dry or just started, build up the cushion again in one go
+        if(statistics_.target > packetDuration)
+        {
+            decision.silenceBytes = this->toBytes(statistics_.target - packetDuration);
+            statistics_.insertedBytes += decision.silenceBytes;
+        }
+    }
+    else if(statistics_.depth > statistics_.target + std::max(packetDuration, static_cast<uint64_t>(cMinTarget.count())))
+    {
+        decision.skipBytes = std::min(size, this->toBytes(statistics_.depth - statistics_.target));
+        statistics_.skippedBytes += decision.skipBytes;
+    }
+
+    return decision;
+}
+
+void AudioJitterBuffer::reset()
+{
+    synchronized_ = false;
+    nextTimestamp_ = 0;
+    lastTransit_ = 0;
+    jitter_ = 0;
+    underrunFloor_ = 0;
+    lastUnderruns_ = 0;
+    lastUnderrunTime_ = Clock::now();
+    statistics_ = AudioJitterStatistics();
+    statistics_.target = cMinTarget.count();
+}
+
+AudioJitterStatistics AudioJitterBuffer::getStatistics() const
+{
+    return statistics_;
+}
+
+uint64_t AudioJitterBuffer::toDuration(size_t bytes) const
+{
+    return static_cast<uint64_t>(bytes / frameSize_) * 1000000 / sampleRate_;
+}
+
+size_t AudioJitterBuffer::toBytes(uint64_t duration) const
+{
+    return static_cast<size_t>(duration * sampleRate_ / 1000000) * frameSize_;
+}
+
+void AudioJitterBuffer::updateJitter(uint64_t timestamp, Clock::time_point arrival)
+{
+    const auto arrivalTime = std::chrono::duration_cast<std::chrono::microseconds>(arrival.time_since_epoch()).count();
+    const int64_t transit = arrivalTime - static_cast<int64_t>(timestamp);
+
+    if(synchronized_)
+    {
+        // interarrival jitter estimate as in RFC 3550
+        jitter_ += (std::llabs(transit - lastTransit_) - jitter_) / 16.0;
+    }
+
+    lastTransit_ = transit;
+    synchronized_ = true;
+    statistics_.jitter = static_cast<uint64_t>(jitter_);
+}
+
+void AudioJitterBuffer::updateTarget(uint64_t packetDuration, uint64_t underruns)
+{
+    const auto now = Clock::now();
+
+    // the counter of the output keeps running across sessions
+    if(statistics_.packets == 1)
+    {
+        lastUnderruns_ = underruns;
+    }
+
+    if(underruns > lastUnderruns_)
+    {
+        underrunFloor_ += cUnderrunStep * (underruns - lastUnderruns_);
+        lastUnderrunTime_ = now;
+    }
+    else if(now - lastUnderrunTime_ >= cUnderrunDecayInterval && underrunFloor_ > 0)
+    {
+        // a quiet stretch, give back some of the latency added for earlier underruns
+        underrunFloor_ -= std::min(underrunFloor_, cUnderrunStep);
+        lastUnderrunTime_ = now;
+    }
+    lastUnderruns_ = underruns;
+
+    const uint64_t target = std::max(packetDuration + static_cast<uint64_t>(4 * jitter_), underrunFloor_);
+    statistics_.target = std::min<uint64_t>(std::max<uint64_t>(target, cMinTarget.count()), cMaxTarget.count());
+}
+
+}
+}
@@ -17,20 +17,30 @@
 */
 
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 #include "openauto/Service/AudioService.hpp"
+#include "openauto/Service/SendPromisePool.hpp"
 
 namespace openauto
 {
 namespace service
 {
 
-AudioService::AudioService(boost::asio::io_service& ioService, aasdk::channel::av::IAudioServiceChannel::Pointer channel, projection::IAudioOutput::Pointer audioOutput)
+AudioService::AudioService(boost::asio::io_service& ioService, aasdk::channel::av::IAudioServiceChannel::Pointer channel, projection::IAudioOutput::Pointer audioOutput, uint32_t maxUnacked, capture::CaptureWriter::Pointer captureWriter, AudioFocusController::Pointer audioFocusController)
     : strand_(ioService)
     , channel_(std::move(channel))
     , audioOutput_(std::move(audioOutput))
     , session_(-1)
+    , ackWindow_(maxUnacked)
+    , ackTimer_(ioService)
+    , ackTimerPending_(false)
+    , captureWriter_(std::move(captureWriter))
+    , audioFocusController_(std::move(audioFocusController))
 {
-
+    if(audioFocusController_ != nullptr)
+    {
+        audioFocusController_->registerOutput(channel_->getId(), audioOutput_);
+    }
 }
 
 void AudioService::start()
@@ -45,7 +55,15 @@ void AudioService::stop()
 {
     strand_.dispatch([this, self = this->shared_from_this()]() {
         LOG(info) << "stop, channel: " << aasdk::messenger::channelIdToString(channel_->getId());
+        ackTimer_.cancel();
+        this->dumpAckStatistics();
+        this->dumpJitterStatistics();
         audioOutput_->stop();
+
+        if(audioFocusController_ != nullptr)
+        {
+            audioFocusController_->onChannelStopped(channel_->getId());
+        }
     });
 }
 
@@ -86,6 +104,7 @@ void AudioService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse
 
 void AudioService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
+    TRACE_METHOD("service", "AudioService");
     LOG(info) << "open request"
                        << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
                        << ", priority: " << request.priority();
@@ -99,6 +118,11 @@ void AudioService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpe
     LOG(info) << "open status: " << status
                        << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId());
 
+    if(captureWriter_ != nullptr)
+    {
+        captureWriter_->writeFormat(channel_->getId(), audioOutput_->getSampleRate(), audioOutput_->getChannelCount(), audioOutput_->getSampleSize());
+    }
+
     aasdk::proto::messages::ChannelOpenResponse response;
     response.set_status(status);
 
@@ -110,6 +134,7 @@ void AudioService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpe
 
 void AudioService::onAVChannelSetupRequest(const aasdk::proto::messages::AVChannelSetupRequest& request)
 {
+    TRACE_METHOD("service", "AudioService");
     LOG(info) << "setup request"
                        << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
                        << ", config index: " << request.config_index();
@@ -119,7 +144,7 @@ void AudioService::onAVChannelSetupRequest(const aasdk::proto::messages::AVChann
 
     aasdk::proto::messages::AVChannelSetupResponse response;
     response.set_media_status(status);
-    response.set_max_unacked(1);
+    response.set_max_unacked(ackWindow_.getMaxUnacked());
     response.add_configs(0);
 
     auto promise = aasdk::channel::SendPromise::defer(strand_);
@@ -130,44 +155,154 @@ void AudioService::onAVChannelSetupRequest(const aasdk::proto::messages::AVChann
 
 void AudioService::onAVChannelStartIndication(const aasdk::proto::messages::AVChannelStartIndication& indication)
 {
+    TRACE_METHOD("service", "AudioService");
     LOG(info) << "start indication"
                        << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
                        << ", session: " << indication.session();
     session_ = indication.session();
+    ackWindow_.reset();
+    jitterBuffer_.setFormat(audioOutput_->getSampleRate(), audioOutput_->getChannelCount() * audioOutput_->getSampleSize() / 8);
+    jitterBuffer_.reset();
+    audioOutput_->flush();
     audioOutput_->start();
+
+    if(audioFocusController_ != nullptr)
+    {
+        audioFocusController_->onChannelStarted(channel_->getId());
+    }
+
     channel_->receive(this->shared_from_this());
 }
 
 void AudioService::onAVChannelStopIndication(const aasdk::proto::messages::AVChannelStopIndication& indication)
 {
+    TRACE_METHOD("service", "AudioService");
     LOG(info) << "stop indication"
                        << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId())
                        << ", session: " << session_;
+    this->dumpAckStatistics();
+    this->dumpJitterStatistics();
     session_ = -1;
     audioOutput_->suspend();
+    // whatever is still queued belongs to the stream that just ended
+    audioOutput_->flush();
+
+    if(audioFocusController_ != nullptr)
+    {
+        audioFocusController_->onChannelStopped(channel_->getId());
+    }
+
     channel_->receive(this->shared_from_this());
 }
 
 void AudioService::onAVMediaWithTimestampIndication(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
-    audioOutput_->write(timestamp, buffer);
-    aasdk::proto::messages::AVMediaAckIndication indication;
-    indication.set_session(session_);
-    indication.set_value(1);
+    TRACE_METHOD("service", "AudioService");
+    if(captureWriter_ != nullptr)
+    {
+        captureWriter_->write(channel_->getId(), timestamp, buffer);
+    }
 
-    auto promise = aasdk::channel::SendPromise::defer(strand_);
-    promise->then([]() {}, std::bind(&AudioService::onChannelError, this->shared_from_this(), std::placeholders::_1));
-    channel_->sendAVMediaAckIndication(indication, std::move(promise));
+    this->writeAudio(timestamp, buffer);
+    ackWindow_.onReceived();
+    this->sendAVMediaAckIndication();
     channel_->receive(this->shared_from_this());
 }
 
+void AudioService::writeAudio(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
+{
+    const auto decision = jitterBuffer_.onPacket(timestamp, buffer.size, audioOutput_->getBufferedBytes(), audioOutput_->getUnderrunCount());
+    if(decision.drop)
+    {
+        return;
+    }
+
+    if(decision.silenceBytes > 0)
+    {
+        silence_.resize(decision.silenceBytes, 0);
+        TRACE_SCOPE_VALUE("output", "audio silence write", "size", decision.silenceBytes);
+        audioOutput_->write(timestamp, aasdk::common::DataConstBuffer(silence_.data(), decision.silenceBytes));
+    }
+
+    if(decision.skipBytes < buffer.size)
+    {
+        TRACE_SCOPE_VALUE("output", "audio write", "size", buffer.size - decision.skipBytes);
+        audioOutput_->write(timestamp, aasdk::common::DataConstBuffer(buffer.cdata + decision.skipBytes, buffer.size - decision.skipBytes));
+    }
+}
+
 void AudioService::onAVMediaIndication(const aasdk::common::DataConstBuffer& buffer)
 {
+    TRACE_METHOD("service", "AudioService");
     this->onAVMediaWithTimestampIndication(0, buffer);
 }
 
+void AudioService::sendAVMediaAckIndication()
+{
+    const auto acknowledged = ackWindow_.acknowledge(audioOutput_->isBackpressured());
+    if(acknowledged > 0)
+    {
+        aasdk::proto::messages::AVMediaAckIndication indication;
+        indication.set_session(session_);
+        indication.set_value(acknowledged);
+
+        // sent per packet, the handler only captures the channel id so std::function stores it in place
+        auto promise = SendPromisePool::defer(strand_);
+        promise->then([]() {}, [channelId = channel_->getId()](const aasdk::error::Error& e) {
+            LOG(error) << "ack error: " << e.what() << ", channel: " << aasdk::messenger::channelIdToString(channelId);
+        });
+        channel_->sendAVMediaAckIndication(indication, std::move(promise));
+    }
+    else if(ackWindow_.hasPending() && !ackTimerPending_)
+    {
+        ackTimerPending_ = true;
+        ackTimer_.expires_from_now(boost::posix_time::milliseconds(MediaAckWindow::cRetryInterval));
+        ackTimer_.async_wait(strand_.wrap(std::bind(&AudioService::onAckTimerExceeded, this->shared_from_this(), std::placeholders::_1)));
+    }
+}
+
+void AudioService::onAckTimerExceeded(const boost::system::error_code& error)
+{
+    TRACE_METHOD("service", "AudioService");
+    ackTimerPending_ = false;
+
+    if(error != boost::asio::error::operation_aborted)
+    {
+        this->sendAVMediaAckIndication();
+    }
+}
+
+void AudioService::dumpAckStatistics() const
+{
+    const auto statistics = ackWindow_.getStatistics();
+    LOG(info) << "audio acks, channel: " << aasdk::messenger::channelIdToString(channel_->getId())
+              << ", window: " << ackWindow_.getMaxUnacked()
+              << ", received: " << statistics.receivedMessages
+              << ", acks: " << statistics.sentAcks
+              << ", held: " << statistics.heldAcks
+              << ", forced: " << statistics.forcedAcks
+              << ", window full: " << statistics.windowFull;
+}
+
+void AudioService::dumpJitterStatistics() const
+{
+    const auto statistics = jitterBuffer_.getStatistics();
+    LOG(info) << "audio jitter buffer, channel: " << aasdk::messenger::channelIdToString(channel_->getId())
+              << ", packets: " << statistics.packets
+              << ", late: " << statistics.latePackets
+              << ", missing: " << statistics.missingPackets
+              << ", discontinuities: " << statistics.discontinuities
+              << ", depth: " << statistics.depth << "us"
+              << ", target: " << statistics.target << "us"
+              << ", jitter: " << statistics.jitter << "us"
+              << ", inserted: " << statistics.insertedBytes
+              << ", skipped: " << statistics.skippedBytes
+              << ", clock drift: " << audioOutput_->getClockDrift() << "ppm";
+}
+
 void AudioService::onChannelError(const aasdk::error::Error& e)
 {
+    TRACE_METHOD("service", "AudioService");
     LOG(error) << "channel error: " << e.what()
                         << ", channel: " << aasdk::messenger::channelIdToString(channel_->getId());
 }
@@ -17,6 +17,7 @@
 */
 
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 #include "openauto/Service/BluetoothService.hpp"
 
 namespace openauto
@@ -66,6 +67,7 @@ void BluetoothService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResp
 
 void BluetoothService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
+    TRACE_METHOD("service", "BluetoothService");
     LOG(info) << "open request, priority: " << request.priority();
     const aasdk::proto::enums::Status::Enum status = aasdk::proto::enums::Status::OK;
     LOG(info) << "open status: " << status;
@@ -82,6 +84,7 @@ void BluetoothService::onChannelOpenRequest(const aasdk::proto::messages::Channe
 
 void BluetoothService::onBluetoothPairingRequest(const aasdk::proto::messages::BluetoothPairingRequest& request)
 {
+    TRACE_METHOD("service", "BluetoothService");
     LOG(info) << "pairing request, address: " << request.phone_address();
 
     aasdk::proto::messages::BluetoothPairingResponse response;
@@ -99,6 +102,7 @@ void BluetoothService::onBluetoothPairingRequest(const aasdk::proto::messages::B
 
 void BluetoothService::onChannelError(const aasdk::error::Error& e)
 {
+    TRACE_METHOD("service", "BluetoothService");
     LOG(error) << "channel error: " << e.what();
 }
 
@@ -18,7 +18,9 @@
 
 #include "aasdk_proto/InputEventIndicationMessage.pb.h"
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 #include "openauto/Service/InputService.hpp"
+#include "openauto/Service/SendPromisePool.hpp"
 
 namespace openauto
 {
@@ -79,6 +81,7 @@ void InputService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse
 
 void InputService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
+    TRACE_METHOD("service", "InputService");
     LOG(info) << "open request, priority: " << request.priority();
     const aasdk::proto::enums::Status::Enum status = aasdk::proto::enums::Status::OK;
     LOG(info) << "open status: " << status;
@@ -95,6 +98,7 @@ void InputService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpe
 
 void InputService::onBindingRequest(const aasdk::proto::messages::BindingRequest& request)
 {
+    TRACE_METHOD("service", "InputService");
     LOG(info) << "binding request, scan codes count: " << request.scan_codes_size();
 
     aasdk::proto::enums::Status::Enum status = aasdk::proto::enums::Status::OK;
@@ -130,42 +134,42 @@ void InputService::onBindingRequest(const aasdk::proto::messages::BindingRequest
 
 void InputService::onChannelError(const aasdk::error::Error& e)
 {
+    TRACE_METHOD("service", "InputService");
     LOG(error) << "channel error: " << e.what();
 }
 
 void InputService::onButtonEvent(const projection::ButtonEvent& event)
 {
+    TRACE_METHOD("service", "InputService");
     if(!serviceActive) return;
     auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch());
 
     strand_.dispatch([this, self = this->shared_from_this(), event = std::move(event), timestamp = std::move(timestamp)]() {
-        aasdk::proto::messages::InputEventIndication inputEventIndication;
-        inputEventIndication.set_timestamp(timestamp.count());
+        inputEventIndication_.Clear();
+        inputEventIndication_.set_timestamp(timestamp.count());
 
         if(event.code == aasdk::proto::enums::ButtonCode::SCROLL_WHEEL)
         {
-            auto relativeEvent = inputEventIndication.mutable_relative_input_event()->add_relative_input_events();
+            auto relativeEvent = inputEventIndication_.mutable_relative_input_event()->add_relative_input_events();
             relativeEvent->set_delta(event.wheelDirection == projection::WheelDirection::LEFT ? -1 : 1);
             relativeEvent->set_scan_code(event.code);
         }
         else
         {
-            auto buttonEvent = inputEventIndication.mutable_button_event()->add_button_events();
+            auto buttonEvent = inputEventIndication_.mutable_button_event()->add_button_events();
             buttonEvent->set_meta(0);
             buttonEvent->set_is_pressed(event.type == projection::ButtonEventType::PRESS);
             buttonEvent->set_long_press(false);
             buttonEvent->set_scan_code(event.code);
         }
 
-        auto promise = aasdk::channel::SendPromise::defer(strand_);
-        promise->then([]() {}, std::bind(&InputService::onChannelError, this->shared_from_this(), std::placeholders::_1));
-        channel_->sendInputEventIndication(inputEventIndication, std::move(promise));
+        this->sendInputEventIndication(inputEventIndication_);
     });
 }
 
 void InputService::sendButtonPress(aasdk::proto::enums::ButtonCode::Enum buttonCode, projection::WheelDirection wheelDirection, projection::ButtonEventType buttonEventType)
 {    
-    LOG(info) << "injecting button press";
+    LOG(debug) << "injecting button press";
     if(buttonCode == aasdk::proto::enums::ButtonCode::SCROLL_WHEEL)
     {
         onButtonEvent({projection::ButtonEventType::NONE, wheelDirection, buttonCode});
@@ -186,35 +190,43 @@ void InputService::sendButtonPress(aasdk::proto::enums::ButtonCode::Enum buttonC
 
 void InputService::onTouchEvent(aasdk::proto::messages::InputEventIndication inputEventIndication)
 {
+    TRACE_METHOD("service", "InputService");
 
     strand_.dispatch([this, self = this->shared_from_this(), inputEventIndication = std::move(inputEventIndication)]() {
 
-        auto promise = aasdk::channel::SendPromise::defer(strand_);
-        promise->then([]() {}, std::bind(&InputService::onChannelError, this->shared_from_this(), std::placeholders::_1));
-        channel_->sendInputEventIndication(inputEventIndication, std::move(promise));
+        this->sendInputEventIndication(inputEventIndication);
     });
 }
 
 void InputService::onMouseEvent(const projection::TouchEvent& event)
 {
+    TRACE_METHOD("service", "InputService");
     auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch());
 
     strand_.dispatch([this, self = this->shared_from_this(), event = std::move(event), timestamp = std::move(timestamp)]() {
-        aasdk::proto::messages::InputEventIndication inputEventIndication;
-        inputEventIndication.set_timestamp(timestamp.count());
+        inputEventIndication_.Clear();
+        inputEventIndication_.set_timestamp(timestamp.count());
 
-        auto touchEvent = inputEventIndication.mutable_touch_event();
+        auto touchEvent = inputEventIndication_.mutable_touch_event();
         touchEvent->set_touch_action(event.type);
         auto touchLocation = touchEvent->add_touch_location();
         touchLocation->set_x(event.x);
         touchLocation->set_y(event.y);
         touchLocation->set_pointer_id(0);
 
-        auto promise = aasdk::channel::SendPromise::defer(strand_);
-        promise->then([]() {}, std::bind(&InputService::onChannelError, this->shared_from_this(), std::placeholders::_1));
-        channel_->sendInputEventIndication(inputEventIndication, std::move(promise));
+        this->sendInputEventIndication(inputEventIndication_);
     });
 }
 
+void InputService::sendInputEventIndication(const aasdk::proto::messages::InputEventIndication& indication)
+{
+    TRACE_METHOD("service", "InputService");
+
+    // sent per event, pooled promise and a captureless handler keep it off the heap
+    auto promise = SendPromisePool::defer(strand_);
+    promise->then([]() {}, [](const aasdk::error::Error& e) { LOG(error) << "input event error: " << e.what(); });
+    channel_->sendInputEventIndication(indication, std::move(promise));
+}
+
 }
 }
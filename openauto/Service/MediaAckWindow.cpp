@@ -0,0 +1,106 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include "openauto/Service/MediaAckWindow.hpp"
+
+namespace openauto
+{
+namespace service
+{
+
+constexpr std::chrono::milliseconds MediaAckWindow::cMaxHoldTime;
+
+MediaAckWindow::MediaAckWindow(uint32_t maxUnacked)
+    : maxUnacked_(std::max<uint32_t>(1, std::min(maxUnacked, cMaxWindowSize)))
+    , pending_(0)
+    , holding_(false)
+{
+
+}
+
+uint32_t MediaAckWindow::getMaxUnacked() const
+{
+    return maxUnacked_;
+}
+
+void MediaAckWindow::onReceived()
+{
+    ++pending_;
+    ++statistics_.receivedMessages;
+
+    // the phone will not send anything more until some of these are acknowledged
+    if(pending_ >= maxUnacked_)
+    {
+        ++statistics_.windowFull;
+    }
+}
+
+uint32_t MediaAckWindow::acknowledge(bool backpressured)
+{
+    if(pending_ == 0)
+    {
+        return 0;
+    }
+
+    if(backpressured)
+    {
+        const auto now = Clock::now();
+        if(!holding_)
+        {
+            holding_ = true;
+            holdStart_ = now;
+            ++statistics_.heldAcks;
+            return 0;
+        }
+        else if(now - holdStart_ < cMaxHoldTime)
+        {
+            return 0;
+        }
+
+        // the output is stuck, let the phone carry on rather than stalling the channel for good
+        ++statistics_.forcedAcks;
+    }
+
+    const uint32_t acknowledged = pending_;
+    pending_ = 0;
+    holding_ = false;
+    ++statistics_.sentAcks;
+    return acknowledged;
+}
+
+bool MediaAckWindow::hasPending() const
+{
+    return pending_ > 0;
+}
+
+void MediaAckWindow::reset()
+{
+    pending_ = 0;
+    holding_ = false;
+    statistics_ = MediaAckStatistics();
+}
+
+MediaAckStatistics MediaAckWindow::getStatistics() const
+{
+    return statistics_;
+}
+
+}
+}
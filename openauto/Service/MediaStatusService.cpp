@@ -1,4 +1,5 @@
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 #include "openauto/Service/MediaStatusService.hpp"
 #include "openauto/Service/IAndroidAutoInterface.hpp"
 
@@ -40,6 +41,7 @@ void MediaStatusService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryRe
 
 void MediaStatusService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
+    TRACE_METHOD("service", "MediaStatusService");
     LOG(info) << "open request, priority: " << request.priority();
     const aasdk::proto::enums::Status::Enum status = aasdk::proto::enums::Status::OK;
     LOG(info) << "open status: " << status;
@@ -57,12 +59,14 @@ void MediaStatusService::onChannelOpenRequest(const aasdk::proto::messages::Chan
 
 void MediaStatusService::onChannelError(const aasdk::error::Error& e)
 {
+    TRACE_METHOD("service", "MediaStatusService");
     LOG(error) << "channel error: " << e.what();
 }
 
 void MediaStatusService::onMetadataUpdate(const aasdk::proto::messages::MediaInfoChannelMetadataData& metadata)
 {
-    LOG(info) << "Metadata update"
+    TRACE_METHOD("service", "MediaStatusService");
+    LOG(debug) << "Metadata update"
                        << ", track: " <<  metadata.track_name()
                        << (metadata.has_artist_name()?", artist: ":"") << (metadata.has_artist_name()?metadata.artist_name():"")
                        << (metadata.has_album_name()?", album: ":"") << (metadata.has_album_name()?metadata.album_name():"")
@@ -76,7 +80,8 @@ void MediaStatusService::onMetadataUpdate(const aasdk::proto::messages::MediaInf
 
 void MediaStatusService::onPlaybackUpdate(const aasdk::proto::messages::MediaInfoChannelPlaybackData& playback)
 {
-    LOG(info) << "Playback update"
+    TRACE_METHOD("service", "MediaStatusService");
+    LOG(debug) << "Playback update"
                        << ", source: " <<  playback.media_source()
                        << ", state: " << playback.playback_state()
                        << ", progress: " << playback.track_progress();
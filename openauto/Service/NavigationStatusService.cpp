@@ -1,4 +1,5 @@
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 #include "openauto/Service/NavigationStatusService.hpp"
 #include "aasdk_proto/ManeuverTypeEnum.pb.h"
 #include "aasdk_proto/ManeuverDirectionEnum.pb.h"
@@ -51,6 +52,7 @@ void NavigationStatusService::fillFeatures(aasdk::proto::messages::ServiceDiscov
 
 void NavigationStatusService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
+    TRACE_METHOD("service", "NavigationStatusService");
     LOG(info) << "open request, priority: " << request.priority();
     const aasdk::proto::enums::Status::Enum status = aasdk::proto::enums::Status::OK;
     LOG(info) << "open status: " << status;
@@ -68,12 +70,14 @@ void NavigationStatusService::onChannelOpenRequest(const aasdk::proto::messages:
 
 void NavigationStatusService::onChannelError(const aasdk::error::Error& e)
 {
+    TRACE_METHOD("service", "NavigationStatusService");
     LOG(error) << "channel error: " << e.what();
 }
 
 void NavigationStatusService::onStatusUpdate(const aasdk::proto::messages::NavigationStatus& navStatus)
 {
-    LOG(info) << "Navigation Status Update"
+    TRACE_METHOD("service", "NavigationStatusService");
+    LOG(debug) << "Navigation Status Update"
                        << ", Status: " <<  aasdk::proto::messages::NavigationStatus_Enum_Name(navStatus.status());
     if(aa_interface_ != NULL)
     {
@@ -84,7 +88,8 @@ void NavigationStatusService::onStatusUpdate(const aasdk::proto::messages::Navig
 
 void NavigationStatusService::onTurnEvent(const aasdk::proto::messages::NavigationTurnEvent& turnEvent)
 {
-    LOG(info) << "Turn Event"
+    TRACE_METHOD("service", "NavigationStatusService");
+    LOG(debug) << "Turn Event"
                        << ", Street: " << turnEvent.street_name()
                        << ", Maneuver: " <<  aasdk::proto::enums::ManeuverDirection_Enum_Name(turnEvent.maneuverdirection()) << " " << aasdk::proto::enums::ManeuverType_Enum_Name(turnEvent.maneuvertype());
     if(aa_interface_ != NULL)
@@ -96,7 +101,8 @@ void NavigationStatusService::onTurnEvent(const aasdk::proto::messages::Navigati
 
 void NavigationStatusService::onDistanceEvent(const aasdk::proto::messages::NavigationDistanceEvent& distanceEvent)
 {
-    LOG(info) << "Distance Event"
+    TRACE_METHOD("service", "NavigationStatusService");
+    LOG(debug) << "Distance Event"
                        << ", Distance (meters): " << distanceEvent.meters()
                        << ", Time To Turn (seconds): " << distanceEvent.timetostepseconds()
                        << ", Distance: " << distanceEvent.distancetostepmillis()/1000.0
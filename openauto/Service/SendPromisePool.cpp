@@ -0,0 +1,112 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <new>
+#include "openauto/Service/SendPromisePool.hpp"
+
+namespace openauto
+{
+namespace service
+{
+
+BlockPool::BlockPool(size_t blockSize)
+    : blockSize_(std::max(blockSize, sizeof(FreeBlock)))
+    , freeList_(nullptr)
+{
+
+}
+
+BlockPool::~BlockPool()
+{
+    while(freeList_ != nullptr)
+    {
+        auto block = freeList_;
+        freeList_ = block->next;
+        ::operator delete(block);
+    }
+}
+
+void* BlockPool::allocate(size_t size)
+{
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        ++statistics_.allocations;
+
+        if(size <= blockSize_ && freeList_ != nullptr)
+        {
+            auto block = freeList_;
+            freeList_ = block->next;
+            --statistics_.cachedBlocks;
+            return block;
+        }
+
+        ++statistics_.heapAllocations;
+    }
+
+    return ::operator new(size <= blockSize_ ? blockSize_ : size);
+}
+
+void BlockPool::deallocate(void* block, size_t size)
+{
+    if(size > blockSize_)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    auto freeBlock = static_cast<FreeBlock*>(block);
+    freeBlock->next = freeList_;
+    freeList_ = freeBlock;
+    ++statistics_.cachedBlocks;
+}
+
+size_t BlockPool::getBlockSize() const
+{
+    return blockSize_;
+}
+
+BlockPoolStatistics BlockPool::getStatistics() const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    return statistics_;
+}
+
+constexpr size_t SendPromisePool::cBlockSize;
+
+aasdk::channel::SendPromise::Pointer SendPromisePool::defer(boost::asio::io_service::strand& strand)
+{
+    return std::allocate_shared<aasdk::channel::SendPromise>(PoolAllocator<aasdk::channel::SendPromise>(getPool()), strand);
+}
+
+BlockPoolStatistics SendPromisePool::getStatistics()
+{
+    return getPool().getStatistics();
+}
+
+BlockPool& SendPromisePool::getPool()
+{
+    // never destroyed, promises still queued in the messenger may be released after static destructors ran
+    static BlockPool* pool = new BlockPool(cBlockSize);
+    return *pool;
+}
+
+}
+}
@@ -18,6 +18,7 @@
 
 #include "aasdk_proto/DrivingStatusEnum.pb.h"
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 #include "openauto/Service/SensorService.hpp"
 
 namespace openauto
@@ -62,6 +63,7 @@ void SensorService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryRespons
 
 void SensorService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
+    TRACE_METHOD("service", "SensorService");
     LOG(info) << "open request, priority: " << request.priority();
     const aasdk::proto::enums::Status::Enum status = aasdk::proto::enums::Status::OK;
     LOG(info) << "open status: " << status;
@@ -78,6 +80,7 @@ void SensorService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOp
 
 void SensorService::onSensorStartRequest(const aasdk::proto::messages::SensorStartRequestMessage& request)
 {
+    TRACE_METHOD("service", "SensorService");
     LOG(info) << "sensor start request, type: " << request.sensor_type();
 
     aasdk::proto::messages::SensorStartResponseMessage response;
@@ -126,6 +129,7 @@ void SensorService::sendNightData()
 
 void SensorService::onChannelError(const aasdk::error::Error& e)
 {
+    TRACE_METHOD("service", "SensorService");
     LOG(error) << "channel error: " << e.what();
 }
 
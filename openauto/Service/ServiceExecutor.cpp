@@ -0,0 +1,158 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include "openauto/Service/ServiceExecutor.hpp"
+#include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
+
+namespace openauto
+{
+namespace service
+{
+
+constexpr std::chrono::milliseconds ServiceExecutor::cProbeInterval;
+constexpr std::chrono::seconds ServiceExecutor::cStatisticsInterval;
+
+ServiceExecutor::ServiceExecutor(std::string name, size_t threadCount)
+    : name_(std::move(name))
+    , work_(std::make_unique<boost::asio::io_service::work>(ioService_))
+    , probeTimer_(ioService_)
+    , handlers_(0)
+    , lastDumpHandlers_(0)
+    , lastDumpTime_(Clock::now())
+{
+    this->scheduleProbe();
+
+    for(size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i)
+    {
+        threads_.emplace_back(&ServiceExecutor::run, this);
+    }
+
+    LOG(info) << "[ServiceExecutor] " << name_ << " started, threads: " << threads_.size();
+}
+
+ServiceExecutor::~ServiceExecutor()
+{
+    work_.reset();
+    ioService_.stop();
+
+    for(auto& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+boost::asio::io_service& ServiceExecutor::getIOService()
+{
+    return ioService_;
+}
+
+const std::string& ServiceExecutor::getName() const
+{
+    return name_;
+}
+
+ServiceExecutorStatistics ServiceExecutor::getStatistics() const
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    auto statistics = statistics_;
+    statistics.handlers = handlers_;
+    return statistics;
+}
+
+void ServiceExecutor::run()
+{
+    trace::Tracer::setThreadName(name_);
+
+    while(ioService_.run_one() > 0)
+    {
+        ++handlers_;
+    }
+}
+
+void ServiceExecutor::scheduleProbe()
+{
+    probeTimer_.expires_from_now(boost::posix_time::milliseconds(cProbeInterval.count()));
+    probeTimer_.async_wait(std::bind(&ServiceExecutor::onProbeTimer, this, std::placeholders::_1));
+}
+
+void ServiceExecutor::onProbeTimer(const boost::system::error_code& error)
+{
+    if(error != boost::asio::error::operation_aborted)
+    {
+        // the timer handler itself is counted once it returns, right after this snapshot
+        ioService_.post(std::bind(&ServiceExecutor::onProbe, this, Clock::now(), handlers_ + 1));
+    }
+}
+
+void ServiceExecutor::onProbe(Clock::time_point postTime, uint64_t postHandlers)
+{
+    const auto now = Clock::now();
+    const auto delay = std::chrono::duration_cast<std::chrono::microseconds>(now - postTime);
+    const uint64_t depth = handlers_ >= postHandlers ? handlers_ - postHandlers : 0;
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        for(auto* statistics : {&statistics_, &interval_})
+        {
+            ++statistics->probes;
+            statistics->totalDepth += depth;
+            statistics->maxDepth = std::max(statistics->maxDepth, depth);
+            statistics->totalDelay += delay;
+            statistics->maxDelay = std::max(statistics->maxDelay, delay);
+        }
+    }
+
+    if(now - lastDumpTime_ >= cStatisticsInterval)
+    {
+        this->dumpStatistics(now);
+    }
+
+    this->scheduleProbe();
+}
+
+void ServiceExecutor::dumpStatistics(Clock::time_point now)
+{
+    const uint64_t handlers = handlers_;
+    ServiceExecutorStatistics interval;
+
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        interval = interval_;
+        interval_ = ServiceExecutorStatistics();
+    }
+
+    // every probe is two handlers of its own, an idle class of services has nothing to report
+    const uint64_t serviceHandlers = handlers - lastDumpHandlers_ - std::min(handlers - lastDumpHandlers_, 2 * interval.probes);
+    if(serviceHandlers > 0 && interval.probes > 0)
+    {
+        LOG(info) << "[ServiceExecutor] " << name_ << ", handlers: " << serviceHandlers
+                  << ", queue depth avg: " << static_cast<double>(interval.totalDepth) / interval.probes
+                  << ", max: " << interval.maxDepth
+                  << ", queue delay avg: " << interval.totalDelay.count() / static_cast<int64_t>(interval.probes) << "us"
+                  << ", max: " << interval.maxDelay.count() << "us";
+    }
+
+    lastDumpHandlers_ = handlers;
+    lastDumpTime_ = now;
+}
+
+}
+}
@@ -18,6 +18,7 @@
 
 #include <QApplication>
 #include <QScreen>
+#include <QDateTime>
 #include "aasdk/Channel/AV/MediaAudioServiceChannel.hpp"
 #include "aasdk/Channel/AV/SystemAudioServiceChannel.hpp"
 #include "aasdk/Channel/AV/SpeechAudioServiceChannel.hpp"
@@ -37,6 +38,12 @@
 #include "openauto/Projection/RtAudioOutput.hpp"
 #include "openauto/Projection/QtAudioOutput.hpp"
 #include "openauto/Projection/QtAudioInput.hpp"
+#include "openauto/Projection/NullVideoOutput.hpp"
+#include "openauto/Projection/QueuedVideoOutput.hpp"
+#include "openauto/Projection/LibavVideoOutput.hpp"
+#include "openauto/Projection/NullAudioOutput.hpp"
+#include "openauto/Projection/WavFileAudioOutput.hpp"
+#include "openauto/Projection/AudioMixerInput.hpp"
 #include "openauto/Projection/InputDevice.hpp"
 #include "openauto/Projection/LocalBluetoothDevice.hpp"
 #include "openauto/Projection/RemoteBluetoothDevice.hpp"
@@ -63,6 +70,10 @@ ServiceFactory::ServiceFactory(boost::asio::io_service& ioService, configuration
 #endif
     , btservice_(configuration_)
     , nightMode_(nightMode)
+    , videoExecutor_(std::make_shared<ServiceExecutor>("video", 1))
+    , audioExecutor_(std::make_shared<ServiceExecutor>("audio", 2))
+    , inputExecutor_(std::make_shared<ServiceExecutor>("input", 1))
+    , controlExecutor_(std::make_shared<ServiceExecutor>("control", 1))
 {
     LOG(info) << "SERVICE FACTORY INITED";
 
@@ -71,16 +82,21 @@ ServiceFactory::ServiceFactory(boost::asio::io_service& ioService, configuration
 ServiceList ServiceFactory::create(aasdk::messenger::IMessenger::Pointer messenger)
 {
     ServiceList serviceList;
+    auto captureWriter = this->createCaptureWriter();
+    audioFocusController_ = std::make_shared<AudioFocusController>(std::min<uint32_t>(configuration_->getAudioDuckingLevel(), 100) / 100.0f);
 
-    projection::IAudioInput::Pointer audioInput(new projection::QtAudioInput(1, 16, 16000), std::bind(&QObject::deleteLater, std::placeholders::_1));
-    serviceList.emplace_back(std::make_shared<AudioInputService>(ioService_, messenger, std::move(audioInput)));
-    this->createAudioServices(serviceList, messenger);
+    // the outputs created below feed what they play into the echo canceller of the microphone
+    echoReference_ = std::make_shared<projection::EchoReference>(16000);
+    auto audioInputProcessor = std::make_shared<projection::AudioInputProcessor>(16000, echoReference_);
+    projection::IAudioInput::Pointer audioInput(new projection::QtAudioInput(1, 16, 16000, std::move(audioInputProcessor)), std::bind(&QObject::deleteLater, std::placeholders::_1));
+    serviceList.emplace_back(std::make_shared<AudioInputService>(audioExecutor_->getIOService(), messenger, std::move(audioInput)));
+    this->createAudioServices(serviceList, messenger, captureWriter);
 
-    std::shared_ptr<SensorService> sensorService = std::make_shared<SensorService>(ioService_, messenger, nightMode_);
+    std::shared_ptr<SensorService> sensorService = std::make_shared<SensorService>(controlExecutor_->getIOService(), messenger, nightMode_);
     sensorService_ = sensorService;
     serviceList.emplace_back(sensorService);
 
-    serviceList.emplace_back(this->createVideoService(messenger));
+    serviceList.emplace_back(this->createVideoService(messenger, std::move(captureWriter)));
     serviceList.emplace_back(this->createBluetoothService(messenger));
     std::shared_ptr<NavigationStatusService> navStatusService = this->createNavigationStatusService(messenger);
     navStatusService_ = navStatusService;
@@ -95,8 +111,32 @@ ServiceList ServiceFactory::create(aasdk::messenger::IMessenger::Pointer messeng
     return serviceList;
 }
 
-IService::Pointer ServiceFactory::createVideoService(aasdk::messenger::IMessenger::Pointer messenger)
+AudioFocusController::Pointer ServiceFactory::getAudioFocusController()
 {
+    return audioFocusController_;
+}
+
+IService::Pointer ServiceFactory::createVideoService(aasdk::messenger::IMessenger::Pointer messenger, capture::CaptureWriter::Pointer captureWriter)
+{
+    if(configuration_->getVideoOutputBackendType() == configuration::VideoOutputBackendType::NONE)
+    {
+        auto videoOutput = std::make_shared<projection::NullVideoOutput>(configuration_);
+        return std::make_shared<VideoService>(videoExecutor_->getIOService(), messenger, this->queueVideoOutput(std::move(videoOutput)), configuration_->getVideoMaxUnacked(), std::move(captureWriter));
+    }
+#ifdef USE_LIBAV
+    else if(configuration_->getVideoOutputBackendType() == configuration::VideoOutputBackendType::LIBAV)
+    {
+        std::shared_ptr<projection::LibavVideoOutput> videoOutput(new projection::LibavVideoOutput(configuration_, activeArea_), std::bind(&QObject::deleteLater, std::placeholders::_1));
+        if(activeCallback_ != nullptr)
+        {
+            QObject::connect(videoOutput.get(), &projection::LibavVideoOutput::startPlayback, [callback = activeCallback_]() { callback(true); });
+            QObject::connect(videoOutput.get(), &projection::LibavVideoOutput::stopPlayback, [callback = activeCallback_]() { callback(false); });
+        }
+        libavVideoOutput_ = videoOutput;
+        return std::make_shared<VideoService>(videoExecutor_->getIOService(), messenger, this->queueVideoOutput(std::move(videoOutput)), configuration_->getVideoMaxUnacked(), std::move(captureWriter));
+    }
+#endif
+
 #if defined USE_OMX
     auto videoOutput(omxVideoOutput_);
 #elif defined USE_GST
@@ -114,7 +154,13 @@ IService::Pointer ServiceFactory::createVideoService(aasdk::messenger::IMessenge
     }
     projection::IVideoOutput::Pointer videoOutput(qtVideoOutput_, std::bind(&QObject::deleteLater, std::placeholders::_1));
 #endif
-    return std::make_shared<VideoService>(ioService_, messenger, std::move(videoOutput));
+    return std::make_shared<VideoService>(videoExecutor_->getIOService(), messenger, this->queueVideoOutput(std::move(videoOutput)), configuration_->getVideoMaxUnacked(), std::move(captureWriter));
+}
+
+projection::IVideoOutput::Pointer ServiceFactory::queueVideoOutput(projection::IVideoOutput::Pointer videoOutput)
+{
+    // the decoder consumes on its own thread, reception and acks of the channel go on meanwhile
+    return std::make_shared<projection::QueuedVideoOutput>(std::move(videoOutput), static_cast<uint64_t>(configuration_->getVideoLatencyBudget()) * 1000);
 }
 
 IService::Pointer ServiceFactory::createBluetoothService(aasdk::messenger::IMessenger::Pointer messenger)
@@ -135,17 +181,17 @@ IService::Pointer ServiceFactory::createBluetoothService(aasdk::messenger::IMess
         break;
     }
 
-    return std::make_shared<BluetoothService>(ioService_, messenger, std::move(bluetoothDevice));
+    return std::make_shared<BluetoothService>(controlExecutor_->getIOService(), messenger, std::move(bluetoothDevice));
 }
 
 std::shared_ptr<NavigationStatusService> ServiceFactory::createNavigationStatusService(aasdk::messenger::IMessenger::Pointer messenger)
 {
-    return std::make_shared<NavigationStatusService>(ioService_, messenger, aa_interface_);
+    return std::make_shared<NavigationStatusService>(controlExecutor_->getIOService(), messenger, aa_interface_);
 }
 
 std::shared_ptr<MediaStatusService> ServiceFactory::createMediaStatusService(aasdk::messenger::IMessenger::Pointer messenger)
 {
-    return std::make_shared<MediaStatusService>(ioService_, messenger, aa_interface_);
+    return std::make_shared<MediaStatusService>(controlExecutor_->getIOService(), messenger, aa_interface_);
 }
 
 std::shared_ptr<InputService> ServiceFactory::createInputService(aasdk::messenger::IMessenger::Pointer messenger)
@@ -174,34 +220,81 @@ std::shared_ptr<InputService> ServiceFactory::createInputService(aasdk::messenge
     QObject* inputObject = activeArea_ == nullptr ? qobject_cast<QObject*>(QApplication::instance()) : qobject_cast<QObject*>(activeArea_);
     inputDevice_ = std::make_shared<projection::InputDevice>(*inputObject, configuration_, std::move(screenGeometry_), std::move(videoGeometry));
 
-    return std::make_shared<InputService>(ioService_, messenger, std::move(projection::IInputDevice::Pointer(inputDevice_)));
+    return std::make_shared<InputService>(inputExecutor_->getIOService(), messenger, std::move(projection::IInputDevice::Pointer(inputDevice_)));
 }
 
-void ServiceFactory::createAudioServices(ServiceList& serviceList, aasdk::messenger::IMessenger::Pointer messenger)
+void ServiceFactory::createAudioServices(ServiceList& serviceList, aasdk::messenger::IMessenger::Pointer messenger, capture::CaptureWriter::Pointer captureWriter)
 {
     if(configuration_->musicAudioChannelEnabled())
     {
-        auto mediaAudioOutput = configuration_->getAudioOutputBackendType() == configuration::AudioOutputBackendType::RTAUDIO ?
-                    std::make_shared<projection::RtAudioOutput>(2, 16, 48000) :
-                    projection::IAudioOutput::Pointer(new projection::QtAudioOutput(2, 16, 48000), std::bind(&QObject::deleteLater, std::placeholders::_1));
-
-        serviceList.emplace_back(std::make_shared<MediaAudioService>(ioService_, messenger, std::move(mediaAudioOutput)));
+        auto mediaAudioOutput = this->createAudioOutput(2, 16, 48000, "media");
+        mediaAudioOutput->setPlaybackObserver(echoReference_->createSource());
+        serviceList.emplace_back(std::make_shared<MediaAudioService>(audioExecutor_->getIOService(), messenger, std::move(mediaAudioOutput), configuration_->getAudioMaxUnacked(), captureWriter, audioFocusController_));
     }
 
     if(configuration_->speechAudioChannelEnabled())
     {
-        auto speechAudioOutput = configuration_->getAudioOutputBackendType() == configuration::AudioOutputBackendType::RTAUDIO ?
-                    std::make_shared<projection::RtAudioOutput>(1, 16, 16000) :
-                    projection::IAudioOutput::Pointer(new projection::QtAudioOutput(1, 16, 16000), std::bind(&QObject::deleteLater, std::placeholders::_1));
+        auto speechAudioOutput = this->createAudioOutput(1, 16, 16000, "speech");
+        speechAudioOutput->setPlaybackObserver(echoReference_->createSource());
+        serviceList.emplace_back(std::make_shared<SpeechAudioService>(audioExecutor_->getIOService(), messenger, std::move(speechAudioOutput), configuration_->getAudioMaxUnacked(), captureWriter, audioFocusController_));
+    }
+
+    auto systemAudioOutput = this->createAudioOutput(1, 16, 16000, "system");
+    systemAudioOutput->setPlaybackObserver(echoReference_->createSource());
+    serviceList.emplace_back(std::make_shared<SystemAudioService>(audioExecutor_->getIOService(), messenger, std::move(systemAudioOutput), configuration_->getAudioMaxUnacked(), captureWriter, audioFocusController_));
+}
+
+projection::IAudioOutput::Pointer ServiceFactory::createAudioOutput(uint32_t channelCount, uint32_t sampleSize, uint32_t sampleRate, const std::string& name)
+{
+    switch(configuration_->getAudioOutputBackendType())
+    {
+    case configuration::AudioOutputBackendType::RTAUDIO:
+        return std::make_shared<projection::RtAudioOutput>(channelCount, sampleSize, sampleRate);
 
-        serviceList.emplace_back(std::make_shared<SpeechAudioService>(ioService_, messenger, std::move(speechAudioOutput)));
+    case configuration::AudioOutputBackendType::NONE:
+        return std::make_shared<projection::NullAudioOutput>(channelCount, sampleSize, sampleRate);
+
+    case configuration::AudioOutputBackendType::MIXER:
+        return this->getAudioMixer()->createInput(channelCount, sampleSize, sampleRate);
+
+#ifdef USE_ALSA
+    case configuration::AudioOutputBackendType::ALSA:
+        return std::make_shared<projection::AlsaAudioOutput>(configuration_->getAudioAlsaDevice(), configuration_->getAudioAlsaPeriodSize(), configuration_->getAudioAlsaPeriodCount(),
+                                                             channelCount, sampleSize, sampleRate);
+#endif
+
+    case configuration::AudioOutputBackendType::WAV_FILE:
+        return std::make_shared<projection::WavFileAudioOutput>(configuration_->getAudioFileOutputPath() + "/" + name + ".wav", channelCount, sampleSize, sampleRate);
+
+    default:
+        return projection::IAudioOutput::Pointer(new projection::QtAudioOutput(channelCount, sampleSize, sampleRate), std::bind(&QObject::deleteLater, std::placeholders::_1));
     }
+}
 
-    auto systemAudioOutput = configuration_->getAudioOutputBackendType() == configuration::AudioOutputBackendType::RTAUDIO ?
-                std::make_shared<projection::RtAudioOutput>(1, 16, 16000) :
-                projection::IAudioOutput::Pointer(new projection::QtAudioOutput(1, 16, 16000), std::bind(&QObject::deleteLater, std::placeholders::_1));
+projection::AudioMixer::Pointer ServiceFactory::getAudioMixer()
+{
+    // shared by all audio services of a session, it goes away together with their inputs
+    auto audioMixer = audioMixer_.lock();
+    if(audioMixer == nullptr)
+    {
+        audioMixer = std::make_shared<projection::AudioMixer>();
+        audioMixer_ = audioMixer;
+    }
 
-    serviceList.emplace_back(std::make_shared<SystemAudioService>(ioService_, messenger, std::move(systemAudioOutput)));
+    return audioMixer;
+}
+
+capture::CaptureWriter::Pointer ServiceFactory::createCaptureWriter()
+{
+    const auto capturePath = configuration_->getCapturePath();
+    if(capturePath.empty())
+    {
+        return nullptr;
+    }
+
+    const auto fileName = QDateTime::currentDateTime().toString("'capture-'yyyyMMdd-hhmmss'.oacap'").toStdString();
+    auto captureWriter = std::make_shared<capture::CaptureWriter>(capturePath + "/" + fileName);
+    return captureWriter->isOpen() ? captureWriter : nullptr;
 }
 
 void ServiceFactory::setOpacity(unsigned int alpha)
@@ -221,6 +314,12 @@ void ServiceFactory::resize()
     {
         inputDevice_->setTouchscreenGeometry(screenGeometry_);
     }
+#ifdef USE_LIBAV
+    if(auto libavVideoOutput = libavVideoOutput_.lock())
+    {
+        libavVideoOutput->resize();
+    }
+#endif
 #if defined USE_OMX
     if(omxVideoOutput_ != nullptr)
     {
@@ -17,18 +17,24 @@
 */
 
 #include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
 #include "openauto/Service/VideoService.hpp"
+#include "openauto/Service/SendPromisePool.hpp"
 
 namespace openauto
 {
 namespace service
 {
 
-VideoService::VideoService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IVideoOutput::Pointer videoOutput)
+VideoService::VideoService(boost::asio::io_service& ioService, aasdk::messenger::IMessenger::Pointer messenger, projection::IVideoOutput::Pointer videoOutput, uint32_t maxUnacked, capture::CaptureWriter::Pointer captureWriter)
     : strand_(ioService)
     , channel_(std::make_shared<aasdk::channel::av::VideoServiceChannel>(strand_, std::move(messenger)))
     , videoOutput_(std::move(videoOutput))
     , session_(-1)
+    , ackWindow_(maxUnacked)
+    , ackTimer_(ioService)
+    , ackTimerPending_(false)
+    , captureWriter_(std::move(captureWriter))
 {
 
 }
@@ -45,12 +51,16 @@ void VideoService::stop()
 {
     strand_.dispatch([this, self = this->shared_from_this()]() {
         LOG(info) << "stop.";
+        ackTimer_.cancel();
+        this->dumpAckStatistics();
+        videoOutput_->getLatencyTracker()->dump();
         videoOutput_->stop();
     });
 }
 
 void VideoService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpenRequest& request)
 {
+    TRACE_METHOD("service", "VideoService");
     LOG(info) << "open request, priority: " << request.priority();
     const aasdk::proto::enums::Status::Enum status = videoOutput_->open() ? aasdk::proto::enums::Status::OK : aasdk::proto::enums::Status::FAIL;
     LOG(info) << "open status: " << status;
@@ -67,13 +77,14 @@ void VideoService::onChannelOpenRequest(const aasdk::proto::messages::ChannelOpe
 
 void VideoService::onAVChannelSetupRequest(const aasdk::proto::messages::AVChannelSetupRequest& request)
 {
+    TRACE_METHOD("service", "VideoService");
     LOG(info) << "setup request, config index: " << request.config_index();
     const aasdk::proto::enums::AVChannelSetupStatus::Enum status = videoOutput_->init() ? aasdk::proto::enums::AVChannelSetupStatus::OK : aasdk::proto::enums::AVChannelSetupStatus::FAIL;
     LOG(info) << "setup status: " << status;
 
     aasdk::proto::messages::AVChannelSetupResponse response;
     response.set_media_status(status);
-    response.set_max_unacked(1);
+    response.set_max_unacked(ackWindow_.getMaxUnacked());
     response.add_configs(0);
 
     auto promise = aasdk::channel::SendPromise::defer(strand_);
@@ -85,51 +96,99 @@ void VideoService::onAVChannelSetupRequest(const aasdk::proto::messages::AVChann
 
 void VideoService::onAVChannelStartIndication(const aasdk::proto::messages::AVChannelStartIndication& indication)
 {
+    TRACE_METHOD("service", "VideoService");
     LOG(info) << "start indication, session: " << indication.session();
     session_ = indication.session();
+    videoOutput_->getLatencyTracker()->reset();
+    ackWindow_.reset();
 
     channel_->receive(this->shared_from_this());
 }
 
 void VideoService::onAVChannelStopIndication(const aasdk::proto::messages::AVChannelStopIndication& indication)
 {
+    TRACE_METHOD("service", "VideoService");
     LOG(info) << "stop indication";
+    this->dumpAckStatistics();
+    videoOutput_->getLatencyTracker()->dump();
 
     channel_->receive(this->shared_from_this());
 }
 
 void VideoService::onAVMediaWithTimestampIndication(aasdk::messenger::Timestamp::ValueType timestamp, const aasdk::common::DataConstBuffer& buffer)
 {
-    videoOutput_->write(timestamp, buffer);
+    TRACE_METHOD("service", "VideoService");
+    if(captureWriter_ != nullptr)
+    {
+        captureWriter_->write(channel_->getId(), timestamp, buffer);
+    }
 
-    aasdk::proto::messages::AVMediaAckIndication indication;
-    indication.set_session(session_);
-    indication.set_value(1);
+    videoOutput_->getLatencyTracker()->onReceived();
 
-    auto promise = aasdk::channel::SendPromise::defer(strand_);
-    promise->then([]() {}, std::bind(&VideoService::onChannelError, this->shared_from_this(), std::placeholders::_1));
-    channel_->sendAVMediaAckIndication(indication, std::move(promise));
+    {
+        TRACE_SCOPE_VALUE("output", "video write", "size", buffer.size);
+        videoOutput_->write(timestamp, buffer);
+    }
+
+    ackWindow_.onReceived();
+    this->sendAVMediaAckIndication();
 
     channel_->receive(this->shared_from_this());
 }
 
 void VideoService::onAVMediaIndication(const aasdk::common::DataConstBuffer& buffer)
 {
-    videoOutput_->write(0, buffer);
+    TRACE_METHOD("service", "VideoService");
+    this->onAVMediaWithTimestampIndication(0, buffer);
+}
 
-    aasdk::proto::messages::AVMediaAckIndication indication;
-    indication.set_session(session_);
-    indication.set_value(1);
+void VideoService::sendAVMediaAckIndication()
+{
+    const auto acknowledged = ackWindow_.acknowledge(videoOutput_->isBackpressured());
+    if(acknowledged > 0)
+    {
+        aasdk::proto::messages::AVMediaAckIndication indication;
+        indication.set_session(session_);
+        indication.set_value(acknowledged);
+
+        // sent per frame, pooled promise and a captureless handler keep it off the heap
+        auto promise = SendPromisePool::defer(strand_);
+        promise->then([]() {}, [](const aasdk::error::Error& e) { LOG(error) << "ack error: " << e.what(); });
+        channel_->sendAVMediaAckIndication(indication, std::move(promise));
+    }
+    else if(ackWindow_.hasPending() && !ackTimerPending_)
+    {
+        ackTimerPending_ = true;
+        ackTimer_.expires_from_now(boost::posix_time::milliseconds(MediaAckWindow::cRetryInterval));
+        ackTimer_.async_wait(strand_.wrap(std::bind(&VideoService::onAckTimerExceeded, this->shared_from_this(), std::placeholders::_1)));
+    }
+}
 
-    auto promise = aasdk::channel::SendPromise::defer(strand_);
-    promise->then([]() {}, std::bind(&VideoService::onChannelError, this->shared_from_this(), std::placeholders::_1));
-    channel_->sendAVMediaAckIndication(indication, std::move(promise));
+void VideoService::onAckTimerExceeded(const boost::system::error_code& error)
+{
+    TRACE_METHOD("service", "VideoService");
+    ackTimerPending_ = false;
 
-    channel_->receive(this->shared_from_this());
+    if(error != boost::asio::error::operation_aborted)
+    {
+        this->sendAVMediaAckIndication();
+    }
+}
+
+void VideoService::dumpAckStatistics() const
+{
+    const auto statistics = ackWindow_.getStatistics();
+    LOG(info) << "video acks, window: " << ackWindow_.getMaxUnacked()
+              << ", received: " << statistics.receivedMessages
+              << ", acks: " << statistics.sentAcks
+              << ", held: " << statistics.heldAcks
+              << ", forced: " << statistics.forcedAcks
+              << ", window full: " << statistics.windowFull;
 }
 
 void VideoService::onChannelError(const aasdk::error::Error& e)
 {
+    TRACE_METHOD("service", "VideoService");
     LOG(error) << "channel error: " << e.what();
 }
 
@@ -156,6 +215,7 @@ void VideoService::fillFeatures(aasdk::proto::messages::ServiceDiscoveryResponse
 
 void VideoService::onVideoFocusRequest(const aasdk::proto::messages::VideoFocusRequest& request)
 {
+    TRACE_METHOD("service", "VideoService");
     LOG(info) << "video focus request, display index: " << request.disp_index()
                        << ", focus mode: " << request.focus_mode()
                        << ", focus reason: " << request.focus_reason();
@@ -0,0 +1,98 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "openauto/Trace/TraceBuffer.hpp"
+
+namespace openauto
+{
+namespace trace
+{
+
+constexpr size_t TraceBuffer::cChunkSize;
+constexpr size_t TraceBuffer::cMaxChunks;
+
+TraceBuffer::TraceBuffer(int32_t threadId, std::string threadName)
+    : threadId_(threadId)
+    , threadName_(std::move(threadName))
+    , size_(0)
+    , dropped_(0)
+{
+    for(auto& chunk : chunks_)
+    {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+TraceBuffer::~TraceBuffer()
+{
+    for(auto& chunk : chunks_)
+    {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+void TraceBuffer::add(const TraceEvent& event)
+{
+    const size_t size = size_.load(std::memory_order_relaxed);
+    const size_t chunkIndex = size / cChunkSize;
+    if(chunkIndex >= cMaxChunks)
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto chunk = chunks_[chunkIndex].load(std::memory_order_relaxed);
+    if(chunk == nullptr)
+    {
+        chunk = new TraceEvent[cChunkSize];
+        chunks_[chunkIndex].store(chunk, std::memory_order_relaxed);
+    }
+
+    chunk[size % cChunkSize] = event;
+    // publishes the event and the chunk pointer to the exporter
+    size_.store(size + 1, std::memory_order_release);
+}
+
+size_t TraceBuffer::size() const
+{
+    return size_.load(std::memory_order_acquire);
+}
+
+const TraceEvent& TraceBuffer::at(size_t index) const
+{
+    return chunks_[index / cChunkSize].load(std::memory_order_relaxed)[index % cChunkSize];
+}
+
+uint64_t TraceBuffer::getDropped() const
+{
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+int32_t TraceBuffer::getThreadId() const
+{
+    return threadId_;
+}
+
+const std::string& TraceBuffer::getThreadName() const
+{
+    return threadName_;
+}
+
+}
+}
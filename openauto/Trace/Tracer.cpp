@@ -0,0 +1,261 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include "openauto/Trace/Tracer.hpp"
+#include "OpenautoLog.hpp"
+
+namespace openauto
+{
+namespace trace
+{
+
+namespace
+{
+
+struct ThreadTraceBuffer
+{
+    uint32_t generation = 0;
+    std::shared_ptr<TraceBuffer> buffer;
+};
+
+int64_t steadyNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+std::atomic<bool> Tracer::enabled_(false);
+
+Tracer& Tracer::getInstance()
+{
+    // never destroyed, like the log backend
+    static Tracer* instance = new Tracer();
+    return *instance;
+}
+
+Tracer::Tracer()
+    : generation_(0)
+    , origin_(steadyNow())
+    , exitHandlerRegistered_(false)
+{
+
+}
+
+void Tracer::start(const std::string& path)
+{
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    if(enabled_)
+    {
+        return;
+    }
+
+    buffers_.clear();
+    path_ = path;
+    origin_ = steadyNow();
+    ++generation_;
+
+    if(!exitHandlerRegistered_)
+    {
+        exitHandlerRegistered_ = true;
+        std::atexit([]() { Tracer::getInstance().stop(); });
+    }
+
+    enabled_ = true;
+    LOG(info) << "[Tracer] tracing to " << path_;
+}
+
+void Tracer::stop()
+{
+    if(!enabled_.exchange(false))
+    {
+        return;
+    }
+
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    std::ofstream stream(path_, std::ios::out | std::ios::trunc);
+    if(!stream)
+    {
+        LOG(error) << "[Tracer] cannot write " << path_;
+        return;
+    }
+
+    this->exportJson(stream);
+    LOG(info) << "[Tracer] trace written to " << path_;
+}
+
+void Tracer::add(const TraceEvent& event)
+{
+    this->getThreadBuffer().add(event);
+}
+
+void Tracer::addInstant(const char* category, const char* owner, const char* name, const char* argumentName, int64_t argument)
+{
+    TraceEvent event;
+    event.timestamp = this->now();
+    event.category = category;
+    event.owner = owner;
+    event.name = name;
+    event.argumentName = argumentName;
+    event.argument = argument;
+    this->add(event);
+}
+
+void Tracer::exportJson(std::ostream& stream) const
+{
+    // exporting while threads still add is fine, each buffer is read up to what it had published
+    const auto pid = getpid();
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    auto separator = [&first, &stream]() {
+        stream << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    char number[32];
+    auto microseconds = [&number](int64_t nanoseconds) {
+        std::snprintf(number, sizeof(number), "%.3f", nanoseconds / 1000.0);
+        return number;
+    };
+
+    for(const auto& buffer : buffers_)
+    {
+        separator();
+        stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << buffer->getThreadId() << ",\"args\":{\"name\":";
+        writeString(stream, buffer->getThreadName());
+        stream << "}}";
+
+        const size_t size = buffer->size();
+        for(size_t i = 0; i < size; ++i)
+        {
+            const auto& event = buffer->at(i);
+            separator();
+            stream << "{\"name\":";
+            writeString(stream, event.owner != nullptr ? std::string(event.owner) + "::" + event.name : std::string(event.name));
+            stream << ",\"cat\":";
+            writeString(stream, event.category);
+            stream << ",\"pid\":" << pid << ",\"tid\":" << buffer->getThreadId() << ",\"ts\":" << microseconds(event.timestamp);
+
+            if(event.duration >= 0)
+            {
+                stream << ",\"ph\":\"X\",\"dur\":" << microseconds(event.duration);
+            }
+            else
+            {
+                stream << ",\"ph\":\"i\",\"s\":\"t\"";
+            }
+
+            if(event.argumentName != nullptr)
+            {
+                stream << ",\"args\":{";
+                writeString(stream, event.argumentName);
+                stream << ":" << event.argument << "}";
+            }
+
+            stream << "}";
+        }
+
+        if(buffer->getDropped() > 0)
+        {
+            LOG(warning) << "[Tracer] " << buffer->getDropped() << " events dropped on thread " << buffer->getThreadName();
+        }
+    }
+
+    stream << "\n]}\n";
+}
+
+void Tracer::setThreadName(const std::string& name)
+{
+    // the kernel keeps 15 characters
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+}
+
+int64_t Tracer::now() const
+{
+    return steadyNow() - origin_.load(std::memory_order_relaxed);
+}
+
+TraceBuffer& Tracer::getThreadBuffer()
+{
+    static thread_local ThreadTraceBuffer threadBuffer;
+
+    const auto generation = generation_.load(std::memory_order_relaxed);
+    if(threadBuffer.buffer == nullptr || threadBuffer.generation != generation)
+    {
+        char threadName[16] = {};
+        pthread_getname_np(pthread_self(), threadName, sizeof(threadName));
+
+        threadBuffer.generation = generation;
+        threadBuffer.buffer = std::make_shared<TraceBuffer>(static_cast<int32_t>(syscall(SYS_gettid)), threadName);
+
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        buffers_.push_back(threadBuffer.buffer);
+    }
+
+    return *threadBuffer.buffer;
+}
+
+void Tracer::writeString(std::ostream& stream, const std::string& value)
+{
+    stream << '"';
+    for(const char c : value)
+    {
+        if(c == '"' || c == '\\')
+        {
+            stream << '\\' << c;
+        }
+        else if(static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            stream << escaped;
+        }
+        else
+        {
+            stream << c;
+        }
+    }
+    stream << '"';
+}
+
+void TraceScope::close()
+{
+    auto& tracer = Tracer::getInstance();
+
+    TraceEvent event;
+    event.timestamp = start_;
+    event.duration = tracer.now() - start_;
+    event.category = category_;
+    event.owner = owner_;
+    event.name = name_;
+    event.argumentName = argumentName_;
+    event.argument = argument_;
+    tracer.add(event);
+}
+
+}
+}
@@ -0,0 +1,75 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstdlib>
+#include <new>
+#include "replay/AllocationCounter.hpp"
+
+namespace
+{
+
+thread_local bool countAllocations = false;
+thread_local uint64_t allocationCount = 0;
+
+}
+
+void* operator new(size_t size)
+{
+    if(countAllocations)
+    {
+        ++allocationCount;
+    }
+
+    if(void* pointer = std::malloc(size > 0 ? size : 1))
+    {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace openauto
+{
+namespace replay
+{
+
+void AllocationCounter::start()
+{
+    allocationCount = 0;
+    countAllocations = true;
+}
+
+uint64_t AllocationCounter::stop()
+{
+    countAllocations = false;
+    return allocationCount;
+}
+
+}
+}
@@ -0,0 +1,139 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef USE_ALSA
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "openauto/Projection/AlsaAudioOutput.hpp"
+#include "replay/AlsaCheck.hpp"
+
+namespace openauto
+{
+namespace replay
+{
+
+namespace
+{
+
+// writes a 1 kHz tone at the pace the phone sends it for the given time
+void play(projection::AlsaAudioOutput& output, std::chrono::milliseconds duration)
+{
+    const size_t frameCount = AlsaCheck::cSampleRate * AlsaCheck::cWriteInterval.count() / 1000;
+    const double pi = std::acos(-1.0);
+    std::vector<int16_t> samples(frameCount * AlsaCheck::cChannelCount);
+    uint64_t timestamp = 0;
+    size_t phase = 0;
+
+    const auto end = AlsaCheck::Clock::now() + duration;
+    while(AlsaCheck::Clock::now() < end)
+    {
+        for(size_t frame = 0; frame < frameCount; ++frame, ++phase)
+        {
+            const auto value = static_cast<int16_t>(8192.0 * std::sin(2.0 * pi * 1000.0 * phase / AlsaCheck::cSampleRate));
+            samples[frame * 2] = value;
+            samples[frame * 2 + 1] = value;
+        }
+
+        output.write(timestamp, aasdk::common::DataConstBuffer(samples.data(), samples.size() * sizeof(int16_t)));
+        timestamp += std::chrono::duration_cast<std::chrono::microseconds>(AlsaCheck::cWriteInterval).count();
+        std::this_thread::sleep_for(AlsaCheck::cWriteInterval);
+    }
+}
+
+}
+
+constexpr uint32_t AlsaCheck::cSampleRate;
+constexpr uint32_t AlsaCheck::cChannelCount;
+constexpr std::chrono::milliseconds AlsaCheck::cPhaseTime;
+constexpr std::chrono::milliseconds AlsaCheck::cWriteInterval;
+
+AlsaCheckResult AlsaCheck::run(const std::string& device, uint32_t periodSize, uint32_t periodCount)
+{
+    AlsaCheckResult result;
+    result.device = device;
+
+    projection::AlsaAudioOutput output(device, periodSize, periodCount, cChannelCount, 16, cSampleRate);
+    std::atomic<uint64_t> playedFrames(0);
+    output.setPlaybackObserver([&playedFrames](const char*, size_t size, uint32_t, uint32_t channelCount) {
+        playedFrames += size / (channelCount * sizeof(int16_t));
+    });
+
+    result.opened = output.open();
+    if(!result.opened)
+    {
+        return result;
+    }
+
+    output.start();
+    play(output, cPhaseTime);
+    result.playedFrames = playedFrames;
+
+    // the writer thread has to come back from recover() and keep committing periods
+    output.injectXrun();
+    play(output, cPhaseTime);
+    result.framesAfterXrun = playedFrames - result.playedFrames;
+
+    // suspend joins the writer thread, nothing may be played until the next start
+    output.suspend();
+    const uint64_t suspendedAt = playedFrames;
+    play(output, cPhaseTime);
+    result.framesWhileSuspended = playedFrames - suspendedAt;
+
+    output.start();
+    const uint64_t restartedAt = playedFrames;
+    play(output, cPhaseTime);
+    result.framesAfterRestart = playedFrames - restartedAt;
+
+    result.xruns = output.getLateCallbackCount();
+    result.shortCommits = output.getShortCommitCount();
+    result.underruns = output.getUnderrunCount();
+    output.stop();
+
+    return result;
+}
+
+bool AlsaCheck::print(const AlsaCheckResult& result, std::ostream& stream)
+{
+    stream << "alsa check " << result.device
+           << " opened: " << result.opened
+           << ", played frames: " << result.playedFrames
+           << ", after xrun: " << result.framesAfterXrun
+           << ", while suspended: " << result.framesWhileSuspended
+           << ", after restart: " << result.framesAfterRestart
+           << ", xruns: " << result.xruns
+           << ", short commits: " << result.shortCommits
+           << ", underruns: " << result.underruns << std::endl;
+
+    // the injected xrun is the only one a device without a clock like the null plugin can have
+    const bool passed = result.opened && result.playedFrames > 0 && result.framesAfterXrun > 0 && result.framesWhileSuspended == 0
+                        && result.framesAfterRestart > 0 && result.xruns >= 1 && result.shortCommits == 0;
+    if(!passed)
+    {
+        stream << "alsa check FAILED" << std::endl;
+    }
+
+    return passed;
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,354 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include "replay/AudioBenchmark.hpp"
+
+namespace openauto
+{
+namespace replay
+{
+
+namespace
+{
+
+constexpr double cAmplitude = 16384.0;
+constexpr double cToneFrequency = 1000.0;
+constexpr double cChirpStartFrequency = 200.0;
+constexpr double cChirpEndFrequency = 1000.0;
+constexpr double cBurstDuration = 0.1;
+constexpr double cChirpDuration = 0.3;
+constexpr double cTaperDuration = 0.005;
+constexpr int16_t cOnsetThreshold = 164; // -40 dB below the burst amplitude
+constexpr std::chrono::milliseconds cDrainTime{500};
+
+// Runs on the playback thread of the output. The lock is only ever contended once, when the
+// results are collected, so it does not disturb the timing it measures.
+class AudioProbe
+{
+public:
+    typedef std::shared_ptr<AudioProbe> Pointer;
+
+    AudioProbe(size_t expectedEvents)
+        : silentFrames_(0)
+        , previous_({0, 0})
+        , cooldown_(0)
+        , carrySize_(0)
+        , discontinuities_(0)
+    {
+        onsets_.reserve(expectedEvents * 2);
+    }
+
+    void onPlayback(const char* data, size_t size, uint32_t sampleRate, uint32_t channelCount)
+    {
+        const auto now = AudioBenchmark::Clock::now();
+        const size_t frameSize = channelCount * sizeof(int16_t);
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+        if(frameSize == 0 || frameSize > carry_.size() || sampleRate == 0)
+        {
+            return;
+        }
+
+        // pulled reads are not always frame aligned, complete the frame started by the previous one
+        size_t offset = 0;
+        size_t frame = 0;
+        if(carrySize_ > 0)
+        {
+            const size_t needed = std::min(frameSize - carrySize_, size);
+            std::memcpy(carry_.data() + carrySize_, data, needed);
+            carrySize_ += needed;
+            offset = needed;
+
+            if(carrySize_ == frameSize)
+            {
+                this->analyze(carry_.data(), frame++, now, sampleRate);
+                carrySize_ = 0;
+            }
+        }
+
+        for(; offset + frameSize <= size; offset += frameSize)
+        {
+            this->analyze(data + offset, frame++, now, sampleRate);
+        }
+
+        carrySize_ = size - offset;
+        std::memcpy(carry_.data(), data + offset, carrySize_);
+    }
+
+    std::vector<AudioBenchmark::Clock::time_point> getOnsets() const
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        return onsets_;
+    }
+
+    uint64_t getDiscontinuities() const
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+        return discontinuities_;
+    }
+
+private:
+    void analyze(const char* data, size_t frame, AudioBenchmark::Clock::time_point blockTime, uint32_t sampleRate)
+    {
+        int16_t sample;
+        std::memcpy(&sample, data, sizeof(sample));
+
+        // an event starts when the first channel crosses the threshold after at least 10 ms of silence
+        if(std::abs(sample) >= cOnsetThreshold)
+        {
+            if(silentFrames_ >= sampleRate / 100)
+            {
+                onsets_.push_back(blockTime + std::chrono::nanoseconds(static_cast<int64_t>(frame * 1e9 / sampleRate)));
+            }
+            silentFrames_ = 0;
+        }
+        else
+        {
+            ++silentFrames_;
+        }
+
+        // the highest frequency in the stream bounds its second difference, a click exceeds it
+        const double omega = 2.0 * std::acos(-1.0) * cChirpEndFrequency / sampleRate;
+        const double maxSecondDifference = 2.0 * cAmplitude * omega * omega + 64.0;
+        const int32_t secondDifference = std::abs(sample - 2 * previous_[0] + previous_[1]);
+
+        if(cooldown_ > 0)
+        {
+            --cooldown_;
+        }
+        else if(secondDifference > maxSecondDifference)
+        {
+            ++discontinuities_;
+            cooldown_ = sampleRate / 100;
+        }
+
+        previous_[1] = previous_[0];
+        previous_[0] = sample;
+    }
+
+    mutable std::mutex mutex_;
+    size_t silentFrames_;
+    std::array<int32_t, 2> previous_;
+    size_t cooldown_;
+    std::array<char, 16> carry_;
+    size_t carrySize_;
+    std::vector<AudioBenchmark::Clock::time_point> onsets_;
+    uint64_t discontinuities_;
+};
+
+double toMilliseconds(AudioBenchmark::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}
+
+constexpr std::chrono::milliseconds AudioBenchmark::cPacketDuration;
+constexpr std::chrono::milliseconds AudioBenchmark::cEventInterval;
+
+AudioBenchmark::AudioBenchmark(std::chrono::seconds duration)
+    : duration_(duration)
+{
+
+}
+
+std::vector<int16_t> AudioBenchmark::createSignal(uint32_t sampleRate, uint32_t channelCount, std::vector<size_t>& eventOnsets) const
+{
+    const double pi = std::acos(-1.0);
+    const size_t frameCount = static_cast<size_t>(sampleRate) * duration_.count();
+    const size_t eventFrames = static_cast<size_t>(sampleRate) * cEventInterval.count() / 1000;
+    const size_t taperFrames = static_cast<size_t>(sampleRate * cTaperDuration);
+    std::vector<int16_t> signal(frameCount * channelCount, 0);
+
+    // tone bursts, every fourth event a chirp, each tapered so the stream itself has no sharp edges,
+    // the stream opens with silence so the first event is detected like all others
+    for(size_t event = 0; (event + 1) * eventFrames + eventFrames / 2 <= frameCount; ++event)
+    {
+        const bool chirp = event % 4 == 3;
+        const size_t start = event * eventFrames + eventFrames / 2;
+        const size_t length = static_cast<size_t>(sampleRate * (chirp ? cChirpDuration : cBurstDuration));
+        bool onsetFound = false;
+
+        for(size_t frame = 0; frame < length; ++frame)
+        {
+            const double time = static_cast<double>(frame) / sampleRate;
+            const double phase = chirp ? 2.0 * pi * (cChirpStartFrequency * time + (cChirpEndFrequency - cChirpStartFrequency) * time * time / (2.0 * cChirpDuration))
+                                       : 2.0 * pi * cToneFrequency * time;
+            const size_t edge = std::min(frame, length - 1 - frame);
+            const double taper = edge < taperFrames ? 0.5 - 0.5 * std::cos(pi * edge / taperFrames) : 1.0;
+            const auto sample = static_cast<int16_t>(std::lrint(cAmplitude * taper * std::sin(phase)));
+
+            if(!onsetFound && std::abs(sample) >= cOnsetThreshold)
+            {
+                eventOnsets.push_back(start + frame);
+                onsetFound = true;
+            }
+
+            for(uint32_t channel = 0; channel < channelCount; ++channel)
+            {
+                signal[(start + frame) * channelCount + channel] = sample;
+            }
+        }
+    }
+
+    return signal;
+}
+
+AudioBenchmarkResult AudioBenchmark::run(const std::string& backend, aasdk::messenger::ChannelId channel, projection::IAudioOutput::Pointer output) const
+{
+    AudioBenchmarkResult result;
+    result.backend = backend;
+    result.channel = aasdk::messenger::channelIdToString(channel);
+    result.sampleRate = output->getSampleRate();
+    result.channelCount = output->getChannelCount();
+
+    std::vector<size_t> eventOnsets;
+    const auto signal = this->createSignal(result.sampleRate, result.channelCount, eventOnsets);
+    auto probe = std::make_shared<AudioProbe>(eventOnsets.size());
+    output->setPlaybackObserver([probe](const char* data, size_t size, uint32_t sampleRate, uint32_t channelCount) {
+        probe->onPlayback(data, size, sampleRate, channelCount);
+    });
+
+    result.opened = output->open();
+    if(!result.opened)
+    {
+        return result;
+    }
+
+    output->start();
+
+    const size_t packetFrames = static_cast<size_t>(result.sampleRate) * cPacketDuration.count() / 1000;
+    const size_t packetSize = packetFrames * result.channelCount * sizeof(int16_t);
+    const size_t packetCount = signal.size() / result.channelCount / packetFrames;
+    std::vector<Clock::time_point> writeTimes;
+    size_t event = 0;
+
+    const auto started = Clock::now();
+    for(size_t packet = 0; packet < packetCount; ++packet)
+    {
+        std::this_thread::sleep_until(started + packet * cPacketDuration);
+
+        const auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count();
+        output->write(timestamp, aasdk::common::DataConstBuffer(reinterpret_cast<const uint8_t*>(signal.data()) + packet * packetSize, packetSize));
+        const auto written = Clock::now();
+
+        for(; event < eventOnsets.size() && eventOnsets[event] < (packet + 1) * packetFrames; ++event)
+        {
+            const size_t frame = eventOnsets[event] - packet * packetFrames;
+            writeTimes.push_back(written + std::chrono::nanoseconds(static_cast<int64_t>(frame * 1e9 / result.sampleRate)));
+        }
+    }
+
+    // underruns once the stream has ended are expected, count them before draining
+    result.underruns = output->getUnderrunCount();
+    std::this_thread::sleep_for(cDrainTime);
+    output->stop();
+    result.lateCallbacks = output->getLateCallbackCount();
+
+    // pair every detected onset with the latest event written before it
+    const auto onsets = probe->getOnsets();
+    std::vector<bool> matched(writeTimes.size(), false);
+    std::vector<double> latencies;
+    size_t candidate = 0;
+
+    for(const auto& onset : onsets)
+    {
+        while(candidate + 1 < writeTimes.size() && writeTimes[candidate + 1] <= onset)
+        {
+            ++candidate;
+        }
+
+        if(candidate < writeTimes.size() && writeTimes[candidate] <= onset && !matched[candidate])
+        {
+            matched[candidate] = true;
+            latencies.push_back(toMilliseconds(onset - writeTimes[candidate]));
+        }
+    }
+
+    result.eventsWritten = writeTimes.size();
+    result.eventsDetected = latencies.size();
+    result.discontinuities = probe->getDiscontinuities();
+
+    if(!latencies.empty())
+    {
+        std::vector<double> sorted(latencies);
+        std::sort(sorted.begin(), sorted.end());
+        const double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+        double variance = 0;
+        for(auto latency : sorted)
+        {
+            variance += (latency - mean) * (latency - mean);
+        }
+
+        result.latencyMin = sorted.front();
+        result.latencyMean = mean;
+        result.latencyP50 = sorted[sorted.size() / 2];
+        result.latencyP95 = sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)];
+        result.latencyMax = sorted.back();
+        result.jitter = std::sqrt(variance / sorted.size());
+    }
+
+    return result;
+}
+
+bool AudioBenchmark::passed(const AudioBenchmarkResult& result)
+{
+    return result.opened && result.eventsWritten > 0 && result.eventsDetected == result.eventsWritten && result.discontinuities == 0;
+}
+
+void AudioBenchmark::printJson(const std::vector<AudioBenchmarkResult>& results, std::ostream& stream)
+{
+    stream << "[";
+
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        stream << (i == 0 ? "" : ",") << "\n  {"
+               << "\"backend\": \"" << result.backend << "\""
+               << ", \"channel\": \"" << result.channel << "\""
+               << ", \"opened\": " << (result.opened ? "true" : "false")
+               << ", \"sample_rate\": " << result.sampleRate
+               << ", \"channel_count\": " << result.channelCount
+               << ", \"events_written\": " << result.eventsWritten
+               << ", \"events_detected\": " << result.eventsDetected
+               << ", \"discontinuities\": " << result.discontinuities
+               << ", \"underruns\": " << result.underruns
+               << ", \"late_callbacks\": " << result.lateCallbacks
+               << ", \"latency_ms\": {\"min\": " << result.latencyMin
+               << ", \"mean\": " << result.latencyMean
+               << ", \"p50\": " << result.latencyP50
+               << ", \"p95\": " << result.latencyP95
+               << ", \"max\": " << result.latencyMax << "}"
+               << ", \"jitter_ms\": " << result.jitter
+               << ", \"passed\": " << (passed(result) ? "true" : "false")
+               << "}";
+    }
+
+    stream << "\n]" << std::endl;
+}
+
+}
+}
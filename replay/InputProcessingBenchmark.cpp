@@ -0,0 +1,241 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "openauto/Projection/AudioInputProcessor.hpp"
+#include "replay/InputProcessingBenchmark.hpp"
+
+namespace openauto
+{
+namespace replay
+{
+
+namespace
+{
+
+constexpr uint32_t cSampleRate = 16000;
+constexpr size_t cDurationSeconds = 10;
+constexpr size_t cFrameSize = cSampleRate / 100;
+// the last seconds, once the filter converged and the noise floor was learned
+constexpr size_t cMeasuredSeconds = 4;
+constexpr size_t cEchoDelay = 40;
+constexpr size_t cEchoLength = 256;
+constexpr double cNoiseLevel = 300.0;
+constexpr double cToneAmplitude = 8000.0;
+
+std::vector<int16_t> toSamples(const std::vector<float>& values)
+{
+    std::vector<int16_t> samples(values.size());
+    std::transform(values.begin(), values.end(), samples.begin(), [](float value) {
+        return static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, std::round(value))));
+    });
+
+    return samples;
+}
+
+// feeds the far end in step with the capture, like a playing output would
+std::vector<int16_t> runProcessor(projection::AudioInputProcessor& processor, projection::IAudioOutput::PlaybackObserver* farEndSource,
+                                  const std::vector<int16_t>& farEnd, std::vector<int16_t> capture)
+{
+    for(size_t offset = 0; offset + cFrameSize <= capture.size(); offset += cFrameSize)
+    {
+        if(farEndSource != nullptr)
+        {
+            (*farEndSource)(reinterpret_cast<const char*>(farEnd.data() + offset), cFrameSize * sizeof(int16_t), cSampleRate, 1);
+        }
+        processor.process(capture.data() + offset, cFrameSize);
+    }
+
+    return capture;
+}
+
+double energy(const std::vector<int16_t>& samples, size_t begin, size_t end)
+{
+    double sum = 0;
+    for(size_t i = begin; i < end; ++i)
+    {
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+
+    return sum;
+}
+
+}
+
+constexpr double InputProcessingBenchmark::cMinEchoReturnLossEnhancement;
+constexpr double InputProcessingBenchmark::cMinNoiseReduction;
+constexpr double InputProcessingBenchmark::cMaxSpeechLoss;
+
+InputProcessingResult InputProcessingBenchmark::run()
+{
+    InputProcessingResult result;
+    result.echoReturnLossEnhancement = measureEchoCancellation();
+    measureNoiseSuppression(result);
+    measureFrameTime(result);
+    return result;
+}
+
+std::vector<float> InputProcessingBenchmark::createFarEnd(size_t frameCount)
+{
+    // low passed noise in syllable long bursts, closer to speech and music than a tone
+    const double pi = std::acos(-1.0);
+    std::mt19937 generator(1);
+    std::normal_distribution<float> distribution(0.0f, 6000.0f);
+    std::vector<float> farEnd(frameCount);
+    float state = 0.0f;
+
+    for(size_t i = 0; i < frameCount; ++i)
+    {
+        state = 0.7f * state + 0.3f * distribution(generator);
+        farEnd[i] = state * static_cast<float>(0.2 + std::fabs(std::sin(2.0 * pi * 3.0 * i / cSampleRate)));
+    }
+
+    return farEnd;
+}
+
+std::vector<float> InputProcessingBenchmark::createEcho(const std::vector<float>& farEnd)
+{
+    // a delayed, exponentially decaying random response, the loudspeaker to microphone path
+    std::mt19937 generator(2);
+    std::normal_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<float> response(cEchoDelay + cEchoLength, 0.0f);
+    for(size_t i = 0; i < cEchoLength; ++i)
+    {
+        response[cEchoDelay + i] = 0.05f * distribution(generator) * std::exp(-6.0f * i / cEchoLength);
+    }
+
+    std::vector<float> echo(farEnd.size(), 0.0f);
+    for(size_t i = 0; i < farEnd.size(); ++i)
+    {
+        for(size_t j = 0; j < response.size() && j <= i; ++j)
+        {
+            echo[i] += response[j] * farEnd[i - j];
+        }
+    }
+
+    return echo;
+}
+
+double InputProcessingBenchmark::measureEchoCancellation()
+{
+    const size_t frameCount = cSampleRate * cDurationSeconds;
+    const auto farEnd = createFarEnd(frameCount);
+    const auto capture = toSamples(createEcho(farEnd));
+
+    auto echoReference = std::make_shared<projection::EchoReference>(cSampleRate);
+    auto farEndSource = echoReference->createSource();
+    projection::AudioInputProcessor processor(cSampleRate, echoReference);
+    processor.setEchoCancellation(true);
+
+    const auto output = runProcessor(processor, &farEndSource, toSamples(farEnd), capture);
+    const size_t begin = frameCount - cSampleRate * cMeasuredSeconds;
+    const size_t latency = processor.getLatencyFrames();
+
+    return 10.0 * std::log10(energy(capture, begin - latency, frameCount - latency) / std::max(energy(output, begin, frameCount), 1.0));
+}
+
+void InputProcessingBenchmark::measureNoiseSuppression(InputProcessingResult& result)
+{
+    // half a second of tone, half a second of noise only
+    const double pi = std::acos(-1.0);
+    const size_t frameCount = cSampleRate * cDurationSeconds;
+    std::mt19937 generator(3);
+    std::normal_distribution<float> distribution(0.0f, static_cast<float>(cNoiseLevel));
+    std::vector<float> noise(frameCount);
+    std::vector<float> tone(frameCount, 0.0f);
+
+    for(size_t i = 0; i < frameCount; ++i)
+    {
+        noise[i] = distribution(generator);
+        if((i / (cSampleRate / 2)) % 2 == 1)
+        {
+            tone[i] = static_cast<float>(cToneAmplitude * std::sin(2.0 * pi * 440.0 * i / cSampleRate));
+        }
+    }
+
+    std::vector<float> capture(frameCount);
+    std::transform(noise.begin(), noise.end(), tone.begin(), capture.begin(), [](float first, float second) { return first + second; });
+
+    projection::AudioInputProcessor processor(cSampleRate, nullptr);
+    processor.setNoiseSuppression(true);
+    const auto output = runProcessor(processor, nullptr, {}, toSamples(capture));
+    const auto input = toSamples(capture);
+    const size_t latency = processor.getLatencyFrames();
+
+    // the middle of every half second, away from the edges the gain needs time to follow
+    double noiseIn = 0, noiseOut = 0, toneIn = 0, toneOut = 0;
+    for(size_t start = frameCount - cSampleRate * cMeasuredSeconds; start + cSampleRate / 2 <= frameCount; start += cSampleRate / 2)
+    {
+        const size_t begin = start + cSampleRate / 8;
+        const size_t end = start + cSampleRate * 3 / 8;
+        const bool toneOn = (start / (cSampleRate / 2)) % 2 == 1;
+        (toneOn ? toneIn : noiseIn) += energy(input, begin, end);
+        (toneOn ? toneOut : noiseOut) += energy(output, begin + latency, end + latency);
+    }
+
+    result.noiseReduction = 10.0 * std::log10(noiseIn / std::max(noiseOut, 1.0));
+    result.speechLoss = 10.0 * std::log10(toneIn / std::max(toneOut, 1.0));
+}
+
+void InputProcessingBenchmark::measureFrameTime(InputProcessingResult& result)
+{
+    const size_t frameCount = cSampleRate * cDurationSeconds;
+    const auto farEnd = createFarEnd(frameCount);
+    auto capture = createEcho(farEnd);
+    std::mt19937 generator(4);
+    std::normal_distribution<float> distribution(0.0f, static_cast<float>(cNoiseLevel));
+    for(auto& sample : capture)
+    {
+        sample += distribution(generator);
+    }
+
+    auto echoReference = std::make_shared<projection::EchoReference>(cSampleRate);
+    auto farEndSource = echoReference->createSource();
+    projection::AudioInputProcessor processor(cSampleRate, echoReference);
+    processor.setEchoCancellation(true);
+    processor.setNoiseSuppression(true);
+    runProcessor(processor, &farEndSource, toSamples(farEnd), toSamples(capture));
+
+    const auto statistics = processor.getStatistics();
+    result.meanFrameTime = statistics.frames > 0 ? statistics.totalTime / 1000.0 / statistics.frames : 0;
+    result.maxFrameTime = statistics.maxTime / 1000.0;
+    result.overBudgetFrames = statistics.overBudgetFrames;
+}
+
+bool InputProcessingBenchmark::print(const InputProcessingResult& result, std::ostream& stream)
+{
+    const bool echoPassed = result.echoReturnLossEnhancement >= cMinEchoReturnLossEnhancement;
+    const bool noisePassed = result.noiseReduction >= cMinNoiseReduction && result.speechLoss <= cMaxSpeechLoss;
+    const bool timePassed = result.meanFrameTime <= std::chrono::duration<double, std::micro>(projection::AudioInputProcessor::cFrameBudget).count();
+
+    stream << "echo cancellation ERLE: " << result.echoReturnLossEnhancement << "dB"
+           << (echoPassed ? "" : " FAILED") << std::endl;
+    stream << "noise suppression noise: -" << result.noiseReduction << "dB, speech: -" << result.speechLoss << "dB"
+           << (noisePassed ? "" : " FAILED") << std::endl;
+    stream << "frame time mean: " << result.meanFrameTime << "us, max: " << result.maxFrameTime << "us"
+           << ", over budget: " << result.overBudgetFrames
+           << (timePassed ? "" : " FAILED") << std::endl;
+
+    return echoPassed && noisePassed && timePassed;
+}
+
+}
+}
@@ -0,0 +1,184 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include "openauto/Projection/H264NalScanner.hpp"
+#include "replay/NalScannerBenchmark.hpp"
+
+namespace openauto
+{
+namespace replay
+{
+
+namespace
+{
+
+const std::vector<uint8_t> cDelimiter{0x00, 0x00, 0x00, 0x01};
+
+// random slice data, escaped the way an encoder does it so it never contains a start code
+void appendUnit(std::vector<uint8_t>& message, uint8_t header, size_t size, std::mt19937& generator)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    message.insert(message.end(), cDelimiter.begin(), cDelimiter.end());
+    message.push_back(header);
+
+    unsigned int zeros = 0;
+    for(size_t i = 1; i < size; ++i)
+    {
+        // plenty of zero runs to exercise the escaping and the candidate checks
+        const uint8_t value = byte(generator) < 48 ? 0x00 : static_cast<uint8_t>(byte(generator));
+        if(zeros >= 2 && value <= 0x03)
+        {
+            message.push_back(0x03);
+            zeros = 0;
+        }
+
+        message.push_back(value);
+        zeros = value == 0x00 ? zeros + 1 : 0;
+    }
+
+    if(message.back() == 0x00)
+    {
+        message.back() = 0x80;
+    }
+}
+
+}
+
+constexpr size_t NalScannerBenchmark::cGopLength;
+constexpr size_t NalScannerBenchmark::cIdrSize;
+constexpr size_t NalScannerBenchmark::cSliceSize;
+constexpr size_t NalScannerBenchmark::cMessageCount;
+constexpr size_t NalScannerBenchmark::cRepetitions;
+
+std::vector<NalScannerResult> NalScannerBenchmark::run()
+{
+    const auto session = createSession();
+    std::vector<NalScannerResult> results;
+
+    results.push_back(measure("before", session, [](const Message& message) {
+        // what write() did with a message: copy it, then search the copy for the next delimiter
+        std::vector<uint8_t> incomingBuffer(message.begin(), message.end());
+        size_t units = 0;
+        auto unit = std::search(incomingBuffer.begin(), incomingBuffer.end(), cDelimiter.begin(), cDelimiter.end());
+
+        while(unit != incomingBuffer.end())
+        {
+            auto next = std::search(unit + cDelimiter.size(), incomingBuffer.end(), cDelimiter.begin(), cDelimiter.end());
+            std::vector<uint8_t> unitData(unit, next);
+            units += unitData.empty() ? 0 : 1;
+            unit = next;
+        }
+        return units;
+    }));
+
+    results.push_back(measure("after", session, [](const Message& message) {
+        projection::H264NalScanner scanner(message.data(), message.size());
+        projection::NalUnit unit;
+        size_t units = 0;
+
+        while(scanner.next(unit))
+        {
+            ++units;
+        }
+        return units;
+    }));
+
+    return results;
+}
+
+std::vector<NalScannerBenchmark::Message> NalScannerBenchmark::createSession()
+{
+    std::mt19937 generator(1673);
+    std::vector<Message> session(cMessageCount);
+
+    for(size_t i = 0; i < session.size(); ++i)
+    {
+        auto& message = session[i];
+        if(i % cGopLength == 0)
+        {
+            appendUnit(message, 0x67, 24, generator);
+            appendUnit(message, 0x68, 4, generator);
+            appendUnit(message, 0x65, cIdrSize, generator);
+        }
+        else
+        {
+            appendUnit(message, 0x41, cSliceSize, generator);
+        }
+    }
+
+    return session;
+}
+
+template<typename SplitFunction>
+NalScannerResult NalScannerBenchmark::measure(std::string name, const std::vector<Message>& session, SplitFunction split)
+{
+    size_t bytes = 0;
+    for(const auto& message : session)
+    {
+        bytes += message.size();
+    }
+
+    NalScannerResult result;
+    result.name = std::move(name);
+    double best = 0;
+
+    for(size_t repetition = 0; repetition < cRepetitions; ++repetition)
+    {
+        size_t units = 0;
+        const auto started = std::chrono::steady_clock::now();
+        for(const auto& message : session)
+        {
+            units += split(message);
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        result.units = units;
+        best = repetition == 0 ? elapsed : std::min(best, elapsed);
+    }
+
+    result.nanosecondsPerMessage = best * 1e9 / session.size();
+    result.megabytesPerSecond = best > 0 ? bytes / best / 1e6 : 0;
+    return result;
+}
+
+bool NalScannerBenchmark::print(const std::vector<NalScannerResult>& results, std::ostream& stream)
+{
+    for(const auto& result : results)
+    {
+        stream << "nal scanner " << result.name
+               << " units: " << result.units
+               << ", ns/message: " << result.nanosecondsPerMessage
+               << ", MB/s: " << result.megabytesPerSecond << std::endl;
+    }
+
+    // both have to find the same units and the scanner has to be the faster one
+    if(results.size() != 2 || results[0].units != results[1].units || results[1].nanosecondsPerMessage >= results[0].nanosecondsPerMessage)
+    {
+        stream << "nal scanner FAILED" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+}
+}
@@ -0,0 +1,178 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <ctime>
+#include <thread>
+#include "replay/ReplayDriver.hpp"
+#include "OpenautoTrace.hpp"
+
+namespace openauto
+{
+namespace replay
+{
+
+namespace
+{
+
+double cpuTime(clockid_t clock)
+{
+    timespec time;
+    clock_gettime(clock, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+}
+
+constexpr std::chrono::milliseconds ReplayDriver::cLateThreshold;
+
+ReplayDriver::ReplayDriver(const capture::CaptureReader& reader, ReplayPacing pacing)
+    : reader_(reader)
+    , pacing_(pacing)
+{
+
+}
+
+ReplayStatistics ReplayDriver::replayVideo(const std::string& backend, projection::IVideoOutput::Pointer output)
+{
+    output->open();
+    output->init();
+    output->getLatencyTracker()->reset();
+
+    auto statistics = this->replay(aasdk::messenger::ChannelId::VIDEO, [&output](const capture::CaptureRecord& record) {
+        output->getLatencyTracker()->onReceived();
+        TRACE_SCOPE_VALUE("output", "video write", "size", record.size);
+        output->write(record.timestamp, aasdk::common::DataConstBuffer(record.data, record.size));
+    });
+
+    statistics.backend = backend;
+    statistics.latency = output->getLatencyTracker()->getReport().stages[static_cast<size_t>(projection::VideoLatencyStage::RECEIVE_TO_RENDER)];
+    output->stop();
+    return statistics;
+}
+
+ReplayStatistics ReplayDriver::replayAudio(const std::string& backend, aasdk::messenger::ChannelId channel, projection::IAudioOutput::Pointer output)
+{
+    if(!output->open())
+    {
+        ReplayStatistics statistics;
+        statistics.backend = backend;
+        statistics.channel = aasdk::messenger::channelIdToString(channel);
+        return statistics;
+    }
+
+    output->start();
+    const auto underruns = output->getUnderrunCount();
+    const auto lateCallbacks = output->getLateCallbackCount();
+
+    auto statistics = this->replay(channel, [&output](const capture::CaptureRecord& record) {
+        TRACE_SCOPE_VALUE("output", "audio write", "size", record.size);
+        output->write(record.timestamp, aasdk::common::DataConstBuffer(record.data, record.size));
+    });
+
+    statistics.backend = backend;
+    statistics.underruns = output->getUnderrunCount() - underruns;
+    statistics.lateCallbacks = output->getLateCallbackCount() - lateCallbacks;
+    output->stop();
+    return statistics;
+}
+
+ReplayStatistics ReplayDriver::replay(aasdk::messenger::ChannelId channel, RecordHandler handler)
+{
+    ReplayStatistics statistics;
+    statistics.channel = aasdk::messenger::channelIdToString(channel);
+
+    const auto startTime = Clock::now();
+    const auto processCpuTime = cpuTime(CLOCK_PROCESS_CPUTIME_ID);
+    const auto driverCpuTime = cpuTime(CLOCK_THREAD_CPUTIME_ID);
+    bool first = true;
+    uint64_t firstCaptureTime = 0;
+
+    capture::CaptureRecord record;
+    for(size_t i = 0; reader_.getRecord(i, record); ++i)
+    {
+        if(record.type != capture::CaptureRecordType::MEDIA || record.channel != channel)
+        {
+            continue;
+        }
+
+        if(first)
+        {
+            firstCaptureTime = record.captureTime;
+            first = false;
+        }
+
+        if(pacing_ == ReplayPacing::ORIGINAL)
+        {
+            const auto due = startTime + std::chrono::microseconds(record.captureTime - firstCaptureTime);
+            const auto now = Clock::now();
+            if(now < due)
+            {
+                std::this_thread::sleep_until(due);
+            }
+            else if(now - due > cLateThreshold)
+            {
+                ++statistics.lateRecords;
+            }
+        }
+
+        const auto writeStart = Clock::now();
+        handler(record);
+        const auto writeTime = std::chrono::duration<double>(Clock::now() - writeStart).count();
+
+        statistics.totalWriteTime += writeTime;
+        statistics.maxWriteTime = std::max(statistics.maxWriteTime, writeTime);
+        ++statistics.records;
+        statistics.bytes += record.size;
+    }
+
+    statistics.wallTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+    statistics.processCpuTime = cpuTime(CLOCK_PROCESS_CPUTIME_ID) - processCpuTime;
+    statistics.driverCpuTime = cpuTime(CLOCK_THREAD_CPUTIME_ID) - driverCpuTime;
+    return statistics;
+}
+
+void ReplayDriver::print(const ReplayStatistics& statistics, std::ostream& stream)
+{
+    const double wallTime = statistics.wallTime > 0 ? statistics.wallTime : 1;
+
+    stream << statistics.backend << " [" << statistics.channel << "]"
+           << " records: " << statistics.records
+           << ", bytes: " << statistics.bytes
+           << ", wall: " << statistics.wallTime << "s"
+           << ", records/s: " << statistics.records / wallTime
+           << ", MB/s: " << statistics.bytes / wallTime / (1024 * 1024)
+           << ", process cpu: " << statistics.processCpuTime << "s"
+           << ", driver cpu: " << statistics.driverCpuTime << "s"
+           << ", write avg: " << (statistics.records > 0 ? statistics.totalWriteTime / statistics.records * 1e3 : 0) << "ms"
+           << ", write max: " << statistics.maxWriteTime * 1e3 << "ms"
+           << ", late: " << statistics.lateRecords
+           << ", underruns: " << statistics.underruns
+           << ", late callbacks: " << statistics.lateCallbacks;
+
+    if(statistics.latency.count > 0)
+    {
+        stream << ", latency p50/p95/p99: " << statistics.latency.p50 << "/" << statistics.latency.p95 << "/" << statistics.latency.p99 << "us";
+    }
+
+    stream << std::endl;
+}
+
+}
+}
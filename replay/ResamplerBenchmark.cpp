@@ -0,0 +1,184 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <chrono>
+#include <cmath>
+#include "openauto/Projection/AudioResampler.hpp"
+#include "replay/ResamplerBenchmark.hpp"
+
+namespace openauto
+{
+namespace replay
+{
+
+namespace
+{
+
+constexpr double cToneFrequency = 1000.0;
+constexpr double cToneAmplitude = 23197.0; // -3 dBFS
+constexpr size_t cDurationSeconds = 4;
+constexpr size_t cBlockFrames = 1024;
+
+}
+
+constexpr double ResamplerBenchmark::cMaxThdN;
+
+std::vector<ResamplerResult> ResamplerBenchmark::run()
+{
+    std::vector<ResamplerResult> results;
+
+    // phone streams to the usual device rates and back for the microphone
+    for(uint32_t deviceRate : {44100, 48000})
+    {
+        results.push_back(measure(16000, 1, deviceRate, 2));
+        results.push_back(measure(48000, 2, deviceRate, 2));
+        results.push_back(measure(deviceRate, 2, 16000, 1));
+    }
+
+    return results;
+}
+
+ResamplerResult ResamplerBenchmark::measure(uint32_t inputRate, uint32_t inputChannels, uint32_t outputRate, uint32_t outputChannels)
+{
+    const double pi = std::acos(-1.0);
+    const size_t inputFrames = inputRate * cDurationSeconds;
+    std::vector<int16_t> input(inputFrames * inputChannels);
+    for(size_t frame = 0; frame < inputFrames; ++frame)
+    {
+        const auto sample = static_cast<int16_t>(std::lrint(cToneAmplitude * std::sin(2.0 * pi * cToneFrequency * frame / inputRate)));
+        for(uint32_t channel = 0; channel < inputChannels; ++channel)
+        {
+            input[frame * inputChannels + channel] = sample;
+        }
+    }
+
+    projection::AudioResampler resampler(inputRate, inputChannels, outputRate, outputChannels, cBlockFrames);
+    std::vector<int16_t> output;
+    output.reserve((static_cast<size_t>(outputRate) * cDurationSeconds + cBlockFrames) * outputChannels);
+    std::vector<int16_t> block(cBlockFrames * 4 * outputChannels);
+
+    const auto started = std::chrono::steady_clock::now();
+    for(size_t offset = 0; offset < inputFrames;)
+    {
+        offset += resampler.write(input.data() + offset * inputChannels, std::min(cBlockFrames, inputFrames - offset));
+
+        size_t frames = 0;
+        while((frames = resampler.read(block.data(), block.size() / outputChannels)) > 0)
+        {
+            output.insert(output.end(), block.begin(), block.begin() + frames * outputChannels);
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    // skip the filter settling at both ends, measure on the last channel so up-mixed copies are covered
+    const size_t outputFrames = output.size() / outputChannels;
+    const size_t margin = resampler.getTapCount() * 2;
+    std::vector<float> samples;
+    for(size_t frame = margin; frame + margin < outputFrames; ++frame)
+    {
+        samples.push_back(output[frame * outputChannels + outputChannels - 1]);
+    }
+
+    ResamplerResult result;
+    result.inputRate = inputRate;
+    result.inputChannels = inputChannels;
+    result.outputRate = outputRate;
+    result.outputChannels = outputChannels;
+    result.taps = resampler.getTapCount();
+    result.thdN = thdN(samples, cToneFrequency, outputRate);
+    result.realtimeFactor = elapsed > 0 ? cDurationSeconds / elapsed : 0;
+    return result;
+}
+
+double ResamplerBenchmark::thdN(const std::vector<float>& samples, double frequency, double sampleRate)
+{
+    // least squares fit of sine, cosine and DC, everything left over is distortion and noise
+    const double pi = std::acos(-1.0);
+    double normal[3][3] = {};
+    double projection[3] = {};
+
+    for(size_t n = 0; n < samples.size(); ++n)
+    {
+        const double basis[3] = {std::sin(2.0 * pi * frequency * n / sampleRate), std::cos(2.0 * pi * frequency * n / sampleRate), 1.0};
+        for(int i = 0; i < 3; ++i)
+        {
+            projection[i] += basis[i] * samples[n];
+            for(int j = 0; j < 3; ++j)
+            {
+                normal[i][j] += basis[i] * basis[j];
+            }
+        }
+    }
+
+    auto determinant = [](const double m[3][3]) {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+             - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+             + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    };
+
+    double coefficients[3];
+    const double denominator = determinant(normal);
+    for(int k = 0; k < 3; ++k)
+    {
+        double replaced[3][3];
+        for(int i = 0; i < 3; ++i)
+        {
+            for(int j = 0; j < 3; ++j)
+            {
+                replaced[i][j] = j == k ? projection[i] : normal[i][j];
+            }
+        }
+        coefficients[k] = determinant(replaced) / denominator;
+    }
+
+    double residual = 0;
+    double signal = 0;
+    for(size_t n = 0; n < samples.size(); ++n)
+    {
+        const double fit = coefficients[0] * std::sin(2.0 * pi * frequency * n / sampleRate) + coefficients[1] * std::cos(2.0 * pi * frequency * n / sampleRate);
+        const double error = samples[n] - fit - coefficients[2];
+        residual += error * error;
+        signal += fit * fit;
+    }
+
+    return signal > 0 ? 10.0 * std::log10(residual / signal) : 0;
+}
+
+bool ResamplerBenchmark::print(const std::vector<ResamplerResult>& results, std::ostream& stream)
+{
+    bool passed = true;
+
+    for(const auto& result : results)
+    {
+        const bool resultPassed = result.thdN <= cMaxThdN;
+        passed = passed && resultPassed;
+
+        stream << "resampler " << result.inputRate << "Hz/" << result.inputChannels << "ch -> "
+               << result.outputRate << "Hz/" << result.outputChannels << "ch"
+               << " taps: " << result.taps
+               << ", THD+N: " << result.thdN << "dB"
+               << ", realtime x" << result.realtimeFactor
+               << (resultPassed ? "" : " FAILED") << std::endl;
+    }
+
+    return passed;
+}
+
+}
+}
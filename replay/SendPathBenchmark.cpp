@@ -0,0 +1,184 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <chrono>
+#include <functional>
+#include <boost/asio.hpp>
+#include "aasdk_proto/InputEventIndicationMessage.pb.h"
+#include "aasdk_proto/AVMediaAckIndicationMessage.pb.h"
+#include "aasdk/Channel/Promise.hpp"
+#include "openauto/Service/SendPromisePool.hpp"
+#include "replay/AllocationCounter.hpp"
+#include "replay/SendPathBenchmark.hpp"
+
+namespace openauto
+{
+namespace replay
+{
+
+namespace
+{
+
+// stands in for the service the std::bind reject handlers keep alive
+class ErrorSink: public std::enable_shared_from_this<ErrorSink>
+{
+public:
+    void onChannelError(const aasdk::error::Error&)
+    {
+    }
+};
+
+void fillTouchEvent(aasdk::proto::messages::InputEventIndication& indication, uint64_t timestamp)
+{
+    indication.set_timestamp(timestamp);
+    auto touchEvent = indication.mutable_touch_event();
+    touchEvent->set_touch_action(aasdk::proto::enums::TouchAction::DRAG);
+    auto touchLocation = touchEvent->add_touch_location();
+    touchLocation->set_x(400);
+    touchLocation->set_y(240);
+    touchLocation->set_pointer_id(0);
+}
+
+}
+
+constexpr double SendPathBenchmark::cMessageRate;
+constexpr size_t SendPathBenchmark::cWarmupCount;
+constexpr size_t SendPathBenchmark::cMessageCount;
+
+std::vector<SendPathResult> SendPathBenchmark::run()
+{
+    std::vector<SendPathResult> results;
+    auto errorSink = std::make_shared<ErrorSink>();
+    volatile uint64_t sink = 0;
+
+    results.push_back(measure("ack before", [&](boost::asio::io_service::strand& strand, uint64_t index) {
+        aasdk::proto::messages::AVMediaAckIndication indication;
+        indication.set_session(0);
+        indication.set_value(1);
+        sink = sink + indication.value() + index;
+
+        auto promise = aasdk::channel::SendPromise::defer(strand);
+        promise->then([]() {}, std::bind(&ErrorSink::onChannelError, errorSink->shared_from_this(), std::placeholders::_1));
+        promise->resolve();
+    }));
+
+    results.push_back(measure("ack after", [&](boost::asio::io_service::strand& strand, uint64_t index) {
+        aasdk::proto::messages::AVMediaAckIndication indication;
+        indication.set_session(0);
+        indication.set_value(1);
+        sink = sink + indication.value() + index;
+
+        auto promise = service::SendPromisePool::defer(strand);
+        promise->then([]() {}, [](const aasdk::error::Error&) {});
+        promise->resolve();
+    }));
+
+    results.push_back(measure("touch before", [&](boost::asio::io_service::strand& strand, uint64_t index) {
+        aasdk::proto::messages::InputEventIndication indication;
+        fillTouchEvent(indication, index);
+        sink = sink + indication.touch_event().touch_location_size();
+
+        auto promise = aasdk::channel::SendPromise::defer(strand);
+        promise->then([]() {}, std::bind(&ErrorSink::onChannelError, errorSink->shared_from_this(), std::placeholders::_1));
+        promise->resolve();
+    }));
+
+    aasdk::proto::messages::InputEventIndication reusedIndication;
+    results.push_back(measure("touch after", [&](boost::asio::io_service::strand& strand, uint64_t index) {
+        reusedIndication.Clear();
+        fillTouchEvent(reusedIndication, index);
+        sink = sink + reusedIndication.touch_event().touch_location_size();
+
+        auto promise = service::SendPromisePool::defer(strand);
+        promise->then([]() {}, [](const aasdk::error::Error&) {});
+        promise->resolve();
+    }));
+
+    return results;
+}
+
+template<typename SendFunction>
+SendPathResult SendPathBenchmark::measure(std::string name, SendFunction send)
+{
+    boost::asio::io_service ioService;
+    boost::asio::io_service::strand strand(ioService);
+    std::chrono::steady_clock::time_point started;
+    uint64_t index = 0;
+
+    // each message posts the next one, so the resolve handlers run in between as they would in a session
+    std::function<void()> step = [&]() {
+        if(index == cWarmupCount)
+        {
+            started = std::chrono::steady_clock::now();
+            AllocationCounter::start();
+        }
+
+        send(strand, index);
+
+        if(++index < cWarmupCount + cMessageCount)
+        {
+            strand.post([&step]() { step(); });
+        }
+    };
+
+    strand.post([&step]() { step(); });
+    ioService.run();
+    const auto allocations = AllocationCounter::stop();
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    SendPathResult result;
+    result.name = std::move(name);
+    result.allocationsPerMessage = static_cast<double>(allocations) / cMessageCount;
+    result.allocationsPerSecond = result.allocationsPerMessage * cMessageRate;
+    result.messagesPerSecond = elapsed > 0 ? cMessageCount / elapsed : 0;
+    return result;
+}
+
+bool SendPathBenchmark::print(const std::vector<SendPathResult>& results, std::ostream& stream)
+{
+    bool passed = true;
+
+    for(const auto& result : results)
+    {
+        stream << "send path " << result.name
+               << " allocations/message: " << result.allocationsPerMessage
+               << ", allocations/s at " << cMessageRate << " messages/s: " << result.allocationsPerSecond
+               << ", messages/s: " << result.messagesPerSecond << std::endl;
+    }
+
+    const auto stats = service::SendPromisePool::getStatistics();
+    stream << "send promise pool allocations: " << stats.allocations
+           << ", heap allocations: " << stats.heapAllocations
+           << ", cached blocks: " << stats.cachedBlocks << std::endl;
+
+    // results come in before/after pairs, the pooled path has to allocate less than the one it replaces
+    for(size_t i = 0; i + 1 < results.size(); i += 2)
+    {
+        if(results[i + 1].allocationsPerMessage >= results[i].allocationsPerMessage)
+        {
+            stream << "send path " << results[i + 1].name << " FAILED" << std::endl;
+            passed = false;
+        }
+    }
+
+    return passed;
+}
+
+}
+}
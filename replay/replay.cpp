@@ -0,0 +1,384 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QApplication>
+#include <QCommandLineParser>
+#include "openauto/Capture/CaptureReader.hpp"
+#include "openauto/Configuration/Configuration.hpp"
+#include "openauto/Projection/QtVideoOutput.hpp"
+#include "openauto/Projection/GSTVideoOutput.hpp"
+#include "openauto/Projection/RtAudioOutput.hpp"
+#include "openauto/Projection/QtAudioOutput.hpp"
+#include "openauto/Projection/NullVideoOutput.hpp"
+#include "openauto/Projection/LibavVideoOutput.hpp"
+#include "openauto/Projection/NullAudioOutput.hpp"
+#include "openauto/Projection/WavFileAudioOutput.hpp"
+#include "openauto/Projection/AudioMixerInput.hpp"
+#include "openauto/Projection/AlsaAudioOutput.hpp"
+#include "replay/ReplayDriver.hpp"
+#include "replay/ResamplerBenchmark.hpp"
+#include "replay/AudioBenchmark.hpp"
+#include "replay/InputProcessingBenchmark.hpp"
+#include "replay/SendPathBenchmark.hpp"
+#include "replay/NalScannerBenchmark.hpp"
+#include "replay/AlsaCheck.hpp"
+#include "OpenautoLog.hpp"
+#include "OpenautoTrace.hpp"
+
+using namespace openauto;
+
+projection::IVideoOutput::Pointer createVideoOutput(const QString& backend, configuration::IConfiguration::Pointer configuration)
+{
+    if(backend == "qt")
+    {
+        return projection::IVideoOutput::Pointer(new projection::QtVideoOutput(configuration), std::bind(&QObject::deleteLater, std::placeholders::_1));
+    }
+    else if(backend == "null")
+    {
+        return std::make_shared<projection::NullVideoOutput>(configuration);
+    }
+#ifdef USE_LIBAV
+    else if(backend == "libav")
+    {
+        return projection::IVideoOutput::Pointer(new projection::LibavVideoOutput(configuration), std::bind(&QObject::deleteLater, std::placeholders::_1));
+    }
+#endif
+
+    return nullptr;
+}
+
+projection::IAudioOutput::Pointer createAudioOutput(const QString& backend, aasdk::messenger::ChannelId channel, const capture::CaptureStreamFormat& format, configuration::IConfiguration::Pointer configuration)
+{
+    if(backend == "rtaudio")
+    {
+        return std::make_shared<projection::RtAudioOutput>(format.channelCount, format.sampleSize, format.sampleRate);
+    }
+    else if(backend == "qt")
+    {
+        return projection::IAudioOutput::Pointer(new projection::QtAudioOutput(format.channelCount, format.sampleSize, format.sampleRate),
+                                                 std::bind(&QObject::deleteLater, std::placeholders::_1));
+    }
+    else if(backend == "null")
+    {
+        return std::make_shared<projection::NullAudioOutput>(format.channelCount, format.sampleSize, format.sampleRate);
+    }
+    else if(backend == "mixer")
+    {
+        return std::make_shared<projection::AudioMixer>()->createInput(format.channelCount, format.sampleSize, format.sampleRate);
+    }
+    else if(backend == "wav")
+    {
+        return std::make_shared<projection::WavFileAudioOutput>(aasdk::messenger::channelIdToString(channel) + ".wav", format.channelCount, format.sampleSize, format.sampleRate);
+    }
+#ifdef USE_ALSA
+    else if(backend == "alsa")
+    {
+        // Audio.AlsaDevice = null in openauto.ini or --alsa-device null runs it without a sound card
+        return std::make_shared<projection::AlsaAudioOutput>(configuration->getAudioAlsaDevice(), configuration->getAudioAlsaPeriodSize(), configuration->getAudioAlsaPeriodCount(),
+                                                             format.channelCount, format.sampleSize, format.sampleRate);
+    }
+#endif
+
+    return nullptr;
+}
+
+capture::CaptureStreamFormat getDefaultStreamFormat(aasdk::messenger::ChannelId channel)
+{
+    // the formats ServiceFactory uses
+    capture::CaptureStreamFormat format;
+    format.sampleRate = channel == aasdk::messenger::ChannelId::MEDIA_AUDIO ? 48000 : 16000;
+    format.channelCount = channel == aasdk::messenger::ChannelId::MEDIA_AUDIO ? 2 : 1;
+    format.sampleSize = 16;
+    format.reserved = 0;
+    return format;
+}
+
+capture::CaptureStreamFormat getStreamFormat(const capture::CaptureReader& reader, aasdk::messenger::ChannelId channel)
+{
+    capture::CaptureStreamFormat format;
+    if(!reader.getFormat(channel, format))
+    {
+        // captures only miss the format when the channel was never opened
+        format = getDefaultStreamFormat(channel);
+    }
+
+    return format;
+}
+
+// Runs the synthetic audio benchmark through every requested backend in the media and speech formats.
+int runAudioBenchmark(const QStringList& backends, std::chrono::seconds duration, configuration::IConfiguration::Pointer configuration)
+{
+    replay::AudioBenchmark benchmark(duration);
+    std::vector<replay::AudioBenchmarkResult> results;
+    int result = 0;
+
+    for(const auto& backend : backends)
+    {
+        for(auto channel : {aasdk::messenger::ChannelId::MEDIA_AUDIO, aasdk::messenger::ChannelId::SPEECH_AUDIO})
+        {
+            auto output = createAudioOutput(backend, channel, getDefaultStreamFormat(channel), configuration);
+            if(output == nullptr)
+            {
+                LOG(error) << "Unknown audio backend " << backend.toStdString();
+                return 1;
+            }
+
+            results.push_back(benchmark.run(backend.toStdString(), channel, std::move(output)));
+            result = replay::AudioBenchmark::passed(results.back()) ? result : 1;
+        }
+    }
+
+    replay::AudioBenchmark::printJson(results, std::cout);
+    return result;
+}
+
+// Keeps cores busy and a lock contended the way the io_service and Qt threads do in a session,
+// the audio callbacks must not be slowed down by it.
+std::vector<std::thread> startLoad(unsigned int threadCount, std::atomic<bool>& running)
+{
+    static std::mutex mutex;
+    std::vector<std::thread> threads;
+
+    for(unsigned int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([&running]() {
+            volatile uint64_t counter = 0;
+            while(running)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for(int j = 0; j < 100000; ++j)
+                {
+                    counter = counter + 1;
+                }
+            }
+        });
+    }
+
+    return threads;
+}
+
+int main(int argc, char* argv[])
+{
+    // CI machines have no display, the Qt based backends still need a platform plugin to start
+    if(getenv("DISPLAY") == nullptr && getenv("WAYLAND_DISPLAY") == nullptr)
+    {
+        setenv("QT_QPA_PLATFORM", "offscreen", 0);
+    }
+
+    QApplication qApplication(argc, argv);
+    OpenAutoLog::init();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays a captured Android Auto session into the openauto media backends.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("capture", "Capture file written with General.CapturePath set.");
+    QCommandLineOption videoOption("video", "Comma separated video backends: qt, gst, libav, null, none.", "backends", "none");
+    QCommandLineOption audioOption("audio", "Comma separated audio backends: rtaudio, mixer, alsa, qt, null, wav, none.", "backends", "none");
+    QCommandLineOption fastOption("fast", "Write as fast as the backend accepts instead of the original timing.");
+    QCommandLineOption logOption("log", "Log severity and per module overrides, e.g. info,VideoService=debug.", "severity", "info");
+    QCommandLineOption traceOption("trace", "Write spans of the backends as Chrome trace JSON, open it in ui.perfetto.dev or chrome://tracing.", "file");
+    QCommandLineOption loadOption("load", "Number of busy threads competing with the backends during the replay.", "threads", "0");
+    parser.addOption(videoOption);
+    parser.addOption(audioOption);
+    parser.addOption(fastOption);
+    QCommandLineOption resamplerOption("resampler", "Benchmark the audio resampler and check its THD+N instead of replaying a capture.");
+    QCommandLineOption inputProcessingOption("input-processing", "Benchmark echo cancellation and noise suppression of the microphone instead of replaying a capture.");
+    QCommandLineOption sendPathOption("send-path", "Count heap allocations of sending media acks and input events with and without pooling instead of replaying a capture.");
+    QCommandLineOption nalScannerOption("nal-scanner", "Benchmark splitting video messages into NAL units against the removed std::search path instead of replaying a capture.");
+    QCommandLineOption audioBenchmarkOption("audio-benchmark", "Measure latency and glitches of the --audio backends with a synthetic signal and print them as JSON instead of replaying a capture.", "seconds");
+    parser.addOption(loadOption);
+    parser.addOption(resamplerOption);
+    parser.addOption(audioBenchmarkOption);
+    parser.addOption(inputProcessingOption);
+    parser.addOption(sendPathOption);
+    parser.addOption(nalScannerOption);
+#ifdef USE_ALSA
+    QCommandLineOption alsaCheckOption("alsa-check", "Check the ALSA backend through an xrun recovery and a suspend/start cycle instead of replaying a capture.");
+    QCommandLineOption alsaDeviceOption("alsa-device", "ALSA device instead of Audio.AlsaDevice, null needs no sound card.", "device");
+    parser.addOption(alsaCheckOption);
+    parser.addOption(alsaDeviceOption);
+#endif
+    parser.addOption(logOption);
+    parser.addOption(traceOption);
+    parser.process(qApplication);
+    OpenAutoLog::configure(parser.value(logOption).toStdString());
+
+    if(parser.isSet(traceOption))
+    {
+        trace::Tracer::getInstance().start(parser.value(traceOption).toStdString());
+    }
+
+    // --alsa-device overrides Audio.AlsaDevice for every ALSA output created below
+    auto createConfiguration = [&]() {
+        auto configuration = std::make_shared<configuration::Configuration>();
+#ifdef USE_ALSA
+        if(parser.isSet(alsaDeviceOption))
+        {
+            configuration->setAudioAlsaDevice(parser.value(alsaDeviceOption).toStdString());
+        }
+#endif
+        return configuration;
+    };
+
+    if(parser.isSet(resamplerOption))
+    {
+        return replay::ResamplerBenchmark::print(replay::ResamplerBenchmark::run(), std::cout) ? 0 : 1;
+    }
+
+    if(parser.isSet(inputProcessingOption))
+    {
+        return replay::InputProcessingBenchmark::print(replay::InputProcessingBenchmark::run(), std::cout) ? 0 : 1;
+    }
+
+    if(parser.isSet(sendPathOption))
+    {
+        return replay::SendPathBenchmark::print(replay::SendPathBenchmark::run(), std::cout) ? 0 : 1;
+    }
+
+    if(parser.isSet(nalScannerOption))
+    {
+        return replay::NalScannerBenchmark::print(replay::NalScannerBenchmark::run(), std::cout) ? 0 : 1;
+    }
+
+#ifdef USE_ALSA
+    if(parser.isSet(alsaCheckOption))
+    {
+        auto configuration = createConfiguration();
+        return replay::AlsaCheck::print(replay::AlsaCheck::run(configuration->getAudioAlsaDevice(), configuration->getAudioAlsaPeriodSize(), configuration->getAudioAlsaPeriodCount()), std::cout) ? 0 : 1;
+    }
+#endif
+
+    if(parser.isSet(audioBenchmarkOption))
+    {
+        // the Qt backend needs the event loop, the benchmark runs beside it like the replay does
+        auto configuration = createConfiguration();
+        const auto audioBackends = parser.value(audioOption).split(",", QString::SkipEmptyParts);
+        const std::chrono::seconds duration(std::max(1u, parser.value(audioBenchmarkOption).toUInt()));
+        std::atomic<bool> loadRunning(true);
+        auto loadThreads = startLoad(parser.value(loadOption).toUInt(), loadRunning);
+
+        int result = 0;
+        std::thread worker([&]() {
+            result = runAudioBenchmark(audioBackends, duration, configuration);
+            QMetaObject::invokeMethod(&qApplication, "quit", Qt::QueuedConnection);
+        });
+
+        qApplication.exec();
+        worker.join();
+
+        loadRunning = false;
+        for(auto& thread : loadThreads)
+        {
+            thread.join();
+        }
+
+        return result;
+    }
+
+    if(parser.positionalArguments().size() != 1)
+    {
+        parser.showHelp(1);
+    }
+
+    capture::CaptureReader reader;
+    if(!reader.open(parser.positionalArguments().front().toStdString()))
+    {
+        return 1;
+    }
+
+    auto configuration = createConfiguration();
+    const auto videoBackends = parser.value(videoOption).split(",", QString::SkipEmptyParts);
+    const auto audioBackends = parser.value(audioOption).split(",", QString::SkipEmptyParts);
+    replay::ReplayDriver driver(reader, parser.isSet(fastOption) ? replay::ReplayPacing::FAST : replay::ReplayPacing::ORIGINAL);
+
+#ifdef USE_GST
+    // like in ServiceFactory the GStreamer output has to be created on the main thread
+    std::shared_ptr<projection::GSTVideoOutput> gstVideoOutput;
+    if(videoBackends.contains("gst"))
+    {
+        QGst::init(nullptr, nullptr);
+        gstVideoOutput = std::make_shared<projection::GSTVideoOutput>(configuration);
+    }
+#endif
+
+    std::atomic<bool> loadRunning(true);
+    auto loadThreads = startLoad(parser.value(loadOption).toUInt(), loadRunning);
+
+    int result = 0;
+    std::thread worker([&]() {
+        for(const auto& backend : videoBackends)
+        {
+            auto output = createVideoOutput(backend, configuration);
+#ifdef USE_GST
+            if(backend == "gst")
+            {
+                output = gstVideoOutput;
+            }
+#endif
+            if(output != nullptr)
+            {
+                replay::ReplayDriver::print(driver.replayVideo(backend.toStdString(), std::move(output)), std::cout);
+            }
+            else if(backend != "none")
+            {
+                LOG(error) << "Unknown video backend " << backend.toStdString();
+                result = 1;
+            }
+        }
+
+        for(const auto& backend : audioBackends)
+        {
+            for(auto channel : {aasdk::messenger::ChannelId::MEDIA_AUDIO, aasdk::messenger::ChannelId::SPEECH_AUDIO, aasdk::messenger::ChannelId::SYSTEM_AUDIO})
+            {
+                auto output = createAudioOutput(backend, channel, getStreamFormat(reader, channel), configuration);
+                if(output != nullptr)
+                {
+                    replay::ReplayDriver::print(driver.replayAudio(backend.toStdString(), channel, std::move(output)), std::cout);
+                }
+                else if(backend != "none")
+                {
+                    LOG(error) << "Unknown audio backend " << backend.toStdString();
+                    result = 1;
+                    break;
+                }
+            }
+        }
+
+        QMetaObject::invokeMethod(&qApplication, "quit", Qt::QueuedConnection);
+    });
+
+    qApplication.exec();
+    worker.join();
+
+    loadRunning = false;
+    for(auto& thread : loadThreads)
+    {
+        thread.join();
+    }
+
+    return result;
+}
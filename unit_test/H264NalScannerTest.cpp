@@ -0,0 +1,283 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstring>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "openauto/Projection/H264NalScanner.hpp"
+
+using namespace openauto::projection;
+
+namespace
+{
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes fromHex(const char* hex)
+{
+    Bytes bytes;
+    for(; hex[0] != '\0' && hex[1] != '\0'; hex += 2)
+    {
+        const char digits[] = {hex[0], hex[1], '\0'};
+        bytes.push_back(static_cast<uint8_t>(strtoul(digits, nullptr, 16)));
+    }
+    return bytes;
+}
+
+Bytes concat(std::initializer_list<Bytes> parts)
+{
+    Bytes bytes;
+    for(const auto& part : parts)
+    {
+        bytes.insert(bytes.end(), part.begin(), part.end());
+    }
+    return bytes;
+}
+
+std::vector<Bytes> scan(const Bytes& stream)
+{
+    H264NalScanner scanner(stream.data(), stream.size());
+    std::vector<Bytes> units;
+    NalUnit unit;
+
+    while(scanner.next(unit))
+    {
+        units.emplace_back(unit.data, unit.data + unit.size);
+    }
+    return units;
+}
+
+NalUnit toUnit(const Bytes& nal)
+{
+    return NalUnit{nal.data(), nal.data(), nal.size()};
+}
+
+const Bytes cStartCode3{0x00, 0x00, 0x01};
+const Bytes cStartCode4{0x00, 0x00, 0x00, 0x01};
+
+// SPS units as sent by the phone and as the removed h264_read_sps()/h264_write_sps() workaround
+// wrote them back: every field re-encoded in h264bitstream's write order with video_signal_type_present_flag
+// cleared. All of them carry timing_info with num_units_in_tick = 1, which needs emulation prevention bytes.
+struct SpsVector
+{
+    const char* name;
+    const char* original;
+    const char* rewritten;
+};
+
+const SpsVector cSpsVectors[] = {
+    // Baseline 1280x720, cropping, colour_description 1/1/1
+    {"baseline", "6742c01fed00a00b7fcd40404050000003001000000780e82211a8",
+                 "6742c01fed00a00b7fc2000003000200000300f01d044235"},
+    // Baseline 800x480, full range, no colour_description
+    {"no colour description", "6742c01fed01907b4d90000003001000000780e82211a8",
+                              "6742c01fed01907b42000003000200000300f01d044235"},
+    // High 1920x1088 cropped to 1080, chroma format info, no scaling matrix
+    {"high", "67640028acda01e0089f966e02020280000003008000003c0741108d40",
+             "67640028acda01e0089f9610000003001000000780e82211a8"},
+    // High 1280x720 with scaling lists 0, 3 and 6, colour_description 6/6/6
+    {"scaling lists", "67640028ad94747610e23151448223311cd9a2097aebaebaebaebaebaebaebaeda014016e9a8303032000003000200000300f01d044235",
+                      "67640028ad94747610e23151448223311cd9a2097aebaebaebaebaebaebaebaeda014016e840000003004000001e03a08846a0"},
+    // Extended_SAR 0:1 puts escaped zeros in front of the rewritten fields as well
+    {"emulation prevention", "6742001fed01907b7fe0000003002d40404050000003001000100000e82211a8",
+                             "6742001fed01907b7fe000000300220000030002000200001d044235"}
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(H264NalScanner_FindsThreeAndFourByteStartCodes)
+{
+    const Bytes sps{0x67, 0x42, 0xc0, 0x1f};
+    const Bytes pps{0x68, 0xce, 0x3c, 0x80};
+    const Bytes idr{0x65, 0x88, 0x84, 0x00, 0x33};
+    const auto units = scan(concat({cStartCode4, sps, cStartCode3, pps, cStartCode4, idr}));
+
+    BOOST_REQUIRE_EQUAL(units.size(), 3u);
+    BOOST_CHECK(units[0] == sps);
+    BOOST_CHECK(units[1] == pps);
+    BOOST_CHECK(units[2] == idr);
+}
+
+BOOST_AUTO_TEST_CASE(H264NalScanner_ReportsStartAndTotalSize)
+{
+    const Bytes stream = concat({cStartCode4, {0x67, 0x42}, cStartCode3, {0x68, 0xce}});
+    H264NalScanner scanner(stream.data(), stream.size());
+    NalUnit unit;
+
+    BOOST_REQUIRE(scanner.next(unit));
+    BOOST_CHECK(unit.type() == NalUnitType::SPS);
+    BOOST_CHECK_EQUAL(unit.refIdc(), 3);
+    BOOST_CHECK(unit.start == stream.data() + 1);
+    BOOST_CHECK_EQUAL(unit.totalSize(), 5u);
+
+    BOOST_REQUIRE(scanner.next(unit));
+    BOOST_CHECK(unit.type() == NalUnitType::PPS);
+    BOOST_CHECK(unit.start == stream.data() + 6);
+    BOOST_CHECK(!scanner.next(unit));
+}
+
+BOOST_AUTO_TEST_CASE(H264NalScanner_FindsStartCodesAcrossVectorBoundaries)
+{
+    // every position around the 16 byte blocks the SSE2 and NEON paths compare at once
+    for(size_t offset = 0; offset < 40; ++offset)
+    {
+        Bytes stream(offset + 8, 0xaa);
+        stream[offset] = 0x00;
+        stream[offset + 1] = 0x00;
+        stream[offset + 2] = 0x01;
+        stream[offset + 3] = 0x65;
+
+        BOOST_CHECK_MESSAGE(H264NalScanner::findStartCode(stream.data(), stream.data() + stream.size()) == stream.data() + offset,
+                            "start code at " << offset);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(H264NalScanner_FindStartCodeReturnsEndWithoutMatch)
+{
+    Bytes stream(64, 0x00);
+    stream[63] = 0x01;
+    stream[62] = 0x02;
+
+    BOOST_CHECK(H264NalScanner::findStartCode(stream.data(), stream.data() + stream.size()) == stream.data() + stream.size());
+    BOOST_CHECK(H264NalScanner::findStartCode(stream.data(), stream.data() + 2) == stream.data() + 2);
+}
+
+BOOST_AUTO_TEST_CASE(H264NalScanner_SkipsTrailingStartCodeWithoutPayload)
+{
+    const Bytes idr{0x65, 0x88, 0x84};
+    const auto units = scan(concat({cStartCode4, idr, cStartCode4}));
+
+    BOOST_REQUIRE_EQUAL(units.size(), 1u);
+    BOOST_CHECK(units[0] == idr);
+    BOOST_CHECK(scan(cStartCode3).empty());
+    BOOST_CHECK(scan(Bytes{0x65, 0x88}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(H264NalScanner_DropsTrailingZeros)
+{
+    const auto units = scan(concat({cStartCode3, {0x41, 0x9a, 0x00, 0x00}, cStartCode3, {0x41, 0x9b}}));
+
+    BOOST_REQUIRE_EQUAL(units.size(), 2u);
+    BOOST_CHECK(units[0] == (Bytes{0x41, 0x9a}));
+}
+
+BOOST_AUTO_TEST_CASE(H264NalScanner_KeepsEmulationPreventionBytes)
+{
+    // 00 00 03 escapes a 00 00 01 inside the payload, it must not split the unit
+    const Bytes slice{0x41, 0x00, 0x00, 0x03, 0x01, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x01, 0x7f};
+    const auto units = scan(concat({cStartCode4, slice, cStartCode3, {0x41, 0x01}}));
+
+    BOOST_REQUIRE_EQUAL(units.size(), 2u);
+    BOOST_CHECK(units[0] == slice);
+}
+
+BOOST_AUTO_TEST_CASE(H264NalScanner_ContainsFindsType)
+{
+    const Bytes stream = concat({cStartCode4, {0x09, 0xf0}, cStartCode4, {0x67, 0x42}, cStartCode4, {0x65, 0x88}});
+
+    BOOST_CHECK(H264NalScanner::contains(stream.data(), stream.size(), NalUnitType::SPS));
+    BOOST_CHECK(H264NalScanner::contains(stream.data(), stream.size(), NalUnitType::IDR));
+    BOOST_CHECK(!H264NalScanner::contains(stream.data(), stream.size(), NalUnitType::PPS));
+}
+
+BOOST_AUTO_TEST_CASE(H264SpsRewriter_MatchesH264Bitstream)
+{
+    H264SpsRewriter rewriter;
+
+    for(const auto& vector : cSpsVectors)
+    {
+        const auto original = fromHex(vector.original);
+        const auto expected = fromHex(vector.rewritten);
+
+        BOOST_REQUIRE_MESSAGE(rewriter.rewrite(toUnit(original)), vector.name);
+        BOOST_CHECK_MESSAGE(Bytes(rewriter.data(), rewriter.data() + rewriter.size()) == expected, vector.name);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(H264SpsRewriter_RewritesUnitInsideStream)
+{
+    const auto sps = fromHex(cSpsVectors[0].original);
+    const Bytes stream = concat({cStartCode4, sps, cStartCode4, {0x68, 0xce, 0x3c, 0x80}});
+    H264NalScanner scanner(stream.data(), stream.size());
+    H264SpsRewriter rewriter;
+    NalUnit unit;
+
+    BOOST_REQUIRE(scanner.next(unit));
+    BOOST_REQUIRE(rewriter.rewrite(unit));
+    BOOST_CHECK(Bytes(rewriter.data(), rewriter.data() + rewriter.size()) == fromHex(cSpsVectors[0].rewritten));
+}
+
+BOOST_AUTO_TEST_CASE(H264SpsRewriter_GrowsByNewEmulationPreventionBytes)
+{
+    // 00 00 18 shifted by the 29 removed bits turns into 00 00 03 03 once escaped, one extra byte per repetition
+    auto original = fromHex(cSpsVectors[0].original);
+    auto expected = fromHex(cSpsVectors[0].rewritten);
+    for(size_t i = 0; i < 60; ++i)
+    {
+        original.insert(original.end(), {0x00, 0x00, 0x18});
+        expected.insert(expected.end(), {0x00, 0x00, 0x03, 0x03});
+    }
+    H264SpsRewriter rewriter;
+
+    BOOST_REQUIRE(rewriter.rewrite(toUnit(original)));
+    BOOST_CHECK(Bytes(rewriter.data(), rewriter.data() + rewriter.size()) == expected);
+    BOOST_CHECK_GT(rewriter.size(), original.size() + 16);
+}
+
+BOOST_AUTO_TEST_CASE(H264SpsRewriter_LeavesRewrittenSpsAlone)
+{
+    H264SpsRewriter rewriter;
+
+    for(const auto& vector : cSpsVectors)
+    {
+        BOOST_CHECK_MESSAGE(!rewriter.rewrite(toUnit(fromHex(vector.rewritten))), vector.name);
+        BOOST_CHECK_EQUAL(rewriter.size(), 0u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(H264SpsRewriter_RejectsOtherUnits)
+{
+    H264SpsRewriter rewriter;
+
+    BOOST_CHECK(!rewriter.rewrite(toUnit(Bytes{0x68, 0xce, 0x3c, 0x80})));
+    BOOST_CHECK(!rewriter.rewrite(toUnit(Bytes{0x67})));
+}
+
+BOOST_AUTO_TEST_CASE(H264SpsRewriter_RejectsTruncatedSps)
+{
+    const auto original = fromHex(cSpsVectors[0].original);
+    H264SpsRewriter rewriter;
+
+    BOOST_CHECK(!rewriter.rewrite(toUnit(Bytes(original.begin(), original.begin() + 12))));
+}
+
+BOOST_AUTO_TEST_CASE(H264SpsRewriter_RejectsSpsLongerThanScratch)
+{
+    // trailing zero bytes fill the unit up to the scratch size, one more byte does not fit
+    auto original = fromHex(cSpsVectors[0].original);
+    original.resize(H264SpsRewriter::cMaxSpsSize, 0x00);
+    H264SpsRewriter rewriter;
+
+    BOOST_REQUIRE(rewriter.rewrite(toUnit(original)));
+    BOOST_CHECK(Bytes(rewriter.data(), rewriter.data() + rewriter.size()) == fromHex(cSpsVectors[0].rewritten));
+
+    original.push_back(0x00);
+    BOOST_CHECK(!rewriter.rewrite(toUnit(original)));
+    BOOST_CHECK_EQUAL(rewriter.size(), 0u);
+}
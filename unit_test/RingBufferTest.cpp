@@ -0,0 +1,220 @@
+/*
+*  This file is part of openauto project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  openauto is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  openauto is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with openauto. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "openauto/Projection/RingBuffer.hpp"
+
+using namespace openauto::projection;
+
+namespace
+{
+
+using Bytes = std::vector<char>;
+
+Bytes sequence(char first, size_t size)
+{
+    Bytes bytes(size);
+    for(size_t i = 0; i < size; ++i)
+    {
+        bytes[i] = static_cast<char>(first + i);
+    }
+    return bytes;
+}
+
+Bytes readAll(RingBuffer& ring)
+{
+    Bytes bytes(ring.getCapacity());
+    bytes.resize(ring.read(bytes.data(), bytes.size()));
+    return bytes;
+}
+
+// the writer sends consecutive counters, the reader checks that they only ever go up: a tail that
+// moves backwards hands out old counters again, a stale copy hands out overwritten ones
+void stress(RingBufferOverflowPolicy policy, bool clearWhileReading)
+{
+    constexpr uint32_t cCount = 50000;
+    RingBuffer ring(256, policy, sizeof(uint32_t));
+    std::atomic<bool> writing(true);
+
+    std::thread writer([&]() {
+        uint32_t chunk[5];
+        for(uint32_t next = 0; next < cCount;)
+        {
+            for(auto& value : chunk)
+            {
+                value = next++;
+            }
+            ring.write(reinterpret_cast<const char*>(chunk), sizeof(chunk));
+
+            if(clearWhileReading && next % 1000 == 0)
+            {
+                ring.clear();
+            }
+        }
+        writing = false;
+    });
+
+    uint32_t chunk[3];
+    int64_t last = -1;
+    bool ordered = true;
+    size_t misaligned = 0;
+
+    while(writing || ring.getFillLevel() > 0)
+    {
+        const size_t count = ring.read(reinterpret_cast<char*>(chunk), sizeof(chunk));
+        if(count == 0)
+        {
+            std::this_thread::yield();
+        }
+
+        misaligned += count % sizeof(uint32_t);
+        for(size_t i = 0; i < count / sizeof(uint32_t); ++i)
+        {
+            ordered &= chunk[i] > last;
+            last = chunk[i];
+        }
+    }
+    writer.join();
+
+    BOOST_CHECK(ordered);
+    BOOST_CHECK_EQUAL(misaligned, 0u);
+    if(policy == RingBufferOverflowPolicy::DROP_OLDEST && !clearWhileReading)
+    {
+        // dropping the oldest bytes never loses the end of the stream
+        BOOST_CHECK_EQUAL(last, cCount - 1);
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer_RoundsCapacityUpToPowerOfTwo)
+{
+    RingBuffer ring(12, RingBufferOverflowPolicy::DROP_NEWEST);
+
+    BOOST_CHECK_EQUAL(ring.getCapacity(), 16u);
+    BOOST_CHECK_EQUAL(ring.getFreeSpace(), 16u);
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer_WrapsAroundWithAlignment)
+{
+    RingBuffer ring(16, RingBufferOverflowPolicy::DROP_OLDEST, 4);
+    const auto first = sequence(0, 12);
+    const auto second = sequence(12, 12);
+    Bytes read(8);
+
+    BOOST_CHECK_EQUAL(ring.write(first.data(), first.size()), 12u);
+    BOOST_CHECK_EQUAL(ring.read(read.data(), read.size()), 8u);
+    BOOST_CHECK(read == sequence(0, 8));
+
+    // 4 bytes left at the end of the storage, the second write continues at its start
+    BOOST_CHECK_EQUAL(ring.write(second.data(), second.size()), 12u);
+    BOOST_CHECK_EQUAL(ring.getFillLevel(), 16u);
+    BOOST_CHECK(readAll(ring) == sequence(8, 16));
+    BOOST_CHECK_EQUAL(ring.getStatistics().overflows, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer_DropOldestDiscardsWholeUnits)
+{
+    RingBuffer ring(16, RingBufferOverflowPolicy::DROP_OLDEST, 4);
+    const auto first = sequence(0, 12);
+    const auto second = sequence(12, 8);
+
+    ring.write(first.data(), first.size());
+    BOOST_CHECK_EQUAL(ring.write(second.data(), second.size()), 8u);
+
+    // 4 bytes were missing, exactly one unit goes
+    BOOST_CHECK(readAll(ring) == sequence(4, 16));
+    BOOST_CHECK_EQUAL(ring.getStatistics().overflows, 1u);
+    BOOST_CHECK_EQUAL(ring.getStatistics().overflowBytes, 4u);
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer_DropOldestKeepsEndOfWriteLargerThanCapacity)
+{
+    RingBuffer ring(16, RingBufferOverflowPolicy::DROP_OLDEST, 4);
+    const auto first = sequence(0, 8);
+    const auto second = sequence(8, 40);
+
+    ring.write(first.data(), first.size());
+    BOOST_CHECK_EQUAL(ring.write(second.data(), second.size()), 16u);
+
+    const auto statistics = ring.getStatistics();
+    BOOST_CHECK(readAll(ring) == sequence(32, 16));
+    BOOST_CHECK_EQUAL(statistics.overflows, 1u);
+    BOOST_CHECK_EQUAL(statistics.overflowBytes, 32u);
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer_DropNewestCutsWrite)
+{
+    RingBuffer ring(16, RingBufferOverflowPolicy::DROP_NEWEST);
+    const auto bytes = sequence(0, 20);
+
+    BOOST_CHECK_EQUAL(ring.write(bytes.data(), bytes.size()), 16u);
+    BOOST_CHECK(readAll(ring) == sequence(0, 16));
+    BOOST_CHECK_EQUAL(ring.getStatistics().overflowBytes, 4u);
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer_ReadCountsUnderflow)
+{
+    RingBuffer ring(16, RingBufferOverflowPolicy::BLOCK);
+    const auto bytes = sequence(0, 4);
+    Bytes read(8);
+
+    ring.write(bytes.data(), bytes.size());
+    BOOST_CHECK_EQUAL(ring.read(read.data(), read.size()), 4u);
+    BOOST_CHECK_EQUAL(ring.getStatistics().underflows, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer_ClearDiscardsUnreadBytes)
+{
+    RingBuffer ring(16, RingBufferOverflowPolicy::DROP_OLDEST, 4);
+    const auto first = sequence(0, 12);
+    const auto second = sequence(12, 8);
+    Bytes read(4);
+
+    ring.write(first.data(), first.size());
+    ring.read(read.data(), read.size());
+    ring.clear();
+
+    BOOST_CHECK_EQUAL(ring.getFillLevel(), 0u);
+    BOOST_CHECK_EQUAL(ring.read(read.data(), read.size()), 0u);
+
+    ring.write(second.data(), second.size());
+    BOOST_CHECK(readAll(ring) == second);
+
+    ring.clear();
+    ring.clear();
+    BOOST_CHECK_EQUAL(ring.getFillLevel(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer_KeepsOrderAcrossThreads)
+{
+    stress(RingBufferOverflowPolicy::DROP_OLDEST, false);
+    stress(RingBufferOverflowPolicy::DROP_NEWEST, false);
+    stress(RingBufferOverflowPolicy::BLOCK, false);
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer_KeepsOrderWhenClearedWhileReading)
+{
+    stress(RingBufferOverflowPolicy::DROP_OLDEST, true);
+    stress(RingBufferOverflowPolicy::DROP_NEWEST, true);
+    stress(RingBufferOverflowPolicy::BLOCK, true);
+}